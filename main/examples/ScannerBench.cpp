@@ -0,0 +1,198 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <dirent.h>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "Util/MarkerScanner.h"
+#include "Util/stdafx.h"
+
+#ifdef ESP_PLATFORM
+#include "Periph/SPIFFS.h"
+#endif
+
+/**
+ * Replays recorded camera frames through MarkerScanner and reports per-stage timings, recall and false positives.
+ *
+ * Frames are raw RGB565 160x120 camera buffers (38400 B, as returned by esp_camera_fb_get) stored in SPIFFS
+ * under ScanBench/. The file name starts with the ID of the marker in the frame, or "none" if there is no marker,
+ * followed by an underscore and a free-form description, e.g. "ScanBench/3_far_dim.rgb", "ScanBench/none_desk.rgb".
+ *
+ * A labelled corpus and its generator are in test/ScanBench/. On the device, copy the frames into spiffs_image/ScanBench/
+ * (they aren't kept there so the firmware image doesn't carry them). On the host, the test project builds this file
+ * as the ScannerBench target, which takes the corpus directory as its argument.
+ */
+
+static const char* TAG = "ScannerBench";
+
+static constexpr uint8_t FrameWidth = 160;
+static constexpr uint8_t FrameHeight = 120;
+static constexpr size_t FrameSize = FrameWidth * FrameHeight * 2;
+static constexpr uint8_t Repeats = 10;
+
+struct StageStats {
+	const char* name;
+	uint64_t total = 0;
+	uint32_t max = 0;
+
+	void add(uint32_t time){
+		total += time;
+		max = std::max(max, time);
+	}
+};
+
+static bool loadFrame(const char* dirPath, const char* name, uint8_t* buf){
+	char path[600];
+	snprintf(path, sizeof(path), "%s/%s", dirPath, name);
+
+	FILE* file = fopen(path, "rb");
+	if(file == nullptr){
+		ESP_LOGW(TAG, "Can't open %s", path);
+		return false;
+	}
+
+	const size_t read = fread(buf, 1, FrameSize, file);
+	fclose(file);
+
+	if(read != FrameSize){
+		ESP_LOGW(TAG, "%s: expected %zu B, got %zu B", path, FrameSize, read);
+		return false;
+	}
+
+	return true;
+}
+
+// -1 if the frame has no marker
+static int expectedID(const char* base){
+	if(strncmp(base, "none", 4) == 0){
+		return -1;
+	}
+
+	return atoi(base);
+}
+
+static bool isFrame(const char* name, const char* prefix){
+	const size_t length = strlen(name);
+	return strncmp(name, prefix, strlen(prefix)) == 0 && length > 4 && strcmp(name + length - 4, ".rgb") == 0;
+}
+
+/**
+ * SPIFFS has no directories, so on the device the frames are the files in the root whose name starts with prefix.
+ * On the host, dirPath is the corpus directory itself and prefix is empty.
+ * @return false if there were no frames or the scanner reported a false positive
+ */
+static bool bench(const char* dirPath, const char* prefix){
+	// Marker scanner takes the frame as (rows, columns)
+	MarkerScanner scanner(FrameHeight, FrameWidth);
+	auto frame = (uint8_t*) heap_caps_malloc(FrameSize, MALLOC_CAP_SPIRAM);
+
+	std::array<StageStats, 8> stages = {{
+			{ "downscale" }, { "blur" }, { "threshold" }, { "contours" }, { "quads" }, { "warp" }, { "validate" }, { "total" }
+	}};
+
+	uint32_t frames = 0, runs = 0;
+	uint32_t markerFrames = 0, detected = 0, falsePositives = 0;
+
+	DIR* dir = opendir(dirPath);
+	if(dir == nullptr){
+		ESP_LOGE(TAG, "Can't open %s", dirPath);
+		free(frame);
+		return false;
+	}
+
+	while(const dirent* entry = readdir(dir)){
+		if(!isFrame(entry->d_name, prefix)) continue;
+		if(!loadFrame(dirPath, entry->d_name, frame)) continue;
+
+		const int expected = expectedID(entry->d_name + strlen(prefix));
+		frames++;
+
+		bool found = false;
+		uint32_t wrong = 0;
+
+		for(uint8_t i = 0; i < Repeats; ++i){
+			DriveInfo info;
+
+			const uint64_t start = micros();
+			scanner.process(frame, info);
+			const uint32_t total = micros() - start;
+
+			const MarkerScanner::Timings& t = scanner.getTimings();
+			stages[0].add(t.downscale);
+			stages[1].add(t.blur);
+			stages[2].add(t.threshold);
+			stages[3].add(t.contours);
+			stages[4].add(t.quads);
+			stages[5].add(t.warp);
+			stages[6].add(t.validate);
+			stages[7].add(total);
+			runs++;
+
+			// Scanning is deterministic, detections only need to be counted once
+			if(i != 0) continue;
+
+			for(const Marker& marker : info.markerInfo.markers){
+				if(marker.id == expected){
+					found = true;
+				}else{
+					wrong++;
+				}
+			}
+		}
+
+		if(expected != -1){
+			markerFrames++;
+			detected += found;
+		}
+		falsePositives += wrong;
+
+		printf("%-40s expected %4d: %s, %lu false\n", entry->d_name, expected, expected == -1 ? "-" : (found ? "found" : "MISSED"), wrong);
+	}
+
+	closedir(dir);
+	free(frame);
+
+	if(frames == 0){
+		ESP_LOGE(TAG, "No frames found in %s/%s", dirPath, prefix);
+		return false;
+	}
+
+	printf("\n%lu frames, %u runs each\n", frames, Repeats);
+	for(const StageStats& stage : stages){
+		printf("%-10s avg %6llu us, max %6lu us\n", stage.name, stage.total / runs, stage.max);
+	}
+
+	printf("\nRecall: %lu / %lu", detected, markerFrames);
+	if(markerFrames != 0){
+		printf(" (%.1f%%)", 100.0f * (float) detected / (float) markerFrames);
+	}
+	printf("\nFalse positives: %lu\n", falsePositives);
+
+	return falsePositives == 0;
+}
+
+#ifdef ESP_PLATFORM
+
+extern "C" void app_main(void){
+	auto spiffs = new SPIFFS();
+	bench("/spiffs", "ScanBench/");
+	delete spiffs;
+
+	vTaskDelete(nullptr);
+}
+
+#else
+
+int main(int argc, char** argv){
+	if(argc != 2){
+		fprintf(stderr, "Usage: %s <corpus directory>\n", argv[0]);
+		return 2;
+	}
+
+	return bench(argv[1], "") ? 0 : 1;
+}
+
+#endif
@@ -23,6 +23,13 @@
 #include "Services/Comm.h"
 #include "Services/Audio.h"
 #include "Services/MicroROS.h"
+#include "Services/ROS/BatteryPublisher.h"
+#include "Services/ROS/TaskStatsPublisher.h"
+#include "Services/TaskMonitor.h"
+#include "Services/ROS/CmdVelSubscriber.h"
+#include "Services/ROS/SensorBridge.h"
+#include "Services/ROS/ImagePublisher.h"
+#include "Services/ROS/MarkerPublisher.h"
 #include "States/PairState.h"
 #include "Services/StateMachine.h"
 #include "Services/LEDService.h"
@@ -34,7 +41,6 @@
 #include "Services/InactivityService.h"
 #include "Util/HWVersion.h"
 #include "Settings.h"
-#include "Services/MicroROSService.h"
 
 [[noreturn]] void shutdown(){
 	ESP_ERROR_CHECK(esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_AUTO));
@@ -125,6 +131,12 @@ void init(){
 	auto cameraController = new CameraController();
 	Services.set(Service::CameraController, cameraController);
 
+	// Module topics follow the module insert events, so the bridge has to be listening before Modules starts
+	auto microros = new MicroROS();
+	Services.set(Service::MicroROS, microros);
+	auto sensorBridge = new SensorBridge(*microros);
+	Services.set(Service::SensorBridge, sensorBridge);
+
 	auto modules = new Modules(*i2c, *adc1);
 	Services.set(Service::Modules, modules);
 
@@ -136,8 +148,23 @@ void init(){
 
 	auto inactivityService = new InactivityService();
 
-	auto microros = new MicroROS();
-	Services.set(Service::MicroROS, microros);
+	microros->add(new BatteryPublisher());
+	microros->add(new CmdVelSubscriber());
+
+	auto taskMonitor = new TaskMonitor();
+	Services.set(Service::TaskMonitor, taskMonitor);
+	auto taskStats = new TaskStatsPublisher(*taskMonitor);
+	microros->add(taskStats);
+	microros->add(taskStats->getRequest());
+
+	auto imagePublisher = new ImagePublisher();
+	microros->add(imagePublisher);
+	feed->setImagePublisher(imagePublisher);
+
+	auto markerPublisher = new MarkerPublisher();
+	microros->add(markerPublisher);
+	feed->setMarkerPublisher(markerPublisher);
+
 	microros->begin();
 
 	audio->play("/spiffs/General/PowerOn.aac", true);
@@ -146,6 +173,17 @@ void init(){
 	stateMachine->begin();
 
 	battery->setShutdownCallback([](){
+		// Module instances report to the bridge from their own tasks, they have to be gone first
+		if(Modules* modules = (Modules*) Services.get(Service::Modules)){
+			Services.set(Service::Modules, nullptr);
+			delete modules;
+		}
+
+		if(SensorBridge* sensorBridge = (SensorBridge*) Services.get(Service::SensorBridge)){
+			Services.set(Service::SensorBridge, nullptr);
+			delete sensorBridge;
+		}
+
 		if(MicroROS* microros = (MicroROS*) Services.get(Service::MicroROS)){
 			Services.set(Service::MicroROS, nullptr);
 			delete microros;
@@ -170,11 +208,6 @@ void init(){
 			delete lowBatteryService;
 		}
 
-		if(MicroROSService* microROS = (MicroROSService*) Services.get(Service::MicroROS)){
-			Services.set(Service::MicroROS, nullptr);
-			delete microROS;
-		}
-
 		if(LEDService* led = (LEDService*) Services.get(Service::LED)){
 			for(int i = 0; i < (uint8_t) LED::COUNT; i++){
 				led->off((LED) i);
@@ -16,7 +16,7 @@ PanicAction::PanicAction() : startTime(millis()), lastPlay(startTime), eventQueu
 		feed->disableScanning();
 	}
 
-	Events::listen(Facility::Comm, &eventQueue);
+	Events::listen<Comm::Event, CommType::Emergency>(&eventQueue);
 	Events::listen(Facility::TCP, &eventQueue);
 
 	armController = (ArmController*) Services.get(Service::ArmController);
@@ -88,7 +88,7 @@ void PanicAction::loop(){
 				markForDestroy();
 			}
 
-			free(event.data);
+			Events::release(event.data);
 		}else if(event.facility == Facility::TCP){
 			const TCPServer::Event* tcpEvent = (TCPServer::Event*) event.data;
 			if (tcpEvent->status == TCPServer::Event::Status::Disconnected){
@@ -110,9 +110,9 @@ void PanicAction::loop(){
 	}else if(iteration == 3){
 		cameraController->setLocally({.Rotation = 50});
 	}else if(iteration >= 4 && iteration <= 6){
-		motorDriveController->setLocally({.DriveDirection = {.dir = 4, .speed = 0.4f}});
+		motorDriveController->setLocally(MotorDriveState::fromDriveDir({.dir = 4, .speed = 0.4f}));
 	}else if(iteration == 7){
-		motorDriveController->setLocally({.DriveDirection = {.dir = 0, .speed = 0.0f}});
+		motorDriveController->setLocally({});
 
 		LEDService* led = (LEDService*) Services.get(Service::LED);
 		if (led == nullptr){
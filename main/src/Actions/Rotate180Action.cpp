@@ -41,13 +41,13 @@ void Rotate180Action::loop(){
 	}
 
 	if(readyToTransition()){
-		const MotorDriveState state{ .DriveDirection = { .dir = 0, .speed = 0.0f }};
+		const MotorDriveState state{};
 		controller->setLocally(state);
 		markForDestroy();
 		return;
 	}
 
-	const MotorDriveState state{ .DriveDirection = { .dir = randomDirection, .speed = 1.0f }};
+	const MotorDriveState state = MotorDriveState::fromDriveDir({ .dir = randomDirection, .speed = 1.0f });
 	controller->setLocally(state);
 }
 
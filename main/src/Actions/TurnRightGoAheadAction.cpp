@@ -31,7 +31,7 @@ void TurnRightGoAheadAction::loop(){
 	}
 
 	const uint64_t deltaTime = millis() - startTime;
-	MotorDriveState state{ .DriveDirection = { .dir = 0, .speed = 1.0f }};
+	DriveDir driveDir{ .dir = 0, .speed = 1.0f };
 
 	Battery* battery = (Battery*)Services.get(Service::Battery);
 	if (battery == nullptr){
@@ -42,13 +42,13 @@ void TurnRightGoAheadAction::loop(){
 	const uint64_t turnDuration = TurnDurationAtFull + (1.0f - std::clamp(battery->getPerc(), (uint8_t)0, (uint8_t)100) / 100.0f) * (TurnDurationAtEmpty - TurnDurationAtFull);
 
 	if(deltaTime < turnDuration){
-		state.DriveDirection.dir = 2;
+		driveDir.dir = 2;
 	}else if(deltaTime - turnDuration >= ForwardDuration){
-		state.DriveDirection.speed = 0.0f;
+		driveDir.speed = 0.0f;
 		markForDestroy();
 	}
 
-	controller->setLocally(state);
+	controller->setLocally(MotorDriveState::fromDriveDir(driveDir));
 }
 
 bool TurnRightGoAheadAction::readyToTransition() const{
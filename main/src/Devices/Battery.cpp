@@ -77,7 +77,7 @@ void Battery::sleepyLoop() {
 
 	for(::Event event{}; eventQueue.get(event, 0);){
 		if(event.facility != Facility::TCP){
-			free(event.data);
+			Events::release(event.data);
 			continue;
 		}
 
@@ -100,7 +100,7 @@ void Battery::sleepyLoop() {
 			oldValueSent = 0;
 		}
 
-		free(event.data);
+		Events::release(event.data);
 	}
 
 	sample();
@@ -1,6 +1,12 @@
 #include "Camera.h"
 #include <Pins.hpp>
 #include <driver/i2c.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+
+static const char* TAG = "Camera";
 
 Camera::Camera(I2C& i2c) : i2c(i2c){
 	const gpio_config_t cfg = {
@@ -24,6 +30,7 @@ esp_err_t Camera::init(bool horizontalFlip){
 
 	format = formatWait;
 	res = resWait;
+	bufferRes = res;
 
 	camera_config_t config;
 	config.ledc_channel = LEDC_CHANNEL_0;
@@ -52,12 +59,12 @@ esp_err_t Camera::init(bool horizontalFlip){
 
 	config.frame_size = res;
 	config.pixel_format = format;
-	config.fb_count = 2;
+	config.fb_count = FrameCount;
 	config.fb_location = CAMERA_FB_IN_PSRAM;
 	config.grab_mode = CAMERA_GRAB_LATEST;
 
 	if(format == PIXFORMAT_JPEG){
-		config.jpeg_quality = 12;
+		config.jpeg_quality = jpegQuality;
 	}
 
 	gpio_set_level((gpio_num_t) CAM_PIN_PWDN, 0);
@@ -113,9 +120,13 @@ void Camera::deinit(){
 	if(!inited) return;
 	inited = false;
 
-	if(frame){
-		esp_camera_fb_return(frame);
-		frame = nullptr;
+	// Frames can still be in use on other tasks. The driver frees its buffers on deinit, so it can't go before they're all back.
+	for(uint32_t waited = 1; framesHeld(); waited++){
+		if(waited % ReleaseWait == 0){
+			ESP_LOGW(TAG, "Deinit waiting on frames still held after %lu ms", pdTICKS_TO_MS(waited));
+		}
+
+		vTaskDelay(1);
 	}
 
 	{
@@ -126,31 +137,79 @@ void Camera::deinit(){
 	gpio_set_level((gpio_num_t) CAM_PIN_PWDN, 1);
 }
 
-camera_fb_t* Camera::getFrame(){
-	if(!inited) return nullptr;
-	if(frame) return nullptr;
+Camera::Frame Camera::getFrame(){
+	if(!inited) return {};
+
+	auto freeSlot = [this]() -> int8_t {
+		for(uint8_t i = 0; i < FrameCount; ++i){
+			if(slots[i].fb == nullptr) return i;
+		}
+		return -1;
+	};
+
+	{
+		std::lock_guard lock(frameMut);
+		if(freeSlot() == -1) return {};
+	}
 
-	frame = esp_camera_fb_get();
+	// Blocks until the next frame is captured, slots can still be released meanwhile
+	camera_fb_t* fb = esp_camera_fb_get();
 
-	if(frame == nullptr){
+	if(fb == nullptr){
 		failedFrames++;
 
 		if(failedFrames >= MaxFailedFrames){
 			deinit();
 		}
-	}else{
-		failedFrames = 0;
+
+		return {};
 	}
 
-	return frame;
+	failedFrames = 0;
+
+	std::lock_guard lock(frameMut);
+
+	const int8_t index = freeSlot();
+	if(index == -1){
+		esp_camera_fb_return(fb);
+		return {};
+	}
+
+	Slot& slot = slots[index];
+	slot.fb = fb;
+	slot.refs = 1;
+	slot.generation++;
+
+	return { this, (uint8_t) index, slot.generation, fb };
 }
 
-void Camera::releaseFrame(){
-	if(!inited) return;
-	if(!frame) return;
+void Camera::ref(uint8_t slot, uint32_t generation){
+	std::lock_guard lock(frameMut);
+
+	if(slots[slot].generation != generation || slots[slot].fb == nullptr) return;
+	slots[slot].refs++;
+}
+
+void Camera::unref(uint8_t slot, uint32_t generation){
+	std::lock_guard lock(frameMut);
+
+	Slot& s = slots[slot];
+	if(s.generation != generation || s.fb == nullptr) return;
+
+	if(--s.refs == 0){
+		esp_camera_fb_return(s.fb);
+		s.fb = nullptr;
+	}
+}
+
+bool Camera::framesHeld(){
+	std::lock_guard lock(frameMut);
 
-	esp_camera_fb_return(frame);
-	frame = nullptr;
+	for(const Slot& slot : slots){
+		if(slot.fb != nullptr) return true;
+	}
+
+	return false;
 }
 
 bool Camera::isInited(){
@@ -159,6 +218,17 @@ bool Camera::isInited(){
 
 void Camera::setRes(framesize_t res){
 	resWait = res;
+
+	if(!inited || res == this->res || formatWait != format || res > bufferRes) return;
+
+	// Frame buffers were sized for bufferRes at init, anything up to it only needs the sensor switched over
+	sensor_t* sensor = esp_camera_sensor_get();
+	if(sensor == nullptr) return;
+
+	auto lock = i2c.lockBus();
+	if(sensor->set_framesize(sensor, res) != 0) return;
+
+	this->res = res;
 }
 
 framesize_t Camera::getRes() const{
@@ -170,6 +240,27 @@ pixformat_t Camera::getFormat() const{
 	return format;
 }
 
+void Camera::setJpegQuality(uint8_t quality){
+	if(quality == jpegQuality) return;
+	jpegQuality = quality;
+
+	if(!inited || format != PIXFORMAT_JPEG) return;
+
+	sensor_t* sensor = esp_camera_sensor_get();
+	if(sensor == nullptr) return;
+
+	auto lock = i2c.lockBus();
+	sensor->set_quality(sensor, quality);
+	jpegQualityChanged = esp_timer_get_time();
+}
+
+bool Camera::hasJpegQuality(const Frame& frame) const{
+	if(!frame) return false;
+
+	const int64_t started = (int64_t) frame->timestamp.tv_sec * 1000000 + frame->timestamp.tv_usec;
+	return started >= jpegQualityChanged;
+}
+
 void Camera::setFormat(pixformat_t format){
 	if(format == PIXFORMAT_RGB888){
 		format = PIXFORMAT_RGB565;
@@ -177,3 +268,74 @@ void Camera::setFormat(pixformat_t format){
 
 	formatWait = format;
 }
+
+Camera::Frame::Frame(Camera* camera, uint8_t slot, uint32_t generation, camera_fb_t* fb) : camera(camera), slot(slot), generation(generation), fb(fb){}
+
+Camera::Frame::Frame(const Frame& other) : camera(other.camera), slot(other.slot), generation(other.generation), fb(other.fb){
+	if(camera){
+		camera->ref(slot, generation);
+	}
+}
+
+Camera::Frame::Frame(Frame&& other) noexcept : camera(other.camera), slot(other.slot), generation(other.generation), fb(other.fb){
+	other.camera = nullptr;
+	other.fb = nullptr;
+}
+
+Camera::Frame& Camera::Frame::operator=(const Frame& other){
+	if(this == &other) return *this;
+
+	release();
+
+	camera = other.camera;
+	slot = other.slot;
+	generation = other.generation;
+	fb = other.fb;
+
+	if(camera){
+		camera->ref(slot, generation);
+	}
+
+	return *this;
+}
+
+Camera::Frame& Camera::Frame::operator=(Frame&& other) noexcept{
+	if(this == &other) return *this;
+
+	release();
+
+	camera = other.camera;
+	slot = other.slot;
+	generation = other.generation;
+	fb = other.fb;
+
+	other.camera = nullptr;
+	other.fb = nullptr;
+
+	return *this;
+}
+
+Camera::Frame::~Frame(){
+	release();
+}
+
+camera_fb_t* Camera::Frame::get() const{
+	return fb;
+}
+
+camera_fb_t* Camera::Frame::operator->() const{
+	return fb;
+}
+
+Camera::Frame::operator bool() const{
+	return fb != nullptr;
+}
+
+void Camera::Frame::release(){
+	if(camera){
+		camera->unref(slot, generation);
+	}
+
+	camera = nullptr;
+	fb = nullptr;
+}
@@ -2,22 +2,74 @@
 #define PERSE_ROVER_CAMERA_H
 
 #include <esp_camera.h>
+#include <array>
+#include <mutex>
 #include "AW9523.h"
 
 class Camera {
 public:
+	/**
+	 * Refcounted handle to a driver frame buffer. Copies share the same buffer, which goes back to the driver
+	 * when the last handle is dropped. deinit() waits for every handle to be dropped, so no task should hold one while
+	 * it deinitializes the camera.
+	 */
+	class Frame {
+	public:
+		Frame() = default;
+		Frame(const Frame& other);
+		Frame(Frame&& other) noexcept;
+		Frame& operator=(const Frame& other);
+		Frame& operator=(Frame&& other) noexcept;
+		~Frame();
+
+		camera_fb_t* get() const;
+		camera_fb_t* operator->() const;
+		explicit operator bool() const;
+
+		void release();
+
+	private:
+		friend Camera;
+		Frame(Camera* camera, uint8_t slot, uint32_t generation, camera_fb_t* fb);
+
+		Camera* camera = nullptr;
+		uint8_t slot = 0;
+		uint32_t generation = 0;
+		camera_fb_t* fb = nullptr;
+	};
+
 	Camera(I2C& i2c);
 	virtual ~Camera();
 
-	camera_fb_t* getFrame();
-	void releaseFrame();
+	/**
+	 * Up to FrameCount frames can be held at the same time, so the driver keeps capturing into a free buffer
+	 * while the previous frame is still being processed.
+	 * @return Empty handle if the camera isn't initialized, no frame is available or all buffers are taken
+	 */
+	Frame getFrame();
 
+	/**
+	 * Sizes up to the one the camera was initialized with are switched on the sensor right away.
+	 * Larger ones, or any size while the format is changing, take effect on the next init().
+	 */
 	void setRes(framesize_t res);
 	framesize_t getRes() const;
 
 	pixformat_t getFormat() const;
 	void setFormat(pixformat_t format);
 
+	/**
+	 * Sensor-side JPEG quality, used when the format is PIXFORMAT_JPEG. Applied immediately if the camera is running,
+	 * but the sensor encodes while it captures, so frames it had already started on still come out at the old quality.
+	 * @param quality [0 - 63], lower is better
+	 */
+	void setJpegQuality(uint8_t quality);
+
+	/**
+	 * @return true if the frame was started after the last JPEG quality change reached the sensor
+	 */
+	bool hasJpegQuality(const Frame& frame) const;
+
 	esp_err_t init(bool horizontalFlip = false);
 	void deinit();
 	bool isInited();
@@ -27,10 +79,26 @@ private:
 	framesize_t resWait = FRAMESIZE_QQVGA;
 	pixformat_t formatWait = PIXFORMAT_JPEG;
 
-	camera_fb_t* frame = nullptr;
+	static constexpr uint8_t FrameCount = 2;
+
+	struct Slot {
+		camera_fb_t* fb = nullptr;
+		uint8_t refs = 0;
+		uint32_t generation = 0;
+	};
+	std::array<Slot, FrameCount> slots;
+	std::mutex frameMut;
+
+	void ref(uint8_t slot, uint32_t generation);
+	void unref(uint8_t slot, uint32_t generation);
+	bool framesHeld();
+	static constexpr TickType_t ReleaseWait = 500; // deinit() warns every time it waited this long for frames
 
 	framesize_t res = FRAMESIZE_INVALID;
+	framesize_t bufferRes = FRAMESIZE_INVALID; // what the frame buffers were allocated for
 	pixformat_t format = PIXFORMAT_RGB444;
+	uint8_t jpegQuality = 12;
+	int64_t jpegQualityChanged = 0; // [us] esp_timer time, the driver stamps frames on the same clock
 
 	static constexpr int MaxFailedFrames = 100;
 	int failedFrames = 0;
@@ -8,7 +8,7 @@
 
 static const char* const TAG = "HeadlightsController";
 
-CameraController::CameraController() : DeviceController("CameraController"), ease("Cam", 1, 5, [this](int32_t val){ cameraServo->setValue(val); }){
+CameraController::CameraController() : DeviceController("CameraController", Events::topics(CommType::CameraRotation)), ease("Cam", 1, 5, [this](int32_t val){ cameraServo->setValue(val); }){
 	cameraServo = new Servo((gpio_num_t)SERVO_3_PWM, 0);
 
 	if (cameraServo == nullptr) {
@@ -6,7 +6,7 @@
 #include <string>
 #include <atomic>
 #include "Util/Events.h"
-#include "Util/Threaded.h"
+#include "Util/Scheduler.h"
 #include "Services/TCPServer.h"
 
 enum DeviceControlType {
@@ -17,16 +17,20 @@ enum DeviceControlType {
 template<typename T>
 class DeviceController {
 public:
-	explicit DeviceController(const std::string& name, bool shouldResetStateToDefault = true) : shouldResetStateToDefault(shouldResetStateToDefault), control(Remote), eventQueue(10),
-														 dcListenThread(std::function([this](){ this->processCommandQueue(); }), name.c_str(), 2 * 1024){
-		Events::listen(Facility::Comm, &eventQueue);
+	/**
+	 * @param commTopics CommTypes passed to processEvent(), see Events::topics()
+	 */
+	DeviceController(const std::string& name, Events::TopicMask commTopics, bool shouldResetStateToDefault = true) : shouldResetStateToDefault(shouldResetStateToDefault), control(Remote), eventQueue(10),
+														 name(name), eventJob(this->name.c_str(), 0, [this](){ this->processCommandQueue(); }){
+		// Events are handled on the shared Scheduler workers, posting one triggers the job
+		eventQueue.setPostHook([this](){ Scheduler::trigger(&eventJob); });
+		Events::listen(Facility::Comm, &eventQueue, commTopics);
 		Events::listen(Facility::TCP, &eventQueue);
-		dcListenThread.start();
 	}
 
 	virtual ~DeviceController(){
-		dcListenThread.stop();
 		Events::unlisten(&eventQueue);
+		Scheduler::remove(&eventJob);
 	}
 
 	inline void setControl(DeviceControlType value){
@@ -74,6 +78,19 @@ protected:
 	virtual void sendState(const T& state, bool local) const = 0;
 	virtual void processEvent(const Event& event) = 0;
 
+	/**
+	 * Called on the event job after every pass through the queued events. Together with triggerJob(), lets a controller
+	 * apply commands that don't come through Events, and keep deadlines, without racing processEvent().
+	 */
+	virtual void afterEvents(){}
+
+	/**
+	 * Runs the event job delay ticks from now, or sooner if an event arrives. Safe to call from any task.
+	 */
+	inline void triggerJob(TickType_t delay = 0){
+		Scheduler::trigger(&eventJob, delay);
+	}
+
 	inline void setRemotely(const T& state){
 		if(control == Local){
 			queuedState = state;
@@ -91,28 +108,28 @@ private:
 	std::atomic<T> currentState = {};
 	std::optional<T> queuedState;
 	EventQueue eventQueue;
-	ThreadedClosure dcListenThread;
+	const std::string name;
+	Scheduler::Job eventJob;
 
 private:
 	void processCommandQueue(){
-		Event event = {};
-		if(!eventQueue.get(event, portMAX_DELAY)){
-			return;
-		}
-
-		if(event.facility == Facility::TCP){
-			if(auto* tcpEvent = (TCPServer::Event*) event.data){
-				if(tcpEvent->status == TCPServer::Event::Status::Disconnected){
-					write(getDefaultState());
-					currentState = getDefaultState();
-					setControl(DeviceControlType::Remote);
+		for(Event event = {}; eventQueue.get(event, 0); event = {}){
+			if(event.facility == Facility::TCP){
+				if(auto* tcpEvent = (TCPServer::Event*) event.data){
+					if(tcpEvent->status == TCPServer::Event::Status::Disconnected){
+						write(getDefaultState());
+						currentState = getDefaultState();
+						setControl(DeviceControlType::Remote);
+					}
 				}
+			}else if(event.facility == Facility::Comm){
+				processEvent(event);
 			}
-		}else if(event.facility == Facility::Comm){
-			processEvent(event);
+
+			Events::release(event.data);
 		}
 
-		free(event.data);
+		afterEvents();
 	}
 };
 
@@ -4,7 +4,7 @@
 #include "Services/LEDService.h"
 #include "Services/Audio.h"
 
-HeadlightsController::HeadlightsController() : DeviceController("Headlights Controller", false){
+HeadlightsController::HeadlightsController() : DeviceController("Headlights Controller", Events::topics(CommType::Headlights), false){
 	setControl(DeviceControlType::Local);
 	setLocally(HeadlightsState{});
 	setControl(DeviceControlType::Remote);
@@ -4,10 +4,13 @@
 #include "Devices/Motors.h"
 #include "Services/LEDService.h"
 #include "Util/Services.h"
+#include "Util/DifferentialDrive.h"
+#include <algorithm>
+#include <cmath>
 
 static const char* const TAG = "MotorDriveController";
 
-MotorDriveController::MotorDriveController() : DeviceController("MotorDriveController"), motorControl(new MotorControl(std::array<ledc_channel_t, 2>({LEDC_CHANNEL_1, LEDC_CHANNEL_2}))) {
+MotorDriveController::MotorDriveController() : DeviceController("MotorDriveController", Events::topics(CommType::DriveDir)), motorControl(new MotorControl(std::array<ledc_channel_t, 2>({LEDC_CHANNEL_1, LEDC_CHANNEL_2}))) {
 	setControl(DeviceControlType::Local);
 	setLocally(MotorDriveState{});
 	setControl(DeviceControlType::Remote);
@@ -17,76 +20,102 @@ MotorDriveController::~MotorDriveController() {
 	delete motorControl;
 }
 
-void MotorDriveController::write(const MotorDriveState& state) {
-	if (motorControl == nullptr) {
-		ESP_LOGW(TAG, "Motor drive controller has motor control = nullptr.");
-		return;
+namespace {
+
+enum class MotorIndicator : uint8_t {
+	Off, Straight, Left, Right
+};
+
+MotorIndicator indicator(const MotorDriveState& state){
+	static constexpr float MovingThreshold = 0.1f;
+	static constexpr float TurningThreshold = 0.05f;
+
+	if(std::max(std::abs(state.Linear), std::abs(state.Angular)) < MovingThreshold){
+		return MotorIndicator::Off;
+	}else if(std::abs(state.Angular) < TurningThreshold){
+		return MotorIndicator::Straight;
 	}
 
-	const MotorDriveState previousState = getCurrentState();
+	return state.Angular > 0 ? MotorIndicator::Left : MotorIndicator::Right;
+}
 
-	const uint8_t dir = state.DriveDirection.dir;
-	const float speed = state.DriveDirection.speed;
+}
 
-	float leftSpeed = 0.0f;
-	float rightSpeed = 0.0f;
+MotorDriveState MotorDriveState::fromDriveDir(const DriveDir& driveDir){
+	const auto motion = DifferentialDrive::fromDirection(driveDir.dir, driveDir.speed);
+	return { .Linear = motion.linear, .Angular = motion.angular };
+}
 
-	if(dir == 0){
-		leftSpeed = rightSpeed = 100;
-	}
-	else if(dir == 1){
-		leftSpeed = 100;
-		rightSpeed = 30;
+void MotorDriveController::drive(float linear, float angular){
+	{
+		std::lock_guard lock(driveMut);
+		driveCommand = MotorDriveState{
+				.Linear = std::clamp(linear, -1.0f, 1.0f),
+				.Angular = std::clamp(angular, -1.0f, 1.0f)
+		};
+		driveTime = xTaskGetTickCount();
 	}
-	else if(dir == 2){
-		leftSpeed = 100;
-		rightSpeed = -100;
+
+	triggerJob();
+}
+
+void MotorDriveController::afterEvents(){
+	std::optional<MotorDriveState> command;
+	TickType_t since;
+	{
+		std::lock_guard lock(driveMut);
+		command = driveCommand;
+		driveCommand.reset();
+		since = xTaskGetTickCount() - driveTime;
 	}
-	else if(dir == 3){
-		leftSpeed = -100;
-		rightSpeed = -30;
+
+	if(command){
+		setRemotely(*command);
+		driving = command->Linear != 0 || command->Angular != 0;
+		since = 0;
+	}else if(driving && since >= DriveTimeout){
+		ESP_LOGW(TAG, "No drive command for %lu ms, stopping", pdTICKS_TO_MS(since));
+		setRemotely(MotorDriveState{});
+		driving = false;
 	}
-	else if(dir == 4){
-		leftSpeed = rightSpeed = -100;
+
+	if(driving){
+		triggerJob(DriveTimeout - since);
 	}
-	else if(dir == 5){
-		leftSpeed = -30;
-		rightSpeed = -100;
+}
+
+void MotorDriveController::write(const MotorDriveState& state) {
+	if (motorControl == nullptr) {
+		ESP_LOGW(TAG, "Motor drive controller has motor control = nullptr.");
+		return;
 	}
-	else if(dir == 6){
-		leftSpeed = -100;
-		rightSpeed = 100;
+
+	const MotorDriveState previousState = getCurrentState();
+
+	motorControl->setDrive(state.Linear, state.Angular);
+
+	const MotorIndicator ind = indicator(state);
+	if(ind == indicator(previousState)){
+		return;
 	}
-	else if(dir == 7){
-		leftSpeed = 30;
-		rightSpeed = 100;
+
+	LEDService* led = (LEDService*) Services.get(Service::LED);
+	if(led == nullptr){
+		return;
 	}
 
-	leftSpeed = std::clamp(leftSpeed * speed, -100.0f, 100.0f);
-	rightSpeed = std::clamp(rightSpeed * speed, -100.0f, 100.0f);
-
-	motorControl->setLeft(leftSpeed);
-	motorControl->setRight(rightSpeed);
-
-	if(previousState.DriveDirection.dir != dir || dir == 0){
-		LEDService* led = (LEDService*) Services.get(Service::LED);
-		if(led == nullptr){
-			return;
-		}
-
-		if(state.DriveDirection.speed < 0.1f){
-			led->breatheTo(LED::MotorLeft, 0.0f);
-			led->breatheTo(LED::MotorRight, 0.0f);
-		}else if(dir == 0 || dir == 4){
-			led->breatheTo(LED::MotorLeft, 100.0f);
-			led->breatheTo(LED::MotorRight, 100.0f);
-		}else if(dir == 1 || dir == 2 || dir == 5){
-			led->breatheTo(LED::MotorRight, 100.0f);
-			led->breatheTo(LED::MotorLeft, 0.0f);
-		}else if(dir == 3 || dir == 6 || dir == 7){
-			led->breatheTo(LED::MotorRight, 0.0f);
-			led->breatheTo(LED::MotorLeft, 100.0f);
-		}
+	if(ind == MotorIndicator::Off){
+		led->breatheTo(LED::MotorLeft, 0.0f);
+		led->breatheTo(LED::MotorRight, 0.0f);
+	}else if(ind == MotorIndicator::Straight){
+		led->breatheTo(LED::MotorLeft, 100.0f);
+		led->breatheTo(LED::MotorRight, 100.0f);
+	}else if(ind == MotorIndicator::Right){
+		led->breatheTo(LED::MotorRight, 100.0f);
+		led->breatheTo(LED::MotorLeft, 0.0f);
+	}else{
+		led->breatheTo(LED::MotorRight, 0.0f);
+		led->breatheTo(LED::MotorLeft, 100.0f);
 	}
 }
 
@@ -108,9 +137,7 @@ void MotorDriveController::processEvent(const Event &event) {
 		return;
 	}
 
-	MotorDriveState state = {
-			.DriveDirection = commEvent->dir
-	};
-
-	setRemotely(state);
+	// The controller took over, its commands don't time out
+	driving = false;
+	setRemotely(MotorDriveState::fromDriveDir(commEvent->dir));
 }
\ No newline at end of file
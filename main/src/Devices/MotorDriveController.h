@@ -3,10 +3,18 @@
 
 #include "DeviceController.h"
 #include "CommData.h"
+#include <mutex>
 
 struct MotorDriveState
 {
-	DriveDir DriveDirection = {};
+	float Linear = 0.0f; // [-1, 1], forward is positive
+	float Angular = 0.0f; // [-1, 1], turning left is positive
+
+	/**
+	 * Maps one of the eight DriveDir directions to the same wheel powers it always had, scaled by its speed.
+	 * See DifferentialDrive::fromDirection().
+	 */
+	static MotorDriveState fromDriveDir(const DriveDir& driveDir);
 };
 
 class MotorDriveController : public DeviceController<MotorDriveState>
@@ -15,14 +23,30 @@ public:
 	explicit MotorDriveController();
 	virtual ~MotorDriveController() override;
 
+	/**
+	 * Continuous remote drive, for clients that aren't limited to DriveDir directions. Safe to call from any task,
+	 * the command is applied by the event job. Unless it's repeated within DriveTimeout, the motors stop.
+	 * @param linear Forward speed [-1, 1]
+	 * @param angular Turn rate [-1, 1], positive turns left
+	 */
+	void drive(float linear, float angular);
+
+	static constexpr TickType_t DriveTimeout = pdMS_TO_TICKS(500);
+
 protected:
 	virtual void write(const MotorDriveState& state) override;
 	virtual MotorDriveState getDefaultState() const override;
 	virtual void sendState(const MotorDriveState& state, bool local) const override;
 	virtual void processEvent(const Event& event) override;
+	virtual void afterEvents() override;
 
 private:
 	class MotorControl* motorControl = nullptr;
+
+	std::mutex driveMut;
+	std::optional<MotorDriveState> driveCommand; // from drive(), not yet applied
+	TickType_t driveTime = 0; // when drive() was last called
+	bool driving = false; // moving on drive() commands, only touched by the event job
 };
 
 #endif //PERSE_ROVER_MOTORDRIVECONTROLLER_H
\ No newline at end of file
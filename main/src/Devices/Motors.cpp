@@ -3,6 +3,7 @@
 #include <cmath>
 #include "Pins.hpp"
 #include "Util/stdafx.h"
+#include "Util/DifferentialDrive.h"
 
 MotorControl::MotorControl(const std::array<ledc_channel_t, 2>& pwmChannels) :
 		Threaded("Motors", 2 * 1024),
@@ -58,6 +59,12 @@ void MotorControl::setAll(MotorInfo state){
 	setRight(state.right);
 }
 
+void MotorControl::setDrive(float linear, float angular){
+	const auto wheels = DifferentialDrive::mix(linear, angular);
+	setLeft(wheels.left);
+	setRight(wheels.right);
+}
+
 MotorInfo MotorControl::getAll() const{
 	return stateTarget.val;
 }
@@ -23,6 +23,13 @@ public:
 	void setAll(MotorInfo state);
 	MotorInfo getAll() const;
 
+	/**
+	 * Differential drive. Both values are [-1, 1] and are mixed into per-wheel power by DifferentialDrive::mix().
+	 * @param linear Forward speed, negative is backward
+	 * @param angular Turn rate, positive turns left (counter-clockwise)
+	 */
+	void setDrive(float linear, float angular);
+
 	void stopAll();
 
 private:
@@ -182,7 +182,7 @@ bool JigHWTest::ModulesCheck(){
 			Event evt{};
 			if(!evts.get(evt, portMAX_DELAY)) continue;
 			mEvt = *((Modules::Event*) evt.data);
-			free(evt.data);
+			Events::release(evt.data);
 			break;
 		}
 		return mEvt;
@@ -519,7 +519,7 @@ void JigHWTest::AudioVisualTest(){
 			if(data->action == Input::Data::Press && data->btn == Input::Button::Pair){
 				mute = true;
 			}
-			free(evt.data);
+			Events::release(evt.data);
 		}
 
 		if(!mute && audio != nullptr){
@@ -2,9 +2,11 @@
 #include "Util/stdafx.h"
 #include "Services/Modules.h"
 #include "Util/Services.h"
+#include "Services/ROS/SensorBridge.h"
 
 AltPressModule::AltPressModule(I2C& i2c, ModuleBus bus) : SleepyThreaded(Modules::ModuleSendInterval, "AltPress", 2 * 1024), i2c(i2c), bus(bus),
-														  comm(*((Comm*) Services.get(Service::Comm))){
+														  comm(*((Comm*) Services.get(Service::Comm))),
+														  bridge(((SensorBridge*) Services.get(Service::SensorBridge))){
 	ESP_ERROR_CHECK(i2c.write(Addr, 0x06)); // soft rese)t
 
 	delayMillis(5);
@@ -34,17 +36,24 @@ int AltPressModule::readSensor(AltPressModule::Sensor sensor){
 		data |= 0xFFF00000;
 	}
 
-	return data / 100;
+	return data;
 }
 
 void AltPressModule::sleepyLoop(){
 	sendReadSignal();
 
+	const int altitude = readSensor(AltPressModule::ALTITUDE);
+	const int pressure = readSensor(AltPressModule::PRESSURE);
+
 	const ModuleData data = {
 			ModuleType::AltPress, bus, { .altPress = {
-					(int16_t) readSensor(AltPressModule::ALTITUDE),
-					(uint16_t) readSensor(AltPressModule::PRESSURE) } }
+					(int16_t) (altitude / 100),
+					(uint16_t) (pressure / 100) } }
 	};
 
 	comm.sendModuleData(data);
+
+	if(bridge){
+		bridge->report(bus, { .pressure = (float) pressure });
+	}
 }
@@ -5,6 +5,8 @@
 #include "Util/Threaded.h"
 #include "Services/Comm.h"
 
+class SensorBridge;
+
 class AltPressModule : private SleepyThreaded {
 public:
 	AltPressModule(I2C& i2c, ModuleBus bus);
@@ -14,11 +16,15 @@ private:
 	I2C& i2c;
 	const ModuleBus bus;
 	Comm& comm;
+	SensorBridge* bridge = nullptr;
 
 	void sleepyLoop() override;
 	enum Sensor {
 		PRESSURE = 0x30, ALTITUDE = 0x31
 	};
+	/**
+	 * @return Altitude [cm] or pressure [Pa]
+	 */
 	int readSensor(Sensor sensor);
 
 	void sendReadSignal() const;
@@ -1,10 +1,12 @@
 #include "CO2Sensor.h"
 #include "Util/Services.h"
+#include "Services/ROS/SensorBridge.h"
 
 CO2Sensor::CO2Sensor(ModuleBus bus, ADC& adc) : SleepyThreaded(Modules::ModuleSendInterval, "CO2", 2 * 1024),
 												gpio(bus == ModuleBus::Left ? (gpio_num_t) A_CTRL_1 : (gpio_num_t) B_CTRL_1),
 												adc(adc, gpio), bus(bus), comm(*((Comm*) Services.get(Service::Comm))),
-												audio(*((Audio*) Services.get(Service::Audio))){
+												audio(*((Audio*) Services.get(Service::Audio))),
+												bridge(((SensorBridge*) Services.get(Service::SensorBridge))){
 	adc_unit_t unit;
 	adc_channel_t chan;
 	adc_oneshot_io_to_channel(gpio, &unit, &chan);
@@ -32,4 +34,8 @@ void CO2Sensor::sleepyLoop(){
 	};
 
 	comm.sendModuleData(data);
+
+	if(bridge){
+		bridge->report(bus, { .state = status });
+	}
 }
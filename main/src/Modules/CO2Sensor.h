@@ -4,6 +4,8 @@
 #include "Services/Modules.h"
 #include "Services/ADCReader.h"
 
+class SensorBridge;
+
 class CO2Sensor : private SleepyThreaded {
 public:
 	CO2Sensor(ModuleBus bus, ADC& adc);
@@ -15,6 +17,7 @@ private:
 	const ModuleBus bus;
 	Comm& comm;
 	Audio& audio;
+	SensorBridge* bridge = nullptr;
 
 	void sleepyLoop() override;
 
@@ -1,10 +1,12 @@
 #include "GyroModule.h"
 #include "Services/Modules.h"
 #include "Util/Services.h"
+#include "Services/ROS/SensorBridge.h"
 
 GyroModule::GyroModule(I2C& i2c, ModuleBus bus) : SleepyThreaded(50, "Gyro", 3 * 1024), i2c(i2c), bus(bus),
 												  comm(((Comm*) Services.get(Service::Comm))),
-												  audio(((Audio*) Services.get(Service::Audio))){
+												  audio(((Audio*) Services.get(Service::Audio))),
+												  bridge(((SensorBridge*) Services.get(Service::SensorBridge))){
 	const uint8_t initData[2] = { 0x20, 0b01010001 };
 
 	ESP_ERROR_CHECK(i2c.write(Addr, initData, 2));
@@ -63,6 +65,10 @@ void GyroModule::sleepyLoop(){
 
 	value = value * (1.0f - emaA) + emaA * accel;
 
+	if(bridge){
+		bridge->report(bus, { .accel = accel * StandardGravity });
+	}
+
 	++loopCounter;
 
 	if(loopCounter == 10){
@@ -6,6 +6,8 @@
 #include "Services/Comm.h"
 #include "Services/Audio.h"
 
+class SensorBridge;
+
 class GyroModule : private SleepyThreaded {
 public:
 	GyroModule(I2C& i2c, ModuleBus bus);
@@ -16,6 +18,7 @@ private:
 	ModuleBus bus;
 	Comm* comm = nullptr;
 	Audio* audio = nullptr;
+	SensorBridge* bridge = nullptr;
 
 	glm::vec3 value;
 	float emaA = 0.75f;
@@ -28,6 +31,7 @@ private:
 	void sleepyLoop() override;
 
 	static constexpr uint8_t Addr = 0x18;
+	static constexpr float StandardGravity = 9.80665f; // [m/s^2]
 
 	bool tilted = false;
 	static constexpr uint8_t TiltThreshold = 20;
@@ -1,10 +1,11 @@
 #include "LEDModule.h"
 #include "Util/stdafx.h"
 #include "Util/Services.h"
+#include "Services/Comm.h"
 #include "Devices/HeadlightsController.h"
 
-LEDModule::LEDModule(ModuleBus bus) : SleepyThreaded(10, "LEDModule", 2 * 1024), pinout(bus == ModuleBus::Left ? A_CTRL_1 : B_CTRL_1, true), queue(10), bus(bus){
-	Events::listen(Facility::Comm, &queue);
+LEDModule::LEDModule(ModuleBus bus) : SleepyThreaded(10, "LEDModule"), pinout(bus == ModuleBus::Left ? A_CTRL_1 : B_CTRL_1, true), queue(10), bus(bus){
+	Events::listen<Comm::Event, CommType::Headlights>(&queue);
 	Events::listen(Facility::TCP, &queue);
 	start();
 
@@ -25,14 +26,8 @@ LEDModule::LEDModule(ModuleBus bus) : SleepyThreaded(10, "LEDModule", 2 * 1024),
 }
 
 LEDModule::~LEDModule(){
-	stop(0);
-	queue.unblock();
-
-	while(running()){
-		delayMillis(1);
-	}
-
 	Events::unlisten(&queue);
+	stop();
 }
 
 void LEDModule::sleepyLoop(){
@@ -53,7 +48,7 @@ void LEDModule::sleepyLoop(){
 			}
 		}
 
-		free(event.data);
+		Events::release(event.data);
 	}
 
 	if(state == oldState){
@@ -2,11 +2,13 @@
 #include <driver/gpio.h>
 #include "esp_log.h"
 #include "Util/Services.h"
+#include "Services/ROS/SensorBridge.h"
 
 MotionSensor::MotionSensor(ModuleBus bus) : Threaded("MotionSens", 2 * 1024),
 											pin(bus == ModuleBus::Left ? (gpio_num_t) A_CTRL_1 : (gpio_num_t) B_CTRL_1), bus(bus),
 											comm(*((Comm*) Services.get(Service::Comm))),
-											audio(*((Audio*) Services.get(Service::Audio))){
+											audio(*((Audio*) Services.get(Service::Audio))),
+											bridge(((SensorBridge*) Services.get(Service::SensorBridge))){
 	sem = xSemaphoreCreateBinary();
 
 	const gpio_config_t io_conf = {
@@ -65,5 +67,9 @@ void MotionSensor::loop(){
 	};
 
 	comm.sendModuleData(data);
+
+	if(bridge){
+		bridge->report(bus, { .state = lvl });
+	}
 }
 
@@ -4,6 +4,8 @@
 #include <atomic>
 #include "Services/Modules.h"
 
+class SensorBridge;
+
 class MotionSensor : private Threaded {
 public:
 	MotionSensor(ModuleBus bus);
@@ -14,6 +16,7 @@ private:
 	ModuleBus bus;
 	Comm& comm;
 	Audio& audio;
+	SensorBridge* bridge = nullptr;
 
 	void loop() override;
 	IRAM_ATTR static void isr(void* arg);
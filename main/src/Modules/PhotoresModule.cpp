@@ -1,9 +1,11 @@
 #include "PhotoresModule.h"
 #include "Util/Services.h"
+#include "Services/ROS/SensorBridge.h"
 
-PhotoresModule::PhotoresModule(ModuleBus bus, ADC& adc) : SleepyThreaded(Modules::ModuleSendInterval, "Photores", 2 * 1024),
+PhotoresModule::PhotoresModule(ModuleBus bus, ADC& adc) : SleepyThreaded(Modules::ModuleSendInterval, "Photores"),
 														  gpio(bus == ModuleBus::Left ? (gpio_num_t) A_CTRL_1 : (gpio_num_t) B_CTRL_1),
 														  comm(*((Comm*) Services.get(Service::Comm))),
+														  bridge(((SensorBridge*) Services.get(Service::SensorBridge))),
 														  bus(bus), adc(adc, gpio){
 	adc_unit_t unit;
 	adc_channel_t chan;
@@ -29,6 +31,10 @@ void PhotoresModule::sleepyLoop(){
 	};
 
 	comm.sendModuleData(data);
+
+	if(bridge){
+		bridge->report(bus, { .light = (float) level });
+	}
 }
 
 uint8_t PhotoresModule::getLevel(){
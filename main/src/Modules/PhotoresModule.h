@@ -4,6 +4,8 @@
 #include "Services/Modules.h"
 #include "Services/ADCReader.h"
 
+class SensorBridge;
+
 class PhotoresModule : private SleepyThreaded {
 public:
 	PhotoresModule(ModuleBus bus, ADC& adc);
@@ -12,6 +14,7 @@ public:
 private:
 	gpio_num_t gpio;
 	Comm& comm;
+	SensorBridge* bridge = nullptr;
 	ModuleBus bus;
 
 	void sleepyLoop() override;
@@ -2,9 +2,11 @@
 #include "Util/stdafx.h"
 #include "Services/Modules.h"
 #include "Util/Services.h"
+#include "Services/ROS/SensorBridge.h"
 
 TempHumModule::TempHumModule(I2C& i2c, ModuleBus bus) : SleepyThreaded(Modules::ModuleSendInterval, "TempHum", 2 * 1024),
-														i2c(i2c), bus(bus), comm(((Comm*) Services.get(Service::Comm))){
+														i2c(i2c), bus(bus), comm(((Comm*) Services.get(Service::Comm))),
+														bridge(((SensorBridge*) Services.get(Service::SensorBridge))){
 	ESP_ERROR_CHECK(i2c.write(Addr, 0x00));
 
 	start();
@@ -16,8 +18,10 @@ TempHumModule::~TempHumModule(){
 
 void TempHumModule::sleepyLoop(){
 	const auto data = readData();
-	const int16_t temp = (int16_t) getTemp(data);
-	const uint16_t humidity = (uint16_t) getHumidity(data);
+	const float tempValue = getTemp(data);
+	const float humidityValue = getHumidity(data);
+	const int16_t temp = (int16_t) tempValue;
+	const uint16_t humidity = (uint16_t) humidityValue;
 
 	const ModuleData md = {
 			ModuleType::TempHum, bus, { .tempHum = { temp, humidity } }
@@ -25,6 +29,10 @@ void TempHumModule::sleepyLoop(){
 	if(comm){
 		comm->sendModuleData(md);
 	}
+
+	if(bridge){
+		bridge->report(bus, { .temperature = tempValue, .humidity = humidityValue });
+	}
 }
 
 float TempHumModule::getHumidity(const std::array<uint8_t, 6>& data){
@@ -6,6 +6,8 @@
 #include "Services/Comm.h"
 #include <array>
 
+class SensorBridge;
+
 class TempHumModule : private SleepyThreaded {
 public:
 	TempHumModule(I2C& i2c, ModuleBus bus);
@@ -15,6 +17,7 @@ private:
 	I2C& i2c;
 	ModuleBus bus;
 	Comm* comm = nullptr;
+	SensorBridge* bridge = nullptr;
 
 	static constexpr uint8_t Addr = 0x38;
 
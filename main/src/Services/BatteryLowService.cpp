@@ -42,5 +42,5 @@ void BatteryLowService::loop(){
 		}
 	}
 
-	free(event.data);
+	Events::release(event.data);
 }
@@ -1,6 +1,12 @@
 #include "Comm.h"
 #include <RoverStateUtil.h>
 #include "Util/Services.h"
+#include "Util/stdafx.h"
+#include <esp_log.h>
+#include <cstring>
+#include <algorithm>
+
+static const char* TAG = "Comm";
 
 Comm::Comm() : Threaded("Comm", 4 * 1024), tcp(*(TCPServer*) Services.get(Service::TCP)), queue(10){
 	Events::listen(Facility::TCP, &queue);
@@ -71,9 +77,15 @@ void Comm::sendModulePlug(ModuleType type, ModuleBus bus, bool insert){
 void Comm::sendModuleData(ModuleData data){
 	if(!tcp.isConnected()) return;
 
-	auto type = CommType::ModuleData;
-	tcp.write((uint8_t*) &type, sizeof(CommType));
-	tcp.write((uint8_t*) &data, sizeof(ModuleData));
+	{
+		std::lock_guard lock(telemetryMut);
+		if(!telemetry.put(telemetryKey(data), data)){
+			ESP_LOGW(TAG, "No telemetry slot left, dropping module data");
+			return;
+		}
+	}
+
+	tcp.wake();
 }
 
 void Comm::sendNoFeed(bool noFeed){
@@ -88,26 +100,112 @@ void Comm::sendNoFeed(bool noFeed){
 void Comm::sendPacket(const ControlPacket& packet){
 	if(!tcp.isConnected()) return;
 
-	tcp.write((uint8_t*) &packet, sizeof(ControlPacket));
+	tcp.write((const uint8_t*) &packet, sizeof(ControlPacket));
 }
 
 void Comm::loop(){
-	bool readOK = false;
-	if(tcp.isConnected()){
-		ControlPacket packet{};
-		readOK = tcp.read(reinterpret_cast<uint8_t*>(&packet), sizeof(ControlPacket));
+	::Event event{};
+
+	if(!tcp.isConnected()){
+		rxBuf.clear();
+		linkIdle = true;
+
+		{
+			std::lock_guard lock(telemetryMut);
+			telemetry.clear();
+		}
+
+		if(queue.get(event, portMAX_DELAY)){
+			Events::release(event.data);
+		}
+		return;
+	}
 
-		if(readOK){
-			Event e = processPacket(packet);
-			Events::post(Facility::Comm, e);
+	// Sleeps until the client sends something, a send*() call or disconnect wakes it up, or rate-limited telemetry is due.
+	// wait() returns true on the timeout as well, receive() finds nothing then, and the telemetry that came due is queued
+	// without any traffic from the client.
+	if(tcp.wait(telemetryTimeout()) && receive()){
+		if(linkIdle){
+			queueTelemetry();
 		}
+
+		tcp.flush();
+		linkIdle = tcp.getPending() == 0;
+	}
+
+	while(queue.get(event, 0)){
+		Events::release(event.data);
+	}
+}
+
+void Comm::afterStopSignal(){
+	tcp.wake();
+	queue.unblock();
+}
+
+bool Comm::receive(){
+	for(;;){
+		size_t space;
+		uint8_t* dest = rxBuf.writePtr(space);
+		if(space == 0) break;
+
+		const int now = tcp.read(dest, space);
+		if(now < 0) return false;
+		if(now == 0) break;
+
+		rxBuf.commit(now);
 	}
 
-	if(!tcp.isConnected() || !readOK){
-		::Event event{};
-		while(!queue.get(event, portMAX_DELAY));
-		free(event.data);
+	ControlPacket packet{};
+	while(rxBuf.read((uint8_t*) &packet, sizeof(ControlPacket))){
+		Event e = processPacket(packet);
+		Events::post(e);
 	}
+
+	return true;
+}
+
+void Comm::queueTelemetry(){
+	std::lock_guard lock(telemetryMut);
+
+	telemetry.take(millis(), [this](const ModuleData& data){
+		uint8_t buf[sizeof(CommType) + sizeof(ModuleData)];
+		const auto type = CommType::ModuleData;
+		memcpy(buf, &type, sizeof(CommType));
+		memcpy(buf + sizeof(CommType), &data, sizeof(ModuleData));
+
+		return tcp.write(buf, sizeof(buf), true);
+	});
+}
+
+TickType_t Comm::telemetryTimeout(){
+	std::lock_guard lock(telemetryMut);
+	const uint64_t wait = telemetry.untilDue(millis());
+
+	// Blocked on the link: wait for it to drain rather than for the rate limit
+	if(wait == UINT64_MAX || !linkIdle) return portMAX_DELAY;
+
+	return pdMS_TO_TICKS(wait);
+}
+
+uint16_t Comm::telemetryKey(const ModuleData& data){
+	return ((uint16_t) data.type << 8) | (uint16_t) data.bus;
+}
+
+Comm::LaneStats Comm::getStats(){
+	LaneStats stats{
+		.controlPending = tcp.getPending(),
+		.controlPeak = tcp.getPendingPeak(),
+		.observers = tcp.getObserverCount()
+	};
+
+	std::lock_guard lock(telemetryMut);
+	stats.telemetryPending = telemetry.getPending();
+	stats.telemetrySlots = telemetry.getUsed();
+	stats.telemetrySent = telemetry.getSent();
+	stats.telemetryCoalesced = telemetry.getCoalesced();
+
+	return stats;
 }
 
 Comm::Event Comm::processPacket(const ControlPacket& packet){
@@ -4,7 +4,11 @@
 #include "TCPServer.h"
 #include "Util/Threaded.h"
 #include "Util/Events.h"
+#include "Util/RingBuffer.h"
+#include "Util/TelemetryLane.h"
 #include <CommData.h>
+#include <array>
+#include <mutex>
 
 class Comm : private Threaded {
 public:
@@ -38,17 +42,65 @@ public:
 	void sendCameraState(CameraRotation rotation, bool local = false);
 	void sendBattery(uint8_t batteryPercent);
 	void sendModulePlug(ModuleType type, ModuleBus bus, bool insert);
+	/**
+	 * Telemetry lane. Only the latest reading per module type and bus is kept, and each one is sent at most
+	 * once per TelemetryInterval, behind any pending state packets.
+	 */
 	void sendModuleData(ModuleData data);
 	void sendNoFeed(bool noFeed);
 
+	struct LaneStats {
+		size_t controlPending; // bytes queued on the link and not yet sent
+		size_t controlPeak; // highest controlPending since the client connected
+		size_t telemetryPending; // modules with a reading waiting to be sent
+		size_t telemetrySlots;
+		uint32_t telemetrySent;
+		uint32_t telemetryCoalesced; // readings replaced by a newer one before being sent
+		size_t observers; // read-only clients receiving the same stream
+	};
+	LaneStats getStats();
+
 private:
 	TCPServer& tcp;
 	void loop() override;
+	void afterStopSignal() override;
 	void sendPacket(const ControlPacket& packet);
 	Event processPacket(const ControlPacket& packet);
 
+	/**
+	 * Reads everything the socket has and posts an event for every complete packet.
+	 * @return false if the client disconnected
+	 */
+	bool receive();
+
+	static constexpr size_t RxBufSize = 64 * sizeof(ControlPacket);
+	RingBuffer<RxBufSize> rxBuf;
+
+	static constexpr uint32_t TelemetryInterval = 100; // [ms] per module type and bus
+	static constexpr size_t TelemetrySlots = 8;
+
+	TelemetryLane<ModuleData, TelemetrySlots> telemetry{ TelemetryInterval }; // keyed by module type and bus
+	std::mutex telemetryMut;
+
+	// Telemetry is only queued when the previous write went out whole, so it never sits ahead of a state packet
+	bool linkIdle = true;
+
+	static uint16_t telemetryKey(const ModuleData& data);
+
+	void queueTelemetry();
+	TickType_t telemetryTimeout();
+
 	EventQueue queue;
 };
 
+template<>
+struct EventTraits<Comm::Event> {
+	static constexpr Facility facility = Facility::Comm;
+
+	static uint8_t topic(const Comm::Event& event){
+		return (uint8_t) event.type;
+	}
+};
+
 
 #endif //PERSE_ROVER_COMM_H
@@ -6,35 +6,36 @@
 #include "Util/Services.h"
 #include "Audio.h"
 #include "Settings.h"
+#include "Services/ROS/ImagePublisher.h"
+#include "Services/ROS/MarkerPublisher.h"
+#include <esp_timer.h>
 
 const char* tag = "Feed";
 
 Feed::Feed(I2C& i2c) : SleepyThreaded(50, "Feed", 4 * 1024), queue(10),
-					   frameSendingThread(50, [this](){ this->sendFrame(); }, "FrameSending", 12 * 1024),
-					   communicationQueue(10), txBuf(static_cast<uint8_t*>(malloc(TxBufSize))){
-	memset(txBuf, 0, TxBufSize);
+					   captureThread(50, [this](){ this->captureFrame(); }, "FrameCapture", 12 * 1024, 5, CaptureCore),
+					   sendThread([this](){ this->sendFrame(); }, "FrameSending", 12 * 1024, 5, SendCore),
+					   communicationQueue(10), bitrate(std::size(Resolutions), MinFrameInterval, MaxFrameInterval){
 
 	Events::listen(Facility::TCP, &queue);
-	Events::listen(Facility::Comm, &queue);
+	Events::listen<Comm::Event, CommType::FeedQuality, CommType::ScanMarkers, CommType::ConnectionStrength>(&queue);
 
 	camera = std::make_unique<Camera>(i2c);
 	markerScanner = std::make_unique<MarkerScanner>(120, 160);
 
 	start();
-	frameSendingThread.start();
+	sendThread.start();
+	captureThread.start();
 }
 
 Feed::~Feed(){
-	frameSendingThread.stop();
+	captureThread.stop();
+	sendThread.stop();
 
 	if(LEDService* led = (LEDService*) Services.get(Service::LED)){
 		led->off(LED::Camera);
 	}
 
-	if(camera != nullptr){
-		camera->releaseFrame();
-	}
-
 	stop(0);
 	queue.unblock();
 	while(running()){
@@ -42,8 +43,6 @@ Feed::~Feed(){
 	}
 
 	Events::unlisten(&queue);
-
-	free(txBuf);
 }
 
 void Feed::disableScanning(){
@@ -60,6 +59,14 @@ void Feed::flipCam(bool flip){
 	communicationQueue.post(data, portMAX_DELAY);
 }
 
+void Feed::setImagePublisher(ImagePublisher* publisher){
+	rosImage = publisher;
+}
+
+void Feed::setMarkerPublisher(MarkerPublisher* publisher){
+	rosMarkers = publisher;
+}
+
 void Feed::sleepyLoop(){
 	::Event event{};
 	if(queue.get(event, portMAX_DELAY)){
@@ -81,6 +88,9 @@ void Feed::sleepyLoop(){
 					data.feedQuality = std::clamp(commEvent->feedQuality, (uint8_t) QualityLimits.x, (uint8_t) QualityLimits.y);
 
 					communicationQueue.post(data, portMAX_DELAY);
+				}else if(commEvent->type == CommType::ConnectionStrength){
+					std::lock_guard lock(bitrateMut);
+					bitrate.setWeakLink(commEvent->connectionStrength == ConnectionStrength::VeryLow);
 				}else if(commEvent->type == CommType::ScanMarkers){
 					EventData data;
 					data.type = EventData::ScanningEnableChange;
@@ -100,11 +110,32 @@ void Feed::sleepyLoop(){
 			}
 		}
 
-		free(event.data);
+		Events::release(event.data);
 	}
 }
 
-void IRAM_ATTR Feed::sendFrame(){
+Feed::PipelineStats Feed::getStats() const{
+	return {
+			.captured = capturedCount,
+			.dropped = droppedCount,
+			.encodeFailed = encodeFailedCount,
+			.sendFailed = sendFailedCount,
+			.sent = sentCount,
+			.queueDepth = (uint8_t) encodeQueue.count(),
+			.queueSize = PipelineDepth
+	};
+}
+
+uint8_t Feed::sensorQuality(uint8_t feedQuality){
+	feedQuality = std::clamp(feedQuality, (uint8_t) QualityLimits.x, (uint8_t) QualityLimits.y);
+
+	const int range = QualityLimits.y - QualityLimits.x;
+	const int step = (feedQuality - QualityLimits.x) * ((int) SensorQualityLimits.x - (int) SensorQualityLimits.y) / range;
+
+	return SensorQualityLimits.x - step;
+}
+
+void IRAM_ATTR Feed::captureFrame(){
 	for(EventData data; communicationQueue.get(data, 0);){
 		if(data.type == EventData::None){
 			continue;
@@ -112,6 +143,9 @@ void IRAM_ATTR Feed::sendFrame(){
 
 		if(data.type == EventData::FeedQualityChange){
 			feedQuality = data.feedQuality;
+
+			std::lock_guard lock(bitrateMut);
+			bitrate.setCeiling(feedQuality);
 		}else if(data.type == EventData::ScanningEnableChange){
 			isScanningEnabled = data.isScanningEnabled;
 
@@ -135,9 +169,42 @@ void IRAM_ATTR Feed::sendFrame(){
 		return;
 	}
 
-	camera->setFormat(PIXFORMAT_RGB565);
+	ImagePublisher* ros = rosImage;
+	const bool rosActive = ros != nullptr && ros->isActive();
+	const bool rosDue = rosActive && ros->isDue();
+	const bool rosOnly = rosActive && feedQuality == 0 && !isScanningEnabled;
+
+	uint8_t quality;
+	uint8_t resolution;
+	uint32_t interval;
+	{
+		std::lock_guard lock(bitrateMut);
+		bitrate.setMaxResolution(isScanningEnabled ? ScanResolution : std::size(Resolutions) - 1);
+		quality = bitrate.getQuality();
+		resolution = isScanningEnabled ? ScanResolution : bitrate.getResolution();
+		interval = bitrate.getInterval();
+	}
+
+	// A frame due on the ROS topic is taken at the ROS quality, the UDP feed gets that same frame.
+	// With ROS as the only consumer the camera stays at the largest resolution and the ROS quality in between frames too,
+	// instead of switching back and forth for every one of them.
+	if(rosDue || rosOnly){
+		quality = ros->getQuality();
+	}
+	if(rosOnly){
+		resolution = std::size(Resolutions) - 1;
+	}
+
+	// Sensor encodes JPEG on its own, RGB is only needed when frames are scanned
+	if(isScanningEnabled){
+		camera->setFormat(PIXFORMAT_RGB565);
+	}else{
+		camera->setFormat(PIXFORMAT_JPEG);
+		camera->setJpegQuality(sensorQuality(quality));
+	}
+	camera->setRes(Resolutions[resolution]);
 
-	if(feedQuality == 0 && !isScanningEnabled){
+	if(feedQuality == 0 && !isScanningEnabled && !rosActive){
 		if(LEDService* led = (LEDService*) Services.get(Service::LED)){
 			led->off(LED::Camera);
 		}
@@ -195,12 +262,27 @@ void IRAM_ATTR Feed::sendFrame(){
 		}
 	}
 
-	camera_fb_t* frameData = camera->getFrame();
-	if(frameData == nullptr || frameData->buf == nullptr || frameData->len == 0){
-		camera->releaseFrame();
+	// Scanning runs at the full frame rate, the feed is paced by the bitrate controller and the ROS topic by its own rate
+	const bool feedDue = feedQuality != 0 && millis() - lastCapture >= interval;
+	if(!isScanningEnabled && !feedDue && !rosDue){
 		return;
 	}
 
+	Camera::Frame frame = camera->getFrame();
+	if(!frame || frame->buf == nullptr || frame->len == 0){
+		return;
+	}
+
+	// A sensor-encoded frame started before the ROS quality reached the sensor is left to the other consumers,
+	// the topic takes the next one
+	const bool rosFrame = rosDue && (frame->format != PIXFORMAT_JPEG || camera->hasJpegQuality(frame));
+	if(!isScanningEnabled && !feedDue && !rosFrame){
+		return;
+	}
+
+	lastCapture = millis();
+	const int64_t captured = esp_timer_get_time();
+
 	DriveInfo driveInfo;
 
 	if(isScanningEnabled){
@@ -208,7 +290,8 @@ void IRAM_ATTR Feed::sendFrame(){
 			return;
 		}
 
-		markerScanner->process(frameData->buf, driveInfo);
+		markerScanner->process(frame->buf, driveInfo);
+		publishMarkers(driveInfo, captured);
 
 		if(driveInfo.markerInfo.action != MarkerAction::None){
 			frameFilterCounter = 0;
@@ -225,45 +308,110 @@ void IRAM_ATTR Feed::sendFrame(){
 		}
 	}
 
-	if(!frame2jpg(frameData, std::clamp((uint8_t) feedQuality, (uint8_t) QualityLimits.x, (uint8_t) QualityLimits.y),
-				  (uint8_t**) (&driveInfo.frame.data), &driveInfo.frame.size)){
-		ESP_LOGE(tag, "frame2jpg conversion failed.");
-		camera->releaseFrame();
-		return;
+	capturedCount++;
+
+	FrameJob job{
+			.frame = std::move(frame),
+			.driveInfo = std::move(driveInfo),
+			.quality = quality,
+			.udp = isScanningEnabled || feedDue,
+			.ros = rosFrame,
+			.captured = captured
+	};
+
+	// Encoder still busy with the previous frame, this one is dropped and its buffer released
+	if(!encodeQueue.post(std::move(job), 0)){
+		droppedCount++;
+	}
+}
+
+void Feed::publishMarkers(const DriveInfo& driveInfo, int64_t captured){
+	MarkerPublisher* publisher = rosMarkers;
+	if(publisher == nullptr) return;
+
+	MarkerPublisher::Detections detections;
+	detections.captured = captured;
+
+	for(const Marker& marker : driveInfo.markerInfo.markers){
+		if(detections.count == MarkerPublisher::MaxMarkers) break;
+
+		auto& point = detections.markers[detections.count++];
+		point.id = marker.id;
+		point.score = markerScanner->score(marker);
+		for(uint8_t i = 0; i < 4; ++i){
+			point.corners[2 * i] = marker.projected[i].first;
+			point.corners[2 * i + 1] = marker.projected[i].second;
+		}
 	}
 
-	const size_t frameSize = driveInfo.size();
-	const size_t sendSize = frameSize + sizeof(FrameHeader) + sizeof(FrameTrailer) + sizeof(size_t) * 2;
+	publisher->post(std::move(detections));
+}
 
-	if(sendSize > TxBufSize){
-		ESP_LOGW(tag, "Data frame buffer larger than send buffer. %zu > %zu\n", sendSize, TxBufSize);
-		camera->releaseFrame();
+void IRAM_ATTR Feed::sendFrame(){
+	FrameJob job;
+	if(!encodeQueue.get(job, SendWait)){
 		return;
 	}
 
-	size_t cursor = 0;
-	auto addData = [&cursor, this](const void* data, size_t size){
-		memcpy(txBuf + cursor, data, size);
-		cursor += size;
-	};
+	const uint8_t* jpegData;
+	size_t jpegSize;
+
+	ImagePublisher* ros = job.ros ? rosImage.load() : nullptr;
+
+	if(job.frame->format == PIXFORMAT_JPEG){
+		// Sent straight from the camera buffer, which is held until the frame is out. The ROS publisher takes a copy,
+		// so the buffer isn't held any longer for the micro-ROS task.
+		jpegData = job.frame->buf;
+		jpegSize = job.frame->len;
+
+		if(ros != nullptr){
+			ros->publish(jpegData, jpegSize, job.captured);
+		}
+	}else{
+		const bool encoded = jpeg.encode(job.frame.get(), job.quality);
+
+		// Everything past this point only reads the JPEG arena, so the capture buffer is handed back to the driver before sending
+		job.frame.release();
+
+		if(!encoded){
+			ESP_LOGE(tag, "JPEG conversion failed.");
+			encodeFailedCount++;
+			return;
+		}
 
-	uint8_t shiftedFrame[4];
-	for(uint8_t i = 0; i < 4; i++){
-		shiftedFrame[FrameSizeShift[i]] = ((uint8_t*) &frameSize)[i];
+		jpegData = jpeg.data();
+		jpegSize = jpeg.size();
+
+		// The arena is reused by the next frame, the publisher takes a copy
+		if(ros != nullptr){
+			ros->publish(jpegData, jpegSize, job.captured);
+		}
 	}
-	addData(FrameHeader, sizeof(FrameHeader));
-	addData(&frameSize, sizeof(size_t));
-	addData(shiftedFrame, sizeof(size_t));
-	driveInfo.toData(txBuf + cursor);
-	cursor += frameSize;
-	addData(FrameTrailer, sizeof(FrameTrailer));
-
-	size_t sent = 0;
-	while(sent < sendSize){
-		const size_t sending = std::min((size_t) CONFIG_TCP_MSS, sendSize - sent);
-		udp.write(txBuf + sent, sending);
-		sent += sending;
+
+	if(job.udp){
+		// Only the small DriveInfo part is serialized, the JPEG is gathered into the datagrams from where it already is
+		DriveInfo& driveInfo = job.driveInfo;
+		driveInfo.frame.data = nullptr;
+		driveInfo.frame.size = 0;
+
+		metaBuf.resize(driveInfo.size());
+		driveInfo.toData(metaBuf.data());
+
+		const uint64_t sendStart = millis();
+		const bool written = udp.writeFrame(metaBuf.data(), metaBuf.size(), jpegData, jpegSize);
+		const uint32_t sendTime = millis() - sendStart;
+
+		{
+			std::lock_guard lock(bitrateMut);
+			bitrate.frameSent(metaBuf.size() + jpegSize, sendTime, udp.takeRetries() + !written);
+		}
+
+		if(written){
+			sentCount++;
+		}else{
+			sendFailedCount++;
+		}
 	}
 
-	camera->releaseFrame();
+	job.frame.release();
 }
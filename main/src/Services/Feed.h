@@ -11,6 +11,13 @@
 #include "Util/Events.h"
 #include "Util/MarkerScanner.h"
 #include "Util/Queue.h"
+#include "Util/JpegArena.h"
+#include "Util/SPSCQueue.h"
+#include "Util/BitrateController.h"
+#include <mutex>
+
+class ImagePublisher;
+class MarkerPublisher;
 
 class Feed : private SleepyThreaded {
 public:
@@ -31,6 +38,29 @@ public:
 
 	void flipCam(bool flip);
 
+	/**
+	 * Frames are also published on micro-ROS through this publisher, at its own rate and quality.
+	 * The camera stays on while the topic is active, even with the UDP feed off.
+	 */
+	void setImagePublisher(ImagePublisher* publisher);
+
+	/**
+	 * Every scanned frame's markers are handed to this publisher, without waiting on it.
+	 */
+	void setMarkerPublisher(MarkerPublisher* publisher);
+
+	struct PipelineStats {
+		uint32_t captured; // frames grabbed from the camera and scanned
+		uint32_t dropped; // scanned frames dropped because the encoder was still busy
+		uint32_t encodeFailed;
+		uint32_t sendFailed; // frames cut short by a failed fragment
+		uint32_t sent;
+		uint8_t queueDepth; // scanned frames waiting for the encoder
+		uint8_t queueSize;
+	};
+
+	PipelineStats getStats() const;
+
 protected:
 	virtual void sleepyLoop() override;
 
@@ -39,9 +69,13 @@ private:
 	EventQueue queue;
 	std::atomic<uint8_t> feedQuality = 0; // [0 - 10], if 0, camera feed doesn't get sent
 	std::atomic<bool> isScanningEnabled = false;
-	SleepyThreadedClosure frameSendingThread;
+	std::atomic<ImagePublisher*> rosImage = nullptr;
+	std::atomic<MarkerPublisher*> rosMarkers = nullptr;
+	SleepyThreadedClosure captureThread;
+	ThreadedClosure sendThread;
 	std::unique_ptr<Camera> camera;
 	std::unique_ptr<MarkerScanner> markerScanner;
+	JpegArena jpeg;
 	MarkerAction oldAction = MarkerAction::None;
 	bool shouldPlayAudioOnCamFailure = true;
 
@@ -62,15 +96,55 @@ private:
 	};
 	Queue<EventData> communicationQueue;
 
+	// Frame N + 1 is captured and scanned on one core while frame N is encoded and sent on the other
+	static constexpr int8_t CaptureCore = 1;
+	static constexpr int8_t SendCore = 0;
+	static constexpr TickType_t SendWait = 100;
+
+	struct FrameJob {
+		Camera::Frame frame;
+		DriveInfo driveInfo;
+		uint8_t quality = 0;
+		bool udp = false; // sent on the UDP feed
+		bool ros = false; // published on the ROS image topic
+		int64_t captured = 0; // [us] esp_timer time
+	};
+
+	// Both camera buffers are in use when one frame is queued and one is being encoded
+	static constexpr size_t PipelineDepth = 1;
+	SPSCQueue<FrameJob, PipelineDepth> encodeQueue;
+
+	std::atomic<uint32_t> capturedCount = 0;
+	std::atomic<uint32_t> droppedCount = 0;
+	std::atomic<uint32_t> encodeFailedCount = 0;
+	std::atomic<uint32_t> sendFailedCount = 0;
+	std::atomic<uint32_t> sentCount = 0;
+
 	static constexpr glm::vec<2, uint8_t> QualityLimits = { 0, 30};
-	static constexpr size_t TxBufSize = 10000;
-	uint8_t* txBuf;
+
+	// Feed resolution steps for the bitrate controller, the largest one is what the scanner expects
+	static constexpr framesize_t Resolutions[] = { FRAMESIZE_96X96, FRAMESIZE_QQVGA };
+	static constexpr uint8_t ScanResolution = 1;
+	static constexpr uint32_t MinFrameInterval = 50;
+	static constexpr uint32_t MaxFrameInterval = 500;
+
+	// Written by the sending stage, read by the capture stage
+	BitrateController bitrate;
+	std::mutex bitrateMut;
+	uint64_t lastCapture = 0;
+
+	// Sensor JPEG quality for the lowest and highest feed quality, lower is better
+	static constexpr glm::vec<2, uint8_t> SensorQualityLimits = { 40, 10 };
+	static uint8_t sensorQuality(uint8_t feedQuality);
+	std::vector<uint8_t> metaBuf; // serialized DriveInfo, without the camera frame
 
 	uint8_t frameFilterCounter = 0;
 	static constexpr uint8_t FrameFilterCount = 4; //scanned marker always persists for at least 4 frames, to smoothen recognition
 
 private:
+	void captureFrame();
 	void sendFrame();
+	void publishMarkers(const DriveInfo& driveInfo, int64_t captured);
 };
 
 #endif //PERSE_ROVER_FEED_H
\ No newline at end of file
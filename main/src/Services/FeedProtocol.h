@@ -0,0 +1,34 @@
+#ifndef PERSE_ROVER_FEEDPROTOCOL_H
+#define PERSE_ROVER_FEEDPROTOCOL_H
+
+#include <cstdint>
+
+/**
+ * Camera feed datagram format. Every frame is split into fragments that each fit a single datagram,
+ * and every fragment starts with this header followed by up to FragmentPayload bytes of the frame.
+ * A frame is the serialized DriveInfo without its camera frame (metaSize bytes), directly followed by the JPEG.
+ * Each frame is a self-contained JPEG, so a receiver drops incomplete or corrupted frames and carries on
+ * with the next frame ID.
+ * Receivers ignore fragments with a different magic or version, so an old receiver never misreads a newer rover.
+ */
+struct __attribute__((packed)) FeedFragmentHeader {
+	uint16_t magic;
+	uint8_t version; // FeedProtocolVersion
+	uint8_t reserved;
+	uint16_t frameID; // increments with every frame, wraps around
+	uint16_t index; // [0 - count)
+	uint16_t count;
+	uint32_t frameSize; // total size of the frame, all fragments
+	uint16_t metaSize; // size of the DriveInfo part at the start of the frame
+	uint32_t crc; // CRC-32 of this fragment's payload
+};
+
+static constexpr uint16_t FeedFragmentMagic = 0x5046;
+
+/**
+ * Bump whenever the header or the frame layout changes. 1 is the fragment format with the DriveInfo
+ * sent ahead of the JPEG in the same frame.
+ */
+static constexpr uint8_t FeedProtocolVersion = 1;
+
+#endif //PERSE_ROVER_FEEDPROTOCOL_H
@@ -99,7 +99,7 @@ bool InactivityService::checkActions(){
 		default:
 			break;
 	}
-	free(e.data);
+	Events::release(e.data);
 
 	return action;
 }
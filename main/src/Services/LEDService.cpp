@@ -24,7 +24,7 @@ const std::map<LED, LEDService::ExpanderMappingInfo> LEDService::ExpanderMapping
 		{ LED::StatusRed,       { EXP_LED_STATUS_RED,    0xFF }},
 };
 
-LEDService::LEDService(AW9523& aw9523) : Threaded("LEDService"), instructionQueue(25){
+LEDService::LEDService(AW9523& aw9523) : instructionQueue(InstructionQueueSize), job("LEDService", 0, [this](){ tick(); }){
 	for(LED led = (LED) 0; (uint8_t) led < (uint8_t) LED::COUNT; led = (LED) ((uint8_t) led + 1)){
 		const bool isExpander = ExpanderMappings.contains(led);
 		const bool isPwm = PwmMappings.contains(led);
@@ -41,11 +41,11 @@ LEDService::LEDService(AW9523& aw9523) : Threaded("LEDService"), instructionQueu
 			ledDevices[led] = ledDevice;
 		}
 	}
-
-	start();
 }
 
 LEDService::~LEDService(){
+	Scheduler::remove(&job);
+
 	ledFunctions.clear();
 
 	for(auto led: ledDevices){
@@ -59,7 +59,7 @@ void LEDService::on(LED led){
 			.instruction = On
 	};
 
-	instructionQueue.post(instruction);
+	postInstruction(instruction);
 }
 
 void LEDService::off(LED led){
@@ -68,7 +68,7 @@ void LEDService::off(LED led){
 			.instruction = Off
 	};
 
-	instructionQueue.post(instruction);
+	postInstruction(instruction);
 }
 
 void LEDService::blink(LED led, uint32_t count /*= 1*/, uint32_t period /*= 1000*/){
@@ -79,7 +79,7 @@ void LEDService::blink(LED led, uint32_t count /*= 1*/, uint32_t period /*= 1000
 			.period = period
 	};
 
-	instructionQueue.post(instruction);
+	postInstruction(instruction);
 }
 
 void LEDService::breathe(LED led, uint32_t period /*= 1000*/){
@@ -90,7 +90,7 @@ void LEDService::breathe(LED led, uint32_t period /*= 1000*/){
 			.period = period
 	};
 
-	instructionQueue.post(instruction);
+	postInstruction(instruction);
 }
 
 void LEDService::set(LED led, float percent){
@@ -100,7 +100,7 @@ void LEDService::set(LED led, float percent){
 		.targetPercent = std::clamp(percent, 0.0f, 100.0f)
 	};
 
-	instructionQueue.post(instruction);
+	postInstruction(instruction);
 }
 
 void LEDService::breatheTo(LED led, float targetPercent, uint32_t duration){
@@ -111,26 +111,48 @@ void LEDService::breatheTo(LED led, float targetPercent, uint32_t duration){
 			.targetPercent = std::clamp(targetPercent, 0.0f, 100.0f)
 	};
 
-	instructionQueue.post(instruction);
-}
-
-void LEDService::loop(){
-	for(LEDInstructionInfo instructionInfo; instructionQueue.get(instructionInfo, 10);){
-		if(instructionInfo.instruction == On){
-			onInternal(instructionInfo.led);
-		}else if(instructionInfo.instruction == Off){
-			offInternal(instructionInfo.led);
-		}else if(instructionInfo.instruction == Blink){
-			blinkInternal(instructionInfo.led, instructionInfo.count, instructionInfo.period);
-		}else if(instructionInfo.instruction == Breathe){
-			breatheInternal(instructionInfo.led, instructionInfo.period);
-		}else if(instructionInfo.instruction == BreatheTo){
-			breatheToInternal(instructionInfo.led, instructionInfo.targetPercent, instructionInfo.period);
-		}else if(instructionInfo.instruction == Set){
-			setInternal(instructionInfo.led, instructionInfo.targetPercent);
+	postInstruction(instruction);
+}
+
+void LEDService::postInstruction(LEDInstructionInfo& instruction){
+	if((uint8_t) instruction.led >= (uint8_t) LED::COUNT) return;
+
+	{
+		std::lock_guard lock(instructionMut);
+
+		// Once something is coalesced, everything after it has to be too, or it would be applied before it
+		if(coalescedPending != 0 || !instructionQueue.post(instruction, 0)){
+			coalesced[(uint8_t) instruction.led] = instruction;
+			coalescedPending |= 1 << (uint8_t) instruction.led;
 		}
 	}
 
+	Scheduler::trigger(&job);
+}
+
+void LEDService::tick(){
+	// Everything queued is older than anything coalesced, both are taken at once so nothing posted in between gets ahead
+	std::array<LEDInstructionInfo, InstructionQueueSize + (size_t) LED::COUNT> instructions;
+	size_t count = 0;
+	{
+		std::lock_guard lock(instructionMut);
+
+		while(count < InstructionQueueSize && instructionQueue.get(instructions[count], 0)){
+			count++;
+		}
+
+		for(uint8_t i = 0; i < (uint8_t) LED::COUNT; ++i){
+			if(coalescedPending & (1 << i)){
+				instructions[count++] = coalesced[i];
+			}
+		}
+		coalescedPending = 0;
+	}
+
+	for(size_t i = 0; i < count; ++i){
+		apply(instructions[i]);
+	}
+
 	for(LED led = (LED) 0; (uint8_t) led < (uint8_t) LED::COUNT; led = (LED) ((uint8_t) led + 1)){
 		if(!ledFunctions.contains(led)){
 			continue;
@@ -138,6 +160,26 @@ void LEDService::loop(){
 
 		ledFunctions[led]->loop();
 	}
+
+	if(!ledFunctions.empty()){
+		Scheduler::trigger(&job, pdMS_TO_TICKS(TickInterval));
+	}
+}
+
+void LEDService::apply(const LEDInstructionInfo& instructionInfo){
+	if(instructionInfo.instruction == On){
+		onInternal(instructionInfo.led);
+	}else if(instructionInfo.instruction == Off){
+		offInternal(instructionInfo.led);
+	}else if(instructionInfo.instruction == Blink){
+		blinkInternal(instructionInfo.led, instructionInfo.count, instructionInfo.period);
+	}else if(instructionInfo.instruction == Breathe){
+		breatheInternal(instructionInfo.led, instructionInfo.period);
+	}else if(instructionInfo.instruction == BreatheTo){
+		breatheToInternal(instructionInfo.led, instructionInfo.targetPercent, instructionInfo.period);
+	}else if(instructionInfo.instruction == Set){
+		setInternal(instructionInfo.led, instructionInfo.targetPercent);
+	}
 }
 
 void LEDService::onInternal(LED led){
@@ -2,13 +2,14 @@
 #define PERSE_ROVER_LEDSERVICE_H
 
 #include <cstdint>
+#include <array>
 #include <map>
 #include <tuple>
 #include <driver/ledc.h>
 #include <memory>
 #include <mutex>
 #include "Devices/AW9523.h"
-#include "Util/Threaded.h"
+#include "Util/Scheduler.h"
 #include "Util/Queue.h"
 
 enum class LED : uint8_t {
@@ -25,7 +26,7 @@ enum class LED : uint8_t {
 	COUNT
 };
 
-class LEDService : private Threaded {
+class LEDService {
 public:
 	explicit LEDService(AW9523& aw9523);
 
@@ -43,9 +44,6 @@ public:
 
 	void breatheTo(LED led, float targetPercent, uint32_t duration = 250);
 
-protected:
-	virtual void loop() override;
-
 private:
 	struct PwnMappingInfo {
 		gpio_num_t pin = GPIO_NUM_NC;
@@ -81,7 +79,22 @@ private:
 
 	std::map<LED, class SingleLED*> ledDevices;
 	std::map<LED, std::unique_ptr<class LEDFunction>> ledFunctions;
+
+	// Posted from any task, Scheduler jobs included, so posting never waits on the LED job. Once the queue is full,
+	// instructions are coalesced to the latest one per LED until tick() catches up, and every LED still ends up in its last state.
+	static constexpr size_t InstructionQueueSize = 25;
 	Queue<LEDInstructionInfo> instructionQueue;
+	std::array<LEDInstructionInfo, (size_t) LED::COUNT> coalesced;
+	uint16_t coalescedPending = 0; // bit per LED with an instruction in coalesced
+	static_assert((size_t) LED::COUNT <= 16);
+	std::mutex instructionMut; // guards coalesced, and keeps it and the queue in posting order. Never held while waiting.
+	void postInstruction(LEDInstructionInfo& instruction);
+	void apply(const LEDInstructionInfo& instruction);
+
+	// Runs when an instruction is posted, and every TickInterval while an LED function is active
+	static constexpr uint32_t TickInterval = 10; // [ms]
+	void tick();
+	Scheduler::Job job;
 
 private:
 	void onInternal(LED led);
@@ -1,256 +1,517 @@
 #include "MicroROS.h"
-#include <string.h>
-#include <stdio.h>
-#include <unistd.h>
 #include <esp_log.h>
-#include <cmath>
-
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <algorithm>
 #include <uros_network_interfaces.h>
-#include <rcl/rcl.h>
 #include <rcl/error_handling.h>
-#include <rclc/rclc.h>
-#include <rclc/executor.h>
-#include <std_msgs/msg/int32.h>
-#include <std_msgs/msg/float32.h>
-#include <geometry_msgs/msg/twist.h>
-#include <sensor_msgs/msg/battery_state.h>
+#include <rcutils/allocator.h>
+#include "Util/Services.h"
+#include "Periph/WiFiSTA.h"
 
 #ifdef CONFIG_MICRO_ROS_ESP_XRCE_DDS_MIDDLEWARE
 #include <rmw_microros/rmw_microros.h>
 #endif
 
-#include "Util/Services.h"
-#include "Devices/Battery.h"
-#include "Devices/MotorDriveController.h"
-#include "CommData.h"
-
 static const char* TAG = "MicroROS";
 
-// Error handling macros
-#define RCCHECK(fn) { rcl_ret_t temp_rc = fn; if((temp_rc != RCL_RET_OK)){ \
-    ESP_LOGE(TAG, "Failed status on line %d: %d. Aborting.", __LINE__, (int)temp_rc); \
-    vTaskDelete(NULL); }}
-
-#define RCSOFTCHECK(fn) { rcl_ret_t temp_rc = fn; if((temp_rc != RCL_RET_OK)){ \
-    ESP_LOGW(TAG, "Failed status on line %d: %d. Continuing.", __LINE__, (int)temp_rc); }}
-
-// ROS objects
-static rcl_publisher_t battery_publisher;
-static rcl_subscription_t cmd_vel_subscriber;
-static rcl_timer_t battery_timer;
-
-// ROS messages
-static sensor_msgs__msg__BatteryState battery_msg;
-static geometry_msgs__msg__Twist cmd_vel_msg;
-
-// Constants
-static constexpr int EXECUTOR_NUM_HANDLES = 2; // 1 timer + 1 subscription
-static constexpr int WIFI_INIT_WAIT_MS = 5000;
-static constexpr float BATTERY_FIELD_UNKNOWN = NAN;
-
-// Timer callback for publishing battery status
-void battery_timer_callback(rcl_timer_t* timer, int64_t last_call_time) {
-    (void) last_call_time;
-    if (timer != NULL) {
-        Battery* battery = (Battery*) Services.get(Service::Battery);
-        if (battery != nullptr) {
-            battery_msg.percentage = (float)battery->getPerc() / 100.0f;
-            battery_msg.voltage = BATTERY_FIELD_UNKNOWN;
-            battery_msg.current = BATTERY_FIELD_UNKNOWN;
-            battery_msg.capacity = BATTERY_FIELD_UNKNOWN;
-            battery_msg.design_capacity = BATTERY_FIELD_UNKNOWN;
-            battery_msg.charge = BATTERY_FIELD_UNKNOWN;
-            battery_msg.power_supply_status = sensor_msgs__msg__BatteryState__POWER_SUPPLY_STATUS_DISCHARGING;
-            battery_msg.power_supply_health = sensor_msgs__msg__BatteryState__POWER_SUPPLY_HEALTH_UNKNOWN;
-            battery_msg.power_supply_technology = sensor_msgs__msg__BatteryState__POWER_SUPPLY_TECHNOLOGY_UNKNOWN;
-            battery_msg.present = true;
-
-            RCSOFTCHECK(rcl_publish(&battery_publisher, &battery_msg, NULL));
-            ESP_LOGI(TAG, "Published battery: %.1f%%", battery_msg.percentage * 100.0f);
-        }
-    }
-}
-
-// Subscription callback for cmd_vel messages
-void cmd_vel_subscription_callback(const void* msgin) {
-    const geometry_msgs__msg__Twist* msg = (const geometry_msgs__msg__Twist*)msgin;
-    
-    ESP_LOGI(TAG, "Received cmd_vel - linear.x: %.2f, angular.z: %.2f", 
-             msg->linear.x, msg->angular.z);
-    
-    MotorDriveController* motorController = (MotorDriveController*) Services.get(Service::MotorDriveController);
-    if (motorController != nullptr) {
-        // Convert Twist message to motor drive state
-        // linear.x is forward/backward velocity (-1.0 to 1.0)
-        // angular.z is rotational velocity (-1.0 to 1.0)
-        
-        float linear = msg->linear.x;
-        float angular = msg->angular.z;
-        
-        // Simple differential drive calculation
-        // For now, we'll create a simple mapping to the existing drive direction format
-        MotorDriveState state;
-        
-        // Determine direction based on linear and angular velocities
-        if (fabs(linear) < 0.01f && fabs(angular) < 0.01f) {
-            // Stop
-            state.DriveDirection.dir = 0;
-            state.DriveDirection.speed = 0.0f;
-        } else if (fabs(angular) < 0.01f) {
-            // Pure forward/backward
-            if (linear > 0) {
-                state.DriveDirection.dir = 1; // Forward
-            } else {
-                state.DriveDirection.dir = 2; // Backward
-            }
-            state.DriveDirection.speed = fabs(linear);
-        } else if (fabs(linear) < 0.01f) {
-            // Pure rotation
-            if (angular > 0) {
-                state.DriveDirection.dir = 3; // Left
-            } else {
-                state.DriveDirection.dir = 4; // Right
-            }
-            state.DriveDirection.speed = fabs(angular);
-        } else {
-            // Mixed motion - use linear direction with speed adjusted by both
-            if (linear > 0) {
-                state.DriveDirection.dir = 1; // Forward
-            } else {
-                state.DriveDirection.dir = 2; // Backward
-            }
-            // Use maximum of linear and angular for simpler calculation
-            state.DriveDirection.speed = fmax(fabs(linear), fabs(angular));
-            if (state.DriveDirection.speed > 1.0f) {
-                state.DriveDirection.speed = 1.0f;
-            }
-        }
-        
-        motorController->setRemotely(state);
-    }
-}
-
-void MicroROS::microRosTask(void* arg) {
-    (void) arg;
-    
-    ESP_LOGI(TAG, "Starting micro-ROS task");
-    
-    // Wait for WiFi to be initialized
-    vTaskDelay(pdMS_TO_TICKS(WIFI_INIT_WAIT_MS));
-    
-    rcl_allocator_t allocator = rcl_get_default_allocator();
-    rclc_support_t support;
-
-    // Create init_options
-    rcl_init_options_t init_options = rcl_get_zero_initialized_init_options();
-    RCCHECK(rcl_init_options_init(&init_options, allocator));
+#define RCCHECK(fn) { rcl_ret_t temp_rc = fn; if((temp_rc != RCL_RET_OK)){ ESP_LOGE(TAG, "Failed status on line %d: %d", __LINE__, (int)temp_rc); return false; }}
+#define RCSOFTCHECK(fn) { rcl_ret_t temp_rc = fn; if((temp_rc != RCL_RET_OK)){ ESP_LOGW(TAG, "Failed status on line %d: %d", __LINE__, (int)temp_rc); }}
+
+// rcutils allocator hooks, state is the ArenaAllocator
+static void* arenaAllocate(size_t size, void* state){
+	return ((ArenaAllocator*) state)->alloc(size);
+}
+
+static void arenaDeallocate(void* pointer, void* state){
+	((ArenaAllocator*) state)->free(pointer);
+}
+
+static void* arenaReallocate(void* pointer, size_t size, void* state){
+	return ((ArenaAllocator*) state)->realloc(pointer, size);
+}
+
+static void* arenaZeroAllocate(size_t count, size_t size, void* state){
+	return ((ArenaAllocator*) state)->calloc(count, size);
+}
+
+MicroROS::MicroROS() : Threaded("MicroROS", CONFIG_MICRO_ROS_APP_STACK, CONFIG_MICRO_ROS_APP_TASK_PRIO), arena(ArenaSize), queue(10){
+	// Installed as the default for the length of a session, so whatever rcl frees internally is routed by where it came from.
+	// What comes from the arena is decided by ArenaAllocator: the micro-ROS task while setting up, the heap otherwise.
+	heapAllocator = rcutils_get_default_allocator();
+	allocator = rcutils_get_zero_initialized_allocator();
+	allocator.allocate = arenaAllocate;
+	allocator.deallocate = arenaDeallocate;
+	allocator.reallocate = arenaReallocate;
+	allocator.zero_allocate = arenaZeroAllocate;
+	allocator.state = &arena;
+
+	Events::listen(Facility::WiFi, &queue);
+
+	// The IP could have been assigned before this service started listening
+	if(const WiFiSTA* wifi = (WiFiSTA*) Services.get(Service::WiFi)){
+		networkUp = wifi->isConnected() && wifi->getIP() != "0.0.0.0";
+	}
+}
+
+MicroROS::~MicroROS(){
+	stop();
+	Events::unlisten(&queue);
+}
+
+void MicroROS::begin(){
+	ESP_LOGI(TAG, "Initializing micro-ROS");
+
+#if defined(CONFIG_MICRO_ROS_ESP_NETIF_WLAN) || defined(CONFIG_MICRO_ROS_ESP_NETIF_ENET)
+	ESP_ERROR_CHECK(uros_network_interface_initialize());
+#endif
+
+	start();
+}
+
+void MicroROS::add(Publisher* publisher){
+	std::lock_guard lock(mut);
+	added.push_back({ publisher, publisher, nullptr, this, false, false });
+	entriesChanged = true;
+}
+
+void MicroROS::add(Subscriber* subscriber){
+	std::lock_guard lock(mut);
+	added.push_back({ subscriber, nullptr, subscriber, this, false, false });
+	entriesChanged = true;
+}
+
+void MicroROS::remove(Endpoint* endpoint){
+	std::unique_lock lock(mut);
+
+	const auto match = [endpoint](const Entry& entry){ return entry.endpoint == endpoint; };
+
+	if(auto pending = std::find_if(added.begin(), added.end(), match); pending != added.end()){
+		added.erase(pending);
+		return;
+	}
+
+	auto entry = std::find_if(entries.begin(), entries.end(), match);
+	if(entry == entries.end()) return;
+
+	// During a session the micro-ROS task walks the entries without the lock, and the executor may be waiting on this one
+	if(connected){
+		entry->removing = true;
+		entriesChanged = true;
+		removed.wait(lock, [this, endpoint](){ return !connected || !contains(endpoint); });
+
+		if(!contains(endpoint)) return;
+	}
+
+	// No session, nothing was created on the node
+	entries.erase(entry);
+}
 
+bool MicroROS::contains(const Endpoint* endpoint) const{
+	return std::any_of(entries.cbegin(), entries.cend(), [endpoint](const Entry& entry){ return entry.endpoint == endpoint; });
+}
+
+builtin_interfaces__msg__Time MicroROS::toStamp(int64_t time){
 #ifdef CONFIG_MICRO_ROS_ESP_XRCE_DDS_MIDDLEWARE
-    rmw_init_options_t* rmw_options = rcl_init_options_get_rmw_init_options(&init_options);
-    
-    // Use static Agent IP and port from config
-    RCCHECK(rmw_uros_options_set_udp_address(CONFIG_MICRO_ROS_AGENT_IP, CONFIG_MICRO_ROS_AGENT_PORT, rmw_options));
+	const int64_t epoch = rmw_uros_epoch_nanos() - (esp_timer_get_time() - time) * 1000;
+#else
+	const int64_t epoch = time * 1000;
 #endif
 
-    // Create support structure
-    RCCHECK(rclc_support_init_with_options(&support, 0, NULL, &init_options, &allocator));
-
-    // Create node
-    rcl_node_t node = rcl_get_zero_initialized_node();
-    RCCHECK(rclc_node_init_default(&node, "perse_rover", "", &support));
-    
-    ESP_LOGI(TAG, "Node created: perse_rover");
-
-    // Create battery status publisher
-    RCCHECK(rclc_publisher_init_default(
-        &battery_publisher,
-        &node,
-        ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, BatteryState),
-        "battery_status"));
-    
-    ESP_LOGI(TAG, "Battery publisher created");
-
-    // Create cmd_vel subscriber
-    RCCHECK(rclc_subscription_init_default(
-        &cmd_vel_subscriber,
-        &node,
-        ROSIDL_GET_MSG_TYPE_SUPPORT(geometry_msgs, msg, Twist),
-        "cmd_vel"));
-    
-    ESP_LOGI(TAG, "cmd_vel subscriber created");
-
-    // Create battery status timer (publish at 1 Hz)
-    const unsigned int battery_timer_timeout = 1000;
-    RCCHECK(rclc_timer_init_default2(
-        &battery_timer,
-        &support,
-        RCL_MS_TO_NS(battery_timer_timeout),
-        battery_timer_callback,
-        true));
-    
-    ESP_LOGI(TAG, "Battery timer created");
-
-    // Initialize battery message
-    sensor_msgs__msg__BatteryState__init(&battery_msg);
-    static const char BATTERY_FRAME_ID[] = "battery";
-    battery_msg.header.frame_id.data = const_cast<char*>(BATTERY_FRAME_ID);
-    battery_msg.header.frame_id.size = strlen(BATTERY_FRAME_ID);
-    battery_msg.header.frame_id.capacity = battery_msg.header.frame_id.size + 1;
-
-    // Initialize cmd_vel message
-    geometry_msgs__msg__Twist__init(&cmd_vel_msg);
-
-    // Create executor
-    rclc_executor_t executor = rclc_executor_get_zero_initialized_executor();
-    RCCHECK(rclc_executor_init(&executor, &support.context, EXECUTOR_NUM_HANDLES, &allocator));
-    
-    // Add timer and subscription to executor
-    RCCHECK(rclc_executor_add_timer(&executor, &battery_timer));
-    RCCHECK(rclc_executor_add_subscription(&executor, &cmd_vel_subscriber, &cmd_vel_msg, 
-                                           &cmd_vel_subscription_callback, ON_NEW_DATA));
-    
-    ESP_LOGI(TAG, "Executor initialized and spinning");
-
-    // Spin executor indefinitely
-    while(1) {
-        rclc_executor_spin_some(&executor, RCL_MS_TO_NS(100));
-        usleep(10000);
-    }
-}
-
-MicroROS::MicroROS() {
-}
-
-MicroROS::~MicroROS() {
-    stop();
-}
-
-void MicroROS::begin() {
-    ESP_LOGI(TAG, "Initializing micro-ROS");
-    
-#if defined(CONFIG_MICRO_ROS_ESP_NETIF_WLAN) || defined(CONFIG_MICRO_ROS_ESP_NETIF_ENET)
-    ESP_ERROR_CHECK(uros_network_interface_initialize());
+	builtin_interfaces__msg__Time stamp;
+	stamp.sec = (int32_t) (epoch / 1000000000);
+	stamp.nanosec = (uint32_t) (epoch % 1000000000);
+	return stamp;
+}
+
+MicroROS::State MicroROS::getState() const{
+	return state;
+}
+
+bool MicroROS::isConnected() const{
+	return state == State::Connected;
+}
+
+void MicroROS::loop(){
+	switch(state){
+		case State::NoNetwork:
+			waitNetwork();
+			break;
+		case State::WaitingAgent:
+			waitAgent();
+			break;
+		case State::Connected:
+			spin();
+			break;
+	}
+
+	const int64_t now = esp_timer_get_time();
+	if(now - lastStats >= StatsInterval){
+		lastStats = now;
+		logStats();
+	}
+}
+
+void MicroROS::waitNetwork(){
+	if(networkUp){
+		backoff = MinBackoff;
+		state = State::WaitingAgent;
+		return;
+	}
+
+	processEvents(portMAX_DELAY);
+}
+
+void MicroROS::waitAgent(){
+	if(!networkUp){
+		state = State::NoNetwork;
+		return;
+	}
+
+	bool ok = pingAgent();
+	if(ok){
+		std::lock_guard lock(mut);
+		ok = connect();
+	}
+
+	if(ok){
+		backoff = MinBackoff;
+		state = State::Connected;
+		return;
+	}
+
+	ESP_LOGD(TAG, "No agent at %s:%s, retrying in %lu ms", CONFIG_MICRO_ROS_AGENT_IP, CONFIG_MICRO_ROS_AGENT_PORT, backoff);
+
+	// A WiFi event cuts the wait short
+	processEvents(pdMS_TO_TICKS(backoff));
+	backoff = std::min(backoff * 2, MaxBackoff);
+}
+
+void MicroROS::spin(){
+	processEvents(0);
+
+	if(!networkUp){
+		ESP_LOGW(TAG, "Network lost");
+		std::lock_guard lock(mut);
+		disconnect(true);
+		state = State::NoNetwork;
+		return;
+	}
+
+	{
+		std::lock_guard lock(mut);
+		if(entriesChanged){
+			const bool rebuilt = rebuildExecutor();
+
+			// Setup is done with the first build, anything created from here on can be removed again and goes to the heap
+			arena.seal();
+
+			if(!rebuilt){
+				ESP_LOGW(TAG, "Can't rebuild executor, reconnecting");
+				disconnect();
+				state = State::WaitingAgent;
+				return;
+			}
+		}
+	}
+
+	// Entities only change on this task, under the lock above, so the rest runs without it
+	const int64_t timeout = std::clamp<int64_t>(updatePublishers(), 0, MaxSpinTimeout);
+
+	if(executorReady){
+		// Waiting happens inside the transport, which returns as soon as data arrives,
+		// so the timeout is only there to wake up for the next publisher that's due
+		rclc_executor_spin_some(&executor, RCL_US_TO_NS(timeout));
+	}else{
+		processEvents(std::max<TickType_t>(1, pdMS_TO_TICKS(timeout / 1000)));
+	}
+
+	if(!checkAgent()){
+		ESP_LOGW(TAG, "Agent lost, waiting for it to come back");
+		std::lock_guard lock(mut);
+		disconnect(true);
+		state = State::WaitingAgent;
+	}
+}
+
+void MicroROS::processEvents(TickType_t timeout){
+	Event event{};
+	while(queue.get(event, timeout)){
+		if(event.facility == Facility::WiFi && event.data != nullptr){
+			const auto wifiEvent = (WiFiSTA::Event*) event.data;
+			if(wifiEvent->action == WiFiSTA::Event::GotIP){
+				networkUp = true;
+			}else if(wifiEvent->action == WiFiSTA::Event::Disconnect){
+				networkUp = false;
+			}
+		}
+
+		Events::release(event.data);
+		timeout = 0;
+	}
+}
+
+void MicroROS::onStop(){
+	std::lock_guard lock(mut);
+	disconnect();
+	state = State::NoNetwork;
+}
+
+void MicroROS::afterStopSignal(){
+	queue.unblock();
+}
+
+bool MicroROS::pingAgent(){
+#ifdef CONFIG_MICRO_ROS_ESP_XRCE_DDS_MIDDLEWARE
+	rcl_init_options_t initOptions = rcl_get_zero_initialized_init_options();
+	if(rcl_init_options_init(&initOptions, allocator) != RCL_RET_OK){
+		rcl_reset_error();
+		return false;
+	}
+
+	rmw_init_options_t* rmwOptions = rcl_init_options_get_rmw_init_options(&initOptions);
+	rmw_uros_options_set_udp_address(CONFIG_MICRO_ROS_AGENT_IP, CONFIG_MICRO_ROS_AGENT_PORT, rmwOptions);
+	const bool reachable = rmw_uros_ping_agent_options(100, 1, rmwOptions) == RMW_RET_OK;
+
+	rcl_init_options_fini(&initOptions);
+
+	return reachable;
+#else
+	return true;
+#endif
+}
+
+bool MicroROS::connect(){
+	if(!rcutils_set_default_allocator(&allocator)){
+		ESP_LOGW(TAG, "Can't set the arena as the default allocator");
+	}
+	arena.open();
+
+	rcl_init_options_t initOptions = rcl_get_zero_initialized_init_options();
+	RCCHECK(rcl_init_options_init(&initOptions, allocator));
+
+#ifdef CONFIG_MICRO_ROS_ESP_XRCE_DDS_MIDDLEWARE
+	rmw_init_options_t* rmwOptions = rcl_init_options_get_rmw_init_options(&initOptions);
+	RCSOFTCHECK(rmw_uros_options_set_udp_address(CONFIG_MICRO_ROS_AGENT_IP, CONFIG_MICRO_ROS_AGENT_PORT, rmwOptions));
+#endif
+
+	// Support keeps its own copy of the options
+	const rcl_ret_t supportRet = rclc_support_init_with_options(&support, 0, nullptr, &initOptions, &allocator);
+	rcl_init_options_fini(&initOptions);
+	if(supportRet != RCL_RET_OK){
+		ESP_LOGW(TAG, "Agent answered, but the session couldn't be created");
+		rcl_reset_error();
+		releaseArena();
+		return false;
+	}
+
+	node = rcl_get_zero_initialized_node();
+	if(rclc_node_init_default(&node, "perse_rover", "", &support) != RCL_RET_OK){
+		ESP_LOGE(TAG, "Can't create node");
+		rclc_support_fini(&support);
+		releaseArena();
+		return false;
+	}
+
+	connected = true;
+	connects++;
+	missedPings = 0;
+	lastPing = esp_timer_get_time();
+
+	for(auto& entry : entries){
+		entry.created = false;
+	}
+	entriesChanged = true;
+
+#ifdef CONFIG_MICRO_ROS_ESP_XRCE_DDS_MIDDLEWARE
+	// Publishers stamp their messages with the agent's clock
+	if(rmw_uros_sync_session(100) != RMW_RET_OK){
+		ESP_LOGW(TAG, "Can't sync time with the agent, stamps will count from boot");
+	}
+#endif
+
+	ESP_LOGI(TAG, "Connected to agent, node perse_rover created");
+
+	return true;
+}
+
+void MicroROS::disconnect(bool agentLost){
+	if(!connected) return;
+
+#ifdef CONFIG_MICRO_ROS_ESP_XRCE_DDS_MIDDLEWARE
+	// Without an agent every entity deletion would wait for a reply that never comes
+	if(agentLost){
+		rmw_uros_set_context_entity_destroy_session_timeout(rcl_context_get_rmw_context(&support.context), 0);
+	}
+#endif
+
+	if(executorReady){
+		RCSOFTCHECK(rclc_executor_fini(&executor));
+		executorReady = false;
+	}
+
+	for(auto it = entries.rbegin(); it != entries.rend(); ++it){
+		if(!it->created) continue;
+
+		it->endpoint->destroy(&node);
+		it->created = false;
+	}
+
+	RCSOFTCHECK(rcl_node_fini(&node));
+	RCSOFTCHECK(rclc_support_fini(&support));
+	rcl_reset_error();
+	connected = false;
+	removed.notify_all();
+
+	releaseArena();
+
+	ESP_LOGI(TAG, "Disconnected from agent");
+}
+
+void MicroROS::releaseArena(){
+	// Everything micro-ROS allocated went away with the support, so the whole arena is free again
+	arena.seal();
+	arena.reset();
+
+	if(!rcutils_set_default_allocator(&heapAllocator)){
+		ESP_LOGW(TAG, "Can't restore the default allocator");
+	}
+}
+
+bool MicroROS::checkAgent(){
+#ifdef CONFIG_MICRO_ROS_ESP_XRCE_DDS_MIDDLEWARE
+	const int64_t now = esp_timer_get_time();
+	if(now - lastPing < PingInterval) return true;
+	lastPing = now;
+
+	if(rmw_uros_ping_agent(50, 1) == RMW_RET_OK){
+		missedPings = 0;
+		return true;
+	}
+
+	return ++missedPings < PingFailures;
+#else
+	return true;
 #endif
+}
+
+bool MicroROS::rebuildExecutor(){
+	entriesChanged = false;
+
+	// Removed endpoints go first, the executor still points at their subscriptions
+	if(executorReady){
+		RCSOFTCHECK(rclc_executor_fini(&executor));
+		executorReady = false;
+	}
+
+	bool destroyed = false;
+	for(auto it = entries.begin(); it != entries.end();){
+		if(!it->removing){
+			++it;
+			continue;
+		}
+
+		if(it->created){
+			it->endpoint->destroy(&node);
+		}
+		it = entries.erase(it);
+		destroyed = true;
+	}
+	if(destroyed){
+		removed.notify_all();
+	}
+
+	entries.splice(entries.end(), added);
+
+	size_t handles = 0;
+	for(auto& entry : entries){
+		if(!entry.created){
+			entry.created = entry.endpoint->create(&node);
+			if(!entry.created){
+				ESP_LOGW(TAG, "Can't create endpoint");
+				rcl_reset_error();
+				continue;
+			}
+		}
+
+		handles += entry.subscriber != nullptr;
+	}
+
+	if(handles == 0) return true;
+
+	executor = rclc_executor_get_zero_initialized_executor();
+	RCCHECK(rclc_executor_init(&executor, &support.context, handles, &allocator));
+	RCCHECK(rclc_executor_set_trigger(&executor, trigger, this));
+
+	for(auto& entry : entries){
+		if(!entry.created || entry.subscriber == nullptr) continue;
+
+		RCCHECK(rclc_executor_add_subscription_with_context(&executor, entry.subscriber->getSubscription(), entry.subscriber->getMessage(),
+															subscriptionCallback, &entry, ON_NEW_DATA));
+	}
+
+	executorReady = true;
+
+	return true;
+}
+
+int64_t MicroROS::updatePublishers(){
+	const int64_t now = esp_timer_get_time();
+
+	int64_t wait = MaxSpinTimeout;
+	for(auto& entry : entries){
+		if(!entry.created || entry.publisher == nullptr) continue;
+
+		wait = std::min(wait, entry.publisher->update(now));
+	}
+
+	return wait;
+}
+
+MicroROS::Stats MicroROS::getStats() const{
+	const uint32_t count = callbackCount;
+
+	return {
+			.arenaUsed = arena.getUsed(),
+			.arenaPeak = arena.getPeak(),
+			.arenaCapacity = arena.getCapacity(),
+			.arenaFallbacks = arena.getFallbacks(),
+			.heapFree = (uint32_t) heap_caps_get_free_size(MALLOC_CAP_DEFAULT),
+			.heapMinFree = (uint32_t) heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT),
+			.callbackCount = count,
+			.callbackLatencyAvg = count == 0 ? 0 : (uint32_t) (callbackLatencyTotal / count),
+			.callbackLatencyMax = callbackLatencyMax,
+			.callbackDurationMax = callbackDurationMax,
+			.connects = connects
+	};
+}
+
+void MicroROS::logStats(){
+	const Stats stats = getStats();
+	ESP_LOGI(TAG, "heap %lu B free (min %lu), arena %zu/%zu B (peak %zu, %lu fallbacks), %lu connects, "
+				  "%lu callbacks: latency avg %lu us max %lu us, duration max %lu us",
+			 stats.heapFree, stats.heapMinFree, stats.arenaUsed, stats.arenaCapacity, stats.arenaPeak, stats.arenaFallbacks, stats.connects,
+			 stats.callbackCount, stats.callbackLatencyAvg, stats.callbackLatencyMax, stats.callbackDurationMax);
+}
+
+bool MicroROS::trigger(rclc_executor_handle_t* handles, unsigned int size, void* obj){
+	// Runs right after the executor wakes up from waiting on the transport, before any callback
+	((MicroROS*) obj)->wakeTime = esp_timer_get_time();
+	return rclc_executor_trigger_any(handles, size, nullptr);
+}
+
+void MicroROS::subscriptionCallback(const void* msg, void* context){
+	auto entry = (Entry*) context;
+	MicroROS& service = *entry->service;
+
+	const int64_t start = esp_timer_get_time();
+	entry->subscriber->onMessage(msg);
+	const int64_t end = esp_timer_get_time();
 
-    // Create micro-ROS task
-    xTaskCreate(
-        microRosTask,
-        "microros_task",
-        CONFIG_MICRO_ROS_APP_STACK,
-        NULL,
-        CONFIG_MICRO_ROS_APP_TASK_PRIO,
-        &taskHandle);
-    
-    ESP_LOGI(TAG, "micro-ROS task created");
-}
-
-void MicroROS::stop() {
-    if (taskHandle != nullptr) {
-        // Note: This terminates the task but doesn't cleanly shutdown micro-ROS resources
-        // (publishers, subscribers, node, etc.). This is acceptable for the shutdown scenario
-        // where the entire system is powering down. For a clean restart scenario, proper
-        // micro-ROS cleanup would need to be implemented with task coordination.
-        vTaskDelete(taskHandle);
-        taskHandle = nullptr;
-    }
+	// Only this task writes the stats, a plain load and store is enough for the maximums
+	const uint32_t latency = start - service.wakeTime;
+	service.callbackCount++;
+	service.callbackLatencyTotal += latency;
+	service.callbackLatencyMax = std::max(service.callbackLatencyMax.load(), latency);
+	service.callbackDurationMax = std::max(service.callbackDurationMax.load(), (uint32_t) (end - start));
 }
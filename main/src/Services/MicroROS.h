@@ -1,20 +1,184 @@
 #ifndef PERSE_ROVER_MICROROS_H
 #define PERSE_ROVER_MICROROS_H
 
-#include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
+#include <list>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <rcl/rcl.h>
+#include <rclc/rclc.h>
+#include <rclc/executor.h>
+#include <builtin_interfaces/msg/time.h>
+#include "Util/Threaded.h"
+#include "Util/ArenaAllocator.h"
+#include "Util/Events.h"
 
-class MicroROS {
+/**
+ * The rover's single micro-ROS node. Owns the one XRCE session, node and executor, and a registry of endpoints
+ * (publishers and subscribers) that are created on the node whenever a session comes up and destroyed before it goes down.
+ * All rcl calls happen on the service's own task.
+ *
+ * The connection is a state machine driven by WiFi events: with no network it sleeps until WiFiSTA reports an IP,
+ * then pings the agent with exponential backoff until it answers, creates the session, and keeps pinging while connected.
+ * A lost agent tears the session down and goes back to waiting for it, a lost network goes back to sleep.
+ */
+class MicroROS : private Threaded {
 public:
-    MicroROS();
-    ~MicroROS();
+	MicroROS();
+	~MicroROS() override;
 
-    void begin();
-    void stop();
+	void begin();
+
+	/**
+	 * Anything living on the node. create() and destroy() are only ever called from the micro-ROS task.
+	 */
+	class Endpoint {
+	public:
+		virtual ~Endpoint() = default;
+
+		virtual bool create(rcl_node_t* node) = 0;
+		virtual void destroy(rcl_node_t* node) = 0;
+	};
+
+	/**
+	 * Publishes on its own schedule, polled on every executor spin.
+	 */
+	class Publisher : public Endpoint {
+	public:
+		/**
+		 * @param now esp_timer time [us]
+		 * @return Time until the next update is due [us]
+		 */
+		virtual int64_t update(int64_t now) = 0;
+	};
+
+	/**
+	 * Receives messages through the shared executor.
+	 */
+	class Subscriber : public Endpoint {
+	public:
+		virtual rcl_subscription_t* getSubscription() = 0;
+		virtual void* getMessage() = 0;
+		virtual void onMessage(const void* msg) = 0;
+	};
+
+	/**
+	 * Registers an endpoint, never blocks on the session. It is created on the node after the current spin
+	 * if a session is up, otherwise on the next connect. The endpoint must stay alive until it is removed.
+	 */
+	void add(Publisher* publisher);
+	void add(Subscriber* subscriber);
+
+	/**
+	 * Unregisters an endpoint. If it's live on the node, the micro-ROS task destroys it after the current spin,
+	 * which this waits for. The endpoint can be deleted afterwards. Not to be called from the micro-ROS task.
+	 */
+	void remove(Endpoint* endpoint);
+
+	/**
+	 * Converts an esp_timer time [us] to a message stamp, on the agent's clock if the session got synced.
+	 */
+	static builtin_interfaces__msg__Time toStamp(int64_t time);
+
+	enum class State : uint8_t {
+		NoNetwork, WaitingAgent, Connected
+	};
+	State getState() const;
+	bool isConnected() const;
+
+	struct Stats {
+		size_t arenaUsed;
+		size_t arenaPeak;
+		size_t arenaCapacity;
+		uint32_t arenaFallbacks; // allocations that didn't fit in the arena and went to the heap
+		uint32_t heapFree;
+		uint32_t heapMinFree;
+		uint32_t callbackCount;
+		uint32_t callbackLatencyAvg; // [us] from the executor waking up on new data to the callback running
+		uint32_t callbackLatencyMax; // [us]
+		uint32_t callbackDurationMax; // [us] time spent in the callback
+		uint32_t connects;
+	};
+	Stats getStats() const;
 
 private:
-    TaskHandle_t taskHandle = nullptr;
-    static void microRosTask(void* arg);
+	void loop() override;
+	void onStop() override;
+	void afterStopSignal() override;
+
+	// The session, the node and the endpoints registered before it came up are allocated from here, by the micro-ROS task.
+	// The arena is sealed after the first executor build, endpoints that come and go with hot-plugging live on the heap.
+	static constexpr size_t ArenaSize = 24 * 1024;
+	ArenaAllocator arena;
+	rcl_allocator_t allocator;
+	rcl_allocator_t heapAllocator; // rcutils' default, restored when the session goes down
+
+	std::atomic<State> state = State::NoNetwork;
+	bool connected = false;
+	bool networkUp = false;
+	EventQueue queue;
+	rclc_support_t support;
+	rcl_node_t node;
+	rclc_executor_t executor;
+	bool executorReady = false;
+
+	struct Entry {
+		Endpoint* endpoint;
+		Publisher* publisher;
+		Subscriber* subscriber;
+		MicroROS* service;
+		bool created;
+		bool removing; // remove() waits for the micro-ROS task to destroy it
+	};
+	std::list<Entry> entries; // walked by the micro-ROS task without the lock, only changed by it while a session is up
+	std::list<Entry> added; // moved into entries by the micro-ROS task
+	bool entriesChanged = false;
+
+	// Held while endpoints, the executor or the session are created or destroyed, and by add() and remove().
+	// Spinning, publishing and pinging the agent happen outside of it.
+	std::mutex mut;
+	std::condition_variable removed; // an endpoint was destroyed by the micro-ROS task, or the session went down
+
+	bool contains(const Endpoint* endpoint) const;
+	void waitNetwork();
+	void waitAgent();
+	void spin();
+
+	/**
+	 * Handles WiFi events, waiting up to timeout for the first one.
+	 */
+	void processEvents(TickType_t timeout);
+
+	bool pingAgent();
+	bool connect();
+	void disconnect(bool agentLost = false);
+	void releaseArena();
+	bool checkAgent();
+	bool rebuildExecutor();
+	int64_t updatePublishers();
+
+	static constexpr int64_t MaxSpinTimeout = 100 * 1000; // [us]
+	static constexpr uint32_t MinBackoff = 500; // [ms] between pings while waiting for the agent
+	static constexpr uint32_t MaxBackoff = 8000; // [ms]
+	uint32_t backoff = MinBackoff;
+	static constexpr int64_t PingInterval = 1000 * 1000; // [us]
+	static constexpr uint8_t PingFailures = 3; // missed pings in a row before the session is dropped
+	int64_t lastPing = 0;
+	uint8_t missedPings = 0;
+
+	// Executor instrumentation, written by the micro-ROS task only and read by getStats() from any task
+	int64_t wakeTime = 0;
+	std::atomic<uint32_t> callbackCount = 0;
+	std::atomic<uint64_t> callbackLatencyTotal = 0;
+	std::atomic<uint32_t> callbackLatencyMax = 0;
+	std::atomic<uint32_t> callbackDurationMax = 0;
+	std::atomic<uint32_t> connects = 0;
+	int64_t lastStats = 0;
+	static constexpr int64_t StatsInterval = 10 * 1000 * 1000; // [us]
+	void logStats();
+
+	static bool trigger(rclc_executor_handle_t* handles, unsigned int size, void* obj);
+	static void subscriptionCallback(const void* msg, void* context);
 };
 
 #endif //PERSE_ROVER_MICROROS_H
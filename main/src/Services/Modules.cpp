@@ -1,5 +1,6 @@
 #include "Modules.h"
 #include "Util/Events.h"
+#include "Services/Comm.h"
 #include <driver/gpio.h>
 #include "Modules/AltPressModule.h"
 #include "Modules/GyroModule.h"
@@ -65,7 +66,7 @@ Modules::Modules(I2C& i2c, ADC& adc) : SleepyThreaded(CheckInterval, "Modules",
 	Modules::sleepyLoop();
 	start();
 
-	Events::listen(Facility::Comm, &connectionQueue);
+	Events::listen<Comm::Event, CommType::ModulesEnable>(&connectionQueue);
 	Events::listen(Facility::TCP, &connectionQueue);
 	connectionThread.start();
 }
@@ -229,5 +230,5 @@ void Modules::connectionLoop(){
 		}
 	}
 
-	free(e.data);
+	Events::release(e.data);
 }
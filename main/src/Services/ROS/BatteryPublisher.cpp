@@ -0,0 +1,53 @@
+#include "BatteryPublisher.h"
+#include <esp_log.h>
+#include <cmath>
+#include <cstring>
+#include "Util/Services.h"
+#include "Devices/Battery.h"
+
+static const char* TAG = "BatteryPublisher";
+
+static constexpr float FieldUnknown = NAN;
+static const char FrameID[] = "battery";
+
+BatteryPublisher::BatteryPublisher(){
+	msg.header.frame_id.data = const_cast<char*>(FrameID);
+	msg.header.frame_id.size = strlen(FrameID);
+	msg.header.frame_id.capacity = msg.header.frame_id.size + 1;
+
+	msg.voltage = FieldUnknown;
+	msg.current = FieldUnknown;
+	msg.capacity = FieldUnknown;
+	msg.design_capacity = FieldUnknown;
+	msg.charge = FieldUnknown;
+	msg.power_supply_status = sensor_msgs__msg__BatteryState__POWER_SUPPLY_STATUS_DISCHARGING;
+	msg.power_supply_health = sensor_msgs__msg__BatteryState__POWER_SUPPLY_HEALTH_UNKNOWN;
+	msg.power_supply_technology = sensor_msgs__msg__BatteryState__POWER_SUPPLY_TECHNOLOGY_UNKNOWN;
+	msg.present = true;
+}
+
+bool BatteryPublisher::create(rcl_node_t* node){
+	publisher = rcl_get_zero_initialized_publisher();
+	return rclc_publisher_init_default(&publisher, node, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, BatteryState), "battery_status") == RCL_RET_OK;
+}
+
+void BatteryPublisher::destroy(rcl_node_t* node){
+	rcl_publisher_fini(&publisher, node);
+}
+
+int64_t BatteryPublisher::update(int64_t now){
+	if(now - lastPublish < Interval){
+		return Interval - (now - lastPublish);
+	}
+	lastPublish = now;
+
+	if(const Battery* battery = (Battery*) Services.get(Service::Battery)){
+		msg.percentage = (float) battery->getPerc() / 100.0f;
+
+		if(rcl_publish(&publisher, &msg, nullptr) != RCL_RET_OK){
+			ESP_LOGW(TAG, "Can't publish battery state");
+		}
+	}
+
+	return Interval;
+}
@@ -0,0 +1,27 @@
+#ifndef PERSE_ROVER_BATTERYPUBLISHER_H
+#define PERSE_ROVER_BATTERYPUBLISHER_H
+
+#include "Services/MicroROS.h"
+#include <sensor_msgs/msg/battery_state.h>
+
+/**
+ * Publishes the battery level on battery_status once per second.
+ */
+class BatteryPublisher : public MicroROS::Publisher {
+public:
+	BatteryPublisher();
+
+	bool create(rcl_node_t* node) override;
+	void destroy(rcl_node_t* node) override;
+	int64_t update(int64_t now) override;
+
+private:
+	static constexpr int64_t Interval = 1000 * 1000; // [us]
+	int64_t lastPublish = 0;
+
+	rcl_publisher_t publisher;
+	sensor_msgs__msg__BatteryState msg{};
+};
+
+
+#endif //PERSE_ROVER_BATTERYPUBLISHER_H
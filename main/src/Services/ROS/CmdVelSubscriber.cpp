@@ -0,0 +1,42 @@
+#include "CmdVelSubscriber.h"
+#include <esp_log.h>
+#include "Util/Services.h"
+#include "Devices/MotorDriveController.h"
+
+static const char* TAG = "CmdVelSubscriber";
+
+bool CmdVelSubscriber::create(rcl_node_t* node){
+	subscription = rcl_get_zero_initialized_subscription();
+	return rclc_subscription_init_default(&subscription, node, ROSIDL_GET_MSG_TYPE_SUPPORT(geometry_msgs, msg, Twist), "cmd_vel") == RCL_RET_OK;
+}
+
+void CmdVelSubscriber::destroy(rcl_node_t* node){
+	rcl_subscription_fini(&subscription, node);
+
+	if(!moving) return;
+	moving = false;
+
+	if(MotorDriveController* motors = (MotorDriveController*) Services.get(Service::MotorDriveController)){
+		motors->drive(0, 0);
+	}
+}
+
+rcl_subscription_t* CmdVelSubscriber::getSubscription(){
+	return &subscription;
+}
+
+void* CmdVelSubscriber::getMessage(){
+	return &msg;
+}
+
+void CmdVelSubscriber::onMessage(const void* msgin){
+	const auto twist = (const geometry_msgs__msg__Twist*) msgin;
+
+	ESP_LOGD(TAG, "Received cmd_vel - linear.x: %.2f, angular.z: %.2f", twist->linear.x, twist->angular.z);
+
+	if(MotorDriveController* motors = (MotorDriveController*) Services.get(Service::MotorDriveController)){
+		// linear.x is forward/backward velocity, angular.z is rotational velocity (positive turns left), both [-1.0, 1.0]
+		motors->drive(twist->linear.x, twist->angular.z);
+		moving = twist->linear.x != 0 || twist->angular.z != 0;
+	}
+}
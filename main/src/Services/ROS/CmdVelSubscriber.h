@@ -0,0 +1,28 @@
+#ifndef PERSE_ROVER_CMDVELSUBSCRIBER_H
+#define PERSE_ROVER_CMDVELSUBSCRIBER_H
+
+#include "Services/MicroROS.h"
+#include <geometry_msgs/msg/twist.h>
+
+/**
+ * Drives the rover from cmd_vel. The motors are stopped when the subscription goes away, and by MotorDriveController
+ * when no command arrives for MotorDriveController::DriveTimeout, so neither a lost agent nor a publisher that stopped
+ * leaves the rover driving on its last command.
+ */
+class CmdVelSubscriber : public MicroROS::Subscriber {
+public:
+	bool create(rcl_node_t* node) override;
+	void destroy(rcl_node_t* node) override;
+
+	rcl_subscription_t* getSubscription() override;
+	void* getMessage() override;
+	void onMessage(const void* msg) override;
+
+private:
+	rcl_subscription_t subscription;
+	geometry_msgs__msg__Twist msg{};
+	bool moving = false;
+};
+
+
+#endif //PERSE_ROVER_CMDVELSUBSCRIBER_H
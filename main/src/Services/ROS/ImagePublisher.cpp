@@ -0,0 +1,142 @@
+#include "ImagePublisher.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cstring>
+#include <algorithm>
+
+#ifdef CONFIG_MICRO_ROS_ESP_XRCE_DDS_MIDDLEWARE
+#include <rmw_microros/rmw_microros.h>
+#endif
+
+static const char* TAG = "ImagePublisher";
+
+static const char FrameID[] = "camera";
+static const char Format[] = "jpeg";
+
+ImagePublisher::ImagePublisher(uint32_t interval, uint8_t quality) : interval(interval), quality(std::clamp<uint8_t>(quality, 1, 30)){
+	msg.header.frame_id.data = const_cast<char*>(FrameID);
+	msg.header.frame_id.size = strlen(FrameID);
+	msg.header.frame_id.capacity = msg.header.frame_id.size + 1;
+
+	msg.format.data = const_cast<char*>(Format);
+	msg.format.size = strlen(Format);
+	msg.format.capacity = msg.format.size + 1;
+}
+
+ImagePublisher::~ImagePublisher() = default;
+
+bool ImagePublisher::create(rcl_node_t* node){
+	publisher = rcl_get_zero_initialized_publisher();
+
+	// Default QoS is reliable: a frame doesn't fit into a single packet, and only reliable streams can fragment
+	if(rclc_publisher_init_default(&publisher, node, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, CompressedImage), "camera/image/compressed") != RCL_RET_OK){
+		return false;
+	}
+
+#ifdef CONFIG_MICRO_ROS_ESP_XRCE_DDS_MIDDLEWARE
+	// Don't hold the session for the full default timeout when the agent is slow to acknowledge, the next frame is coming anyway
+	rmw_uros_set_publisher_session_timeout(&publisher, PublishTimeout);
+#endif
+
+	active = true;
+	return true;
+}
+
+void ImagePublisher::destroy(rcl_node_t* node){
+	active = false;
+	rcl_publisher_fini(&publisher, node);
+
+	// A frame left over from this session isn't published on the next one
+	std::lock_guard lock(mut);
+	pending.valid = false;
+	waiting = false;
+}
+
+int64_t ImagePublisher::update(int64_t now){
+	{
+		std::lock_guard lock(mut);
+
+		if(pending.valid){
+			std::swap(pending, publishing);
+			pending.valid = false;
+			waiting = false;
+			lastPublish = now;
+		}
+	}
+
+	if(publishing.valid){
+		publishing.valid = false;
+
+		const size_t size = publishing.jpeg.size();
+
+		msg.header.stamp = MicroROS::toStamp(publishing.captured);
+		msg.data.data = publishing.jpeg.data();
+		msg.data.size = size;
+		msg.data.capacity = size;
+
+		if(rcl_publish(&publisher, &msg, nullptr) == RCL_RET_OK){
+			publishedCount++;
+		}else{
+			failedCount++;
+			ESP_LOGW(TAG, "Can't publish %zu B frame", size);
+		}
+
+		msg.data.data = nullptr;
+		msg.data.size = 0;
+		msg.data.capacity = 0;
+	}
+
+	const int64_t wait = (int64_t) interval * 1000 - (now - lastPublish);
+	return wait > 0 ? wait : DuePoll;
+}
+
+void ImagePublisher::setInterval(uint32_t interval){
+	this->interval = interval;
+}
+
+uint32_t ImagePublisher::getInterval() const{
+	return interval;
+}
+
+void ImagePublisher::setQuality(uint8_t quality){
+	this->quality = std::clamp<uint8_t>(quality, 1, 30);
+}
+
+uint8_t ImagePublisher::getQuality() const{
+	return quality;
+}
+
+bool ImagePublisher::isActive() const{
+	return active;
+}
+
+bool ImagePublisher::isDue() const{
+	return active && !waiting && esp_timer_get_time() - lastPublish >= (int64_t) interval * 1000;
+}
+
+bool ImagePublisher::publish(const uint8_t* jpeg, size_t size, int64_t captured){
+	if(!active || jpeg == nullptr || size == 0) return false;
+
+	std::lock_guard lock(mut);
+
+	// A frame still waiting is superseded, the topic only wants the latest one
+	if(pending.valid){
+		missedCount++;
+	}
+
+	// Buffers are swapped with publishing, so after the first few frames this doesn't allocate
+	pending.jpeg.assign(jpeg, jpeg + size);
+	pending.captured = captured;
+	pending.valid = true;
+	waiting = true;
+
+	return true;
+}
+
+ImagePublisher::Stats ImagePublisher::getStats() const{
+	return {
+			.published = publishedCount,
+			.failed = failedCount,
+			.missed = missedCount
+	};
+}
@@ -0,0 +1,92 @@
+#ifndef PERSE_ROVER_IMAGEPUBLISHER_H
+#define PERSE_ROVER_IMAGEPUBLISHER_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <sensor_msgs/msg/compressed_image.h>
+#include "Services/MicroROS.h"
+
+/**
+ * Publishes camera frames on camera/image/compressed, at its own rate and JPEG quality.
+ * Frames come from Feed, which keeps the camera running while the topic exists. publish() never waits on the micro-ROS task:
+ * the JPEG is copied and parked until the next update() publishes it, and a newer frame replaces one that wasn't picked up yet.
+ * No camera buffer is held on the micro-ROS task's behalf, so the capture pipeline keeps both of them.
+ * Frames are larger than one XRCE packet, so the topic is reliable and frames go out fragmented.
+ */
+class ImagePublisher : public MicroROS::Publisher {
+public:
+	/**
+	 * @param interval Minimum time between frames [ms]
+	 * @param quality Feed quality used for frames picked for the topic [1 - 30]
+	 */
+	explicit ImagePublisher(uint32_t interval = DefaultInterval, uint8_t quality = DefaultQuality);
+	~ImagePublisher() override;
+
+	bool create(rcl_node_t* node) override;
+	void destroy(rcl_node_t* node) override;
+	int64_t update(int64_t now) override;
+
+	void setInterval(uint32_t interval);
+	uint32_t getInterval() const;
+
+	void setQuality(uint8_t quality);
+	uint8_t getQuality() const;
+
+	/**
+	 * @return true while the topic exists on a live session
+	 */
+	bool isActive() const;
+
+	/**
+	 * @return true if the topic is active, no frame is waiting to be published and the interval since the last one has passed
+	 */
+	bool isDue() const;
+
+	/**
+	 * Hands a JPEG over to the micro-ROS task. It is copied, so the caller's buffer can be reused right away.
+	 * @param captured esp_timer time the frame was captured [us]
+	 * @return false if the topic isn't active
+	 */
+	bool publish(const uint8_t* jpeg, size_t size, int64_t captured);
+
+	struct Stats {
+		uint32_t published;
+		uint32_t failed; // rejected by the middleware, mostly frames larger than the XRCE output stream
+		uint32_t missed; // replaced by a newer frame before the micro-ROS task picked it up
+	};
+	Stats getStats() const;
+
+private:
+	static constexpr uint32_t DefaultInterval = 200; // [ms]
+	static constexpr uint8_t DefaultQuality = 20;
+
+	std::atomic<uint32_t> interval;
+	std::atomic<uint8_t> quality;
+	std::atomic<bool> active = false;
+	std::atomic<int64_t> lastPublish = 0; // [us]
+
+	rcl_publisher_t publisher;
+	sensor_msgs__msg__CompressedImage msg{};
+
+	// Copy of the frame handed over by publish(), held until update() has published it
+	struct Pending {
+		std::vector<uint8_t> jpeg;
+		int64_t captured = 0;
+		bool valid = false;
+	};
+	Pending pending;
+	Pending publishing; // swapped with pending by update(), so the copy buffers are reused and rcl_publish runs without the lock
+	std::mutex mut;
+	std::atomic<bool> waiting = false;
+
+	static constexpr int64_t DuePoll = 10 * 1000; // [us] how often the topic checks for a frame once it is due
+	static constexpr int PublishTimeout = 50; // [ms] wait for the agent to acknowledge a frame
+
+	std::atomic<uint32_t> publishedCount = 0;
+	std::atomic<uint32_t> failedCount = 0;
+	std::atomic<uint32_t> missedCount = 0;
+};
+
+
+#endif //PERSE_ROVER_IMAGEPUBLISHER_H
@@ -0,0 +1,108 @@
+#include "MarkerPublisher.h"
+#include <esp_log.h>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+static const char* TAG = "MarkerPublisher";
+
+static const char FrameID[] = "camera";
+static const char FieldID[] = "id";
+static const char FieldCorners[] = "corners";
+static const char FieldScore[] = "score";
+
+static void setString(rosidl_runtime_c__String& string, const char* value){
+	string.data = const_cast<char*>(value);
+	string.size = strlen(value);
+	string.capacity = string.size + 1;
+}
+
+MarkerPublisher::MarkerPublisher(){
+	setString(msg.header.frame_id, FrameID);
+
+	setString(fields[0].name, FieldID);
+	fields[0].offset = offsetof(MarkerPoint, id);
+	fields[0].datatype = sensor_msgs__msg__PointField__UINT16;
+	fields[0].count = 1;
+
+	setString(fields[1].name, FieldCorners);
+	fields[1].offset = offsetof(MarkerPoint, corners);
+	fields[1].datatype = sensor_msgs__msg__PointField__INT16;
+	fields[1].count = 8;
+
+	setString(fields[2].name, FieldScore);
+	fields[2].offset = offsetof(MarkerPoint, score);
+	fields[2].datatype = sensor_msgs__msg__PointField__FLOAT32;
+	fields[2].count = 1;
+
+	msg.fields.data = fields.data();
+	msg.fields.size = fields.size();
+	msg.fields.capacity = fields.size();
+
+	msg.height = 1;
+	msg.point_step = sizeof(MarkerPoint);
+	msg.is_bigendian = false;
+	msg.is_dense = true;
+
+	msg.data.data = (uint8_t*) points.data();
+	msg.data.capacity = sizeof(points);
+}
+
+bool MarkerPublisher::create(rcl_node_t* node){
+	publisher = rcl_get_zero_initialized_publisher();
+
+	// Detections are only useful while they're fresh, a lost frame isn't worth a retransmission
+	if(rclc_publisher_init_best_effort(&publisher, node, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, PointCloud2), "camera/markers") != RCL_RET_OK){
+		return false;
+	}
+
+	active = true;
+	return true;
+}
+
+void MarkerPublisher::destroy(rcl_node_t* node){
+	active = false;
+	rcl_publisher_fini(&publisher, node);
+}
+
+int64_t MarkerPublisher::update(int64_t now){
+	for(Detections detections; queue.get(detections, 0);){
+		lastActivity = now;
+
+		std::copy_n(detections.markers.begin(), detections.count, points.begin());
+		msg.header.stamp = MicroROS::toStamp(detections.captured);
+		msg.width = detections.count;
+		msg.row_step = detections.count * sizeof(MarkerPoint);
+		msg.data.size = msg.row_step;
+
+		if(rcl_publish(&publisher, &msg, nullptr) == RCL_RET_OK){
+			publishedCount++;
+		}else{
+			ESP_LOGW(TAG, "Can't publish %d markers", detections.count);
+		}
+	}
+
+	return now - lastActivity < IdleAfter ? ActivePoll : IdlePoll;
+}
+
+void MarkerPublisher::post(Detections&& detections){
+	if(!active) return;
+
+	// Consecutive empty frames carry no news
+	const uint8_t count = detections.count;
+	if(count == 0 && lastCount == 0) return;
+
+	if(!queue.post(std::move(detections), 0)){
+		droppedCount++;
+		return;
+	}
+
+	lastCount = count;
+}
+
+MarkerPublisher::Stats MarkerPublisher::getStats() const{
+	return {
+			.published = publishedCount,
+			.dropped = droppedCount
+	};
+}
@@ -0,0 +1,73 @@
+#ifndef PERSE_ROVER_MARKERPUBLISHER_H
+#define PERSE_ROVER_MARKERPUBLISHER_H
+
+#include <array>
+#include <atomic>
+#include <sensor_msgs/msg/point_cloud2.h>
+#include <sensor_msgs/msg/point_field.h>
+#include "Services/MicroROS.h"
+#include "Util/SPSCQueue.h"
+
+/**
+ * Publishes the markers found in each scanned frame on camera/markers.
+ * The message is a sensor_msgs/PointCloud2 with one point per marker, laid out as MarkerPoint:
+ * id (UINT16), corners (8 x INT16, x/y of the four projected corners in frame pixels, in marker order) and score (FLOAT32).
+ * The header stamp is the capture time of the frame. A frame without markers is only published right after one with markers.
+ */
+class MarkerPublisher : public MicroROS::Publisher {
+public:
+	static constexpr size_t MaxMarkers = 8;
+
+	struct MarkerPoint {
+		uint16_t id;
+		int16_t corners[8];
+		float score; // contour score from MarkerScanner, markers are sorted by it
+	};
+
+	struct Detections {
+		int64_t captured = 0; // [us] esp_timer time of the frame
+		uint8_t count = 0;
+		std::array<MarkerPoint, MaxMarkers> markers{};
+	};
+
+	MarkerPublisher();
+
+	bool create(rcl_node_t* node) override;
+	void destroy(rcl_node_t* node) override;
+	int64_t update(int64_t now) override;
+
+	/**
+	 * Queues a frame's detections for publishing. Never blocks, the frame is dropped if the queue is full.
+	 * Only one task may post.
+	 */
+	void post(Detections&& detections);
+
+	struct Stats {
+		uint32_t published;
+		uint32_t dropped; // queue full, the micro-ROS task fell behind
+	};
+	Stats getStats() const;
+
+private:
+	std::atomic<bool> active = false;
+
+	static constexpr size_t QueueSize = 4;
+	SPSCQueue<Detections, QueueSize> queue;
+	uint8_t lastCount = 0; // producer side, markers in the last posted frame
+
+	rcl_publisher_t publisher;
+	sensor_msgs__msg__PointCloud2 msg{};
+	std::array<sensor_msgs__msg__PointField, 3> fields{};
+	std::array<MarkerPoint, MaxMarkers> points{};
+
+	int64_t lastActivity = 0; // [us]
+	static constexpr int64_t ActivePoll = 20 * 1000; // [us] while frames are coming in
+	static constexpr int64_t IdlePoll = 100 * 1000; // [us]
+	static constexpr int64_t IdleAfter = 1000 * 1000; // [us] without frames
+
+	std::atomic<uint32_t> publishedCount = 0;
+	std::atomic<uint32_t> droppedCount = 0;
+};
+
+
+#endif //PERSE_ROVER_MARKERPUBLISHER_H
@@ -0,0 +1,116 @@
+#include "ModulePublisher.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cstring>
+
+static const char* TAG = "ModulePublisher";
+
+static const char FrameLeft[] = "module_left";
+static const char FrameRight[] = "module_right";
+
+ModulePublisher::ModulePublisher(std::string topic, const rosidl_message_type_support_t* type, const Config& config) :
+		topic(std::move(topic)), type(type), qos(config.qos), latest((int64_t) config.interval * 1000, IdlePoll){}
+
+bool ModulePublisher::create(rcl_node_t* node){
+	publisher = rcl_get_zero_initialized_publisher();
+	latest.restart();
+
+	if(qos == QoS::BestEffort){
+		return rclc_publisher_init_best_effort(&publisher, node, type, topic.c_str()) == RCL_RET_OK;
+	}else{
+		return rclc_publisher_init_default(&publisher, node, type, topic.c_str()) == RCL_RET_OK;
+	}
+}
+
+void ModulePublisher::destroy(rcl_node_t* node){
+	rcl_publisher_fini(&publisher, node);
+}
+
+int64_t ModulePublisher::update(int64_t now){
+	return latest.update(now, [this](const ModuleReading& reading, int64_t sampled){
+		// Stamped with the time the reading was taken
+		if(rcl_publish(&publisher, fill(reading, MicroROS::toStamp(sampled)), nullptr) != RCL_RET_OK){
+			ESP_LOGW(TAG, "Can't publish %s", topic.c_str());
+		}
+	});
+}
+
+void ModulePublisher::report(const ModuleReading& reading){
+	latest.report(reading, esp_timer_get_time());
+}
+
+void ModulePublisher::setFrame(rosidl_runtime_c__String& frame, ModuleBus bus){
+	const char* name = bus == ModuleBus::Left ? FrameLeft : FrameRight;
+	frame.data = const_cast<char*>(name);
+	frame.size = strlen(name);
+	frame.capacity = frame.size + 1;
+}
+
+ImuPublisher::ImuPublisher(const std::string& topic, ModuleBus bus, const Config& config) :
+		ModulePublisher(topic, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, Imu), config){
+	setFrame(msg.header.frame_id, bus);
+
+	// The module only has an accelerometer, -1 marks orientation and angular velocity as not provided
+	msg.orientation_covariance[0] = -1;
+	msg.angular_velocity_covariance[0] = -1;
+}
+
+const void* ImuPublisher::fill(const ModuleReading& reading, const builtin_interfaces__msg__Time& stamp){
+	msg.header.stamp = stamp;
+	msg.linear_acceleration.x = reading.accel.x;
+	msg.linear_acceleration.y = reading.accel.y;
+	msg.linear_acceleration.z = reading.accel.z;
+	return &msg;
+}
+
+TemperaturePublisher::TemperaturePublisher(const std::string& topic, ModuleBus bus, const Config& config) :
+		ModulePublisher(topic, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, Temperature), config){
+	setFrame(msg.header.frame_id, bus);
+}
+
+const void* TemperaturePublisher::fill(const ModuleReading& reading, const builtin_interfaces__msg__Time& stamp){
+	msg.header.stamp = stamp;
+	msg.temperature = reading.temperature;
+	return &msg;
+}
+
+HumidityPublisher::HumidityPublisher(const std::string& topic, ModuleBus bus, const Config& config) :
+		ModulePublisher(topic, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, RelativeHumidity), config){
+	setFrame(msg.header.frame_id, bus);
+}
+
+const void* HumidityPublisher::fill(const ModuleReading& reading, const builtin_interfaces__msg__Time& stamp){
+	msg.header.stamp = stamp;
+	msg.relative_humidity = reading.humidity / 100.0;
+	return &msg;
+}
+
+PressurePublisher::PressurePublisher(const std::string& topic, ModuleBus bus, const Config& config) :
+		ModulePublisher(topic, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, FluidPressure), config){
+	setFrame(msg.header.frame_id, bus);
+}
+
+const void* PressurePublisher::fill(const ModuleReading& reading, const builtin_interfaces__msg__Time& stamp){
+	msg.header.stamp = stamp;
+	msg.fluid_pressure = reading.pressure;
+	return &msg;
+}
+
+IlluminancePublisher::IlluminancePublisher(const std::string& topic, ModuleBus bus, const Config& config) :
+		ModulePublisher(topic, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, Illuminance), config){
+	setFrame(msg.header.frame_id, bus);
+}
+
+const void* IlluminancePublisher::fill(const ModuleReading& reading, const builtin_interfaces__msg__Time& stamp){
+	msg.header.stamp = stamp;
+	msg.illuminance = reading.light;
+	return &msg;
+}
+
+StatePublisher::StatePublisher(const std::string& topic, const Config& config) :
+		ModulePublisher(topic, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Bool), config){}
+
+const void* StatePublisher::fill(const ModuleReading& reading, const builtin_interfaces__msg__Time& stamp){
+	msg.data = reading.state;
+	return &msg;
+}
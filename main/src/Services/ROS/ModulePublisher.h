@@ -0,0 +1,146 @@
+#ifndef PERSE_ROVER_MODULEPUBLISHER_H
+#define PERSE_ROVER_MODULEPUBLISHER_H
+
+#include <string>
+#include <glm.hpp>
+#include <builtin_interfaces/msg/time.h>
+#include <rosidl_runtime_c/string.h>
+#include <sensor_msgs/msg/imu.h>
+#include <sensor_msgs/msg/temperature.h>
+#include <sensor_msgs/msg/relative_humidity.h>
+#include <sensor_msgs/msg/fluid_pressure.h>
+#include <sensor_msgs/msg/illuminance.h>
+#include <std_msgs/msg/bool.h>
+#include "Services/MicroROS.h"
+#include "Util/LatestReading.h"
+#include "CommData.h"
+
+/**
+ * One sample from a module, in SI units. Each module only fills in the fields it measures.
+ */
+struct ModuleReading {
+	glm::vec3 accel; // [m/s^2]
+	float temperature; // [°C]
+	float humidity; // [%]
+	float pressure; // [Pa]
+	float light; // [%] relative level, the photoresistor isn't calibrated to lux
+	bool state; // CO2: air quality OK, Motion: motion detected
+};
+
+/**
+ * Publishes the latest reading of a module topic. Readings are reported from the module's own task
+ * and published on the micro-ROS task, at most once per interval and only if a new reading came in since the last message.
+ */
+class ModulePublisher : public MicroROS::Publisher {
+public:
+	enum class QoS : uint8_t {
+		Reliable, BestEffort
+	};
+
+	struct Config {
+		uint32_t interval; // [ms] minimum time between messages, 0 publishes every reading
+		QoS qos;
+	};
+
+	ModulePublisher(std::string topic, const rosidl_message_type_support_t* type, const Config& config);
+
+	bool create(rcl_node_t* node) override;
+	void destroy(rcl_node_t* node) override;
+	int64_t update(int64_t now) override;
+
+	/**
+	 * Stores a reading for the next message. Safe to call from any task.
+	 */
+	void report(const ModuleReading& reading);
+
+protected:
+	/**
+	 * Fills in the message from a reading.
+	 * @return The message to publish
+	 */
+	virtual const void* fill(const ModuleReading& reading, const builtin_interfaces__msg__Time& stamp) = 0;
+
+	static void setFrame(rosidl_runtime_c__String& frame, ModuleBus bus);
+
+private:
+	const std::string topic;
+	const rosidl_message_type_support_t* type;
+	const QoS qos;
+
+	rcl_publisher_t publisher;
+	LatestReading<ModuleReading> latest; // sampled at esp_timer time
+
+	static constexpr int64_t IdlePoll = 20 * 1000; // [us] how often a due topic checks for a new reading
+};
+
+class ImuPublisher : public ModulePublisher {
+public:
+	ImuPublisher(const std::string& topic, ModuleBus bus, const Config& config);
+
+protected:
+	const void* fill(const ModuleReading& reading, const builtin_interfaces__msg__Time& stamp) override;
+
+private:
+	sensor_msgs__msg__Imu msg{};
+};
+
+class TemperaturePublisher : public ModulePublisher {
+public:
+	TemperaturePublisher(const std::string& topic, ModuleBus bus, const Config& config);
+
+protected:
+	const void* fill(const ModuleReading& reading, const builtin_interfaces__msg__Time& stamp) override;
+
+private:
+	sensor_msgs__msg__Temperature msg{};
+};
+
+class HumidityPublisher : public ModulePublisher {
+public:
+	HumidityPublisher(const std::string& topic, ModuleBus bus, const Config& config);
+
+protected:
+	const void* fill(const ModuleReading& reading, const builtin_interfaces__msg__Time& stamp) override;
+
+private:
+	sensor_msgs__msg__RelativeHumidity msg{};
+};
+
+class PressurePublisher : public ModulePublisher {
+public:
+	PressurePublisher(const std::string& topic, ModuleBus bus, const Config& config);
+
+protected:
+	const void* fill(const ModuleReading& reading, const builtin_interfaces__msg__Time& stamp) override;
+
+private:
+	sensor_msgs__msg__FluidPressure msg{};
+};
+
+class IlluminancePublisher : public ModulePublisher {
+public:
+	IlluminancePublisher(const std::string& topic, ModuleBus bus, const Config& config);
+
+protected:
+	const void* fill(const ModuleReading& reading, const builtin_interfaces__msg__Time& stamp) override;
+
+private:
+	sensor_msgs__msg__Illuminance msg{};
+};
+
+/**
+ * On/off modules (CO2, Motion) have no sensor_msgs counterpart and go out as std_msgs/Bool.
+ */
+class StatePublisher : public ModulePublisher {
+public:
+	StatePublisher(const std::string& topic, const Config& config);
+
+protected:
+	const void* fill(const ModuleReading& reading, const builtin_interfaces__msg__Time& stamp) override;
+
+private:
+	std_msgs__msg__Bool msg{};
+};
+
+
+#endif //PERSE_ROVER_MODULEPUBLISHER_H
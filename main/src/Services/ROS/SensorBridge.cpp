@@ -0,0 +1,167 @@
+#include "SensorBridge.h"
+#include <esp_log.h>
+#include "Util/Services.h"
+#include "Services/Modules.h"
+
+static const char* TAG = "SensorBridge";
+
+// The IMU feeds control loops and is fine with losing a sample, the slow environmental readings are sent reliably
+const std::array<SensorBridge::TopicConfig, (size_t) SensorBridge::Topic::COUNT> SensorBridge::DefaultConfig = {{
+		{ 50, ModulePublisher::QoS::BestEffort },   // Imu
+		{ 1000, ModulePublisher::QoS::Reliable },   // Temperature
+		{ 1000, ModulePublisher::QoS::Reliable },   // Humidity
+		{ 500, ModulePublisher::QoS::Reliable },    // Pressure
+		{ 200, ModulePublisher::QoS::BestEffort },  // Illuminance
+		{ 1000, ModulePublisher::QoS::Reliable },   // AirQuality
+		{ 0, ModulePublisher::QoS::Reliable }       // Motion, every change
+}};
+
+const std::array<const char*, (size_t) SensorBridge::Topic::COUNT> SensorBridge::TopicNames = {
+		"imu", "temperature", "humidity", "pressure", "illuminance", "air_quality_ok", "motion"
+};
+
+SensorBridge::SensorBridge(MicroROS& microros) : Threaded("SensorBridge", 4 * 1024, 5, 1), microros(microros), queue(10), config(DefaultConfig){
+	Events::listen(Facility::Modules, &queue);
+
+	// Modules inserted before the bridge was up
+	if(Modules* modules = (Modules*) Services.get(Service::Modules)){
+		insert(ModuleBus::Left, modules->getInserted(ModuleBus::Left));
+		insert(ModuleBus::Right, modules->getInserted(ModuleBus::Right));
+	}
+
+	start();
+}
+
+SensorBridge::~SensorBridge(){
+	stop();
+	Events::unlisten(&queue);
+
+	remove(ModuleBus::Left);
+	remove(ModuleBus::Right);
+}
+
+void SensorBridge::setConfig(Topic topic, const TopicConfig& config){
+	std::lock_guard lock(mut);
+	this->config[(size_t) topic] = config;
+}
+
+SensorBridge::TopicConfig SensorBridge::getConfig(Topic topic) const{
+	std::lock_guard lock(mut);
+	return config[(size_t) topic];
+}
+
+void SensorBridge::report(ModuleBus bus, const ModuleReading& reading){
+	std::lock_guard lock(mut);
+
+	for(auto publisher : getPublishers(bus)){
+		if(publisher == nullptr) continue;
+		publisher->report(reading);
+	}
+}
+
+SensorBridge::BusPublishers& SensorBridge::getPublishers(ModuleBus bus){
+	if(bus == ModuleBus::Left){
+		return left;
+	}else{
+		return right;
+	}
+}
+
+void SensorBridge::loop(){
+	::Event e{};
+	if(!queue.get(e, portMAX_DELAY)) return;
+
+	if(e.facility == Facility::Modules && e.data != nullptr){
+		const auto& data = *((Modules::Event*) e.data);
+
+		if(data.action == Modules::Event::Insert){
+			insert(data.bus, data.module);
+		}else if(data.action == Modules::Event::Remove){
+			remove(data.bus);
+		}
+	}
+
+	Events::release(e.data);
+}
+
+void SensorBridge::afterStopSignal(){
+	queue.unblock();
+}
+
+void SensorBridge::insert(ModuleBus bus, ModuleType type){
+	remove(bus);
+
+	BusPublishers publishers{};
+	switch(type){
+		case ModuleType::Gyro:
+			publishers[0] = createPublisher(Topic::Imu, bus);
+			break;
+		case ModuleType::TempHum:
+			publishers[0] = createPublisher(Topic::Temperature, bus);
+			publishers[1] = createPublisher(Topic::Humidity, bus);
+			break;
+		case ModuleType::AltPress:
+			publishers[0] = createPublisher(Topic::Pressure, bus);
+			break;
+		case ModuleType::PhotoRes:
+			publishers[0] = createPublisher(Topic::Illuminance, bus);
+			break;
+		case ModuleType::CO2:
+			publishers[0] = createPublisher(Topic::AirQuality, bus);
+			break;
+		case ModuleType::Motion:
+			publishers[0] = createPublisher(Topic::Motion, bus);
+			break;
+		default:
+			// Actuator modules (LED, RGB) and unknown ones have nothing to publish
+			return;
+	}
+
+	for(auto publisher : publishers){
+		if(publisher == nullptr) continue;
+		microros.add(publisher);
+	}
+
+	std::lock_guard lock(mut);
+	getPublishers(bus) = publishers;
+}
+
+void SensorBridge::remove(ModuleBus bus){
+	BusPublishers publishers;
+	{
+		std::lock_guard lock(mut);
+		publishers = getPublishers(bus);
+		getPublishers(bus) = {};
+	}
+
+	for(auto publisher : publishers){
+		if(publisher == nullptr) continue;
+		microros.remove(publisher);
+		delete publisher;
+	}
+}
+
+ModulePublisher* SensorBridge::createPublisher(Topic topic, ModuleBus bus){
+	const std::string name = std::string("modules/") + (bus == ModuleBus::Left ? "left/" : "right/") + TopicNames[(size_t) topic];
+	const TopicConfig topicConfig = getConfig(topic);
+
+	ESP_LOGI(TAG, "Publishing %s every %lu ms", name.c_str(), topicConfig.interval);
+
+	switch(topic){
+		case Topic::Imu:
+			return new ImuPublisher(name, bus, topicConfig);
+		case Topic::Temperature:
+			return new TemperaturePublisher(name, bus, topicConfig);
+		case Topic::Humidity:
+			return new HumidityPublisher(name, bus, topicConfig);
+		case Topic::Pressure:
+			return new PressurePublisher(name, bus, topicConfig);
+		case Topic::Illuminance:
+			return new IlluminancePublisher(name, bus, topicConfig);
+		case Topic::AirQuality:
+		case Topic::Motion:
+			return new StatePublisher(name, topicConfig);
+		default:
+			return nullptr;
+	}
+}
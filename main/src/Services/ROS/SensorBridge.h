@@ -0,0 +1,64 @@
+#ifndef PERSE_ROVER_SENSORBRIDGE_H
+#define PERSE_ROVER_SENSORBRIDGE_H
+
+#include <array>
+#include <mutex>
+#include "Util/Threaded.h"
+#include "Util/Events.h"
+#include "Services/MicroROS.h"
+#include "ModulePublisher.h"
+
+/**
+ * Publishes the readings of the inserted modules on micro-ROS. Topics are created when a module is inserted
+ * and removed with it, following the Facility::Modules events, and are named modules/<left|right>/<topic>.
+ * Modules hand their readings over with report(), each topic publishes the latest one at its configured rate.
+ */
+class SensorBridge : private Threaded {
+public:
+	explicit SensorBridge(MicroROS& microros);
+	~SensorBridge() override;
+
+	enum class Topic : uint8_t {
+		Imu, Temperature, Humidity, Pressure, Illuminance, AirQuality, Motion, COUNT
+	};
+
+	using TopicConfig = ModulePublisher::Config;
+
+	/**
+	 * Applies to topics created after the call, so a module already inserted keeps its rate and QoS until it is reinserted.
+	 */
+	void setConfig(Topic topic, const TopicConfig& config);
+	TopicConfig getConfig(Topic topic) const;
+
+	/**
+	 * Called by the modules with every new reading. Dropped if the module's topics don't exist yet.
+	 */
+	void report(ModuleBus bus, const ModuleReading& reading);
+
+private:
+	MicroROS& microros;
+	EventQueue queue;
+
+	std::array<TopicConfig, (size_t) Topic::COUNT> config;
+	static const std::array<TopicConfig, (size_t) Topic::COUNT> DefaultConfig;
+	static const std::array<const char*, (size_t) Topic::COUNT> TopicNames;
+
+	// A module has at most two topics (TempHum)
+	static constexpr size_t MaxTopics = 2;
+	using BusPublishers = std::array<ModulePublisher*, MaxTopics>;
+	BusPublishers left{};
+	BusPublishers right{};
+	mutable std::mutex mut; // guards the publishers and the config
+
+	BusPublishers& getPublishers(ModuleBus bus);
+
+	void loop() override;
+	void afterStopSignal() override;
+
+	void insert(ModuleBus bus, ModuleType type);
+	void remove(ModuleBus bus);
+	ModulePublisher* createPublisher(Topic topic, ModuleBus bus);
+};
+
+
+#endif //PERSE_ROVER_SENSORBRIDGE_H
@@ -0,0 +1,65 @@
+#include "TaskStatsPublisher.h"
+#include <esp_log.h>
+
+static const char* TAG = "TaskStatsPublisher";
+
+TaskStatsPublisher::TaskStatsPublisher(TaskMonitor& monitor) : monitor(monitor), request(requested){}
+
+bool TaskStatsPublisher::create(rcl_node_t* node){
+	publisher = rcl_get_zero_initialized_publisher();
+
+	// Reliable, a report is a few KB and has to be fragmented
+	return rclc_publisher_init_default(&publisher, node, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, String), "diagnostics/tasks") == RCL_RET_OK;
+}
+
+void TaskStatsPublisher::destroy(rcl_node_t* node){
+	rcl_publisher_fini(&publisher, node);
+	requested = false;
+}
+
+int64_t TaskStatsPublisher::update(int64_t now){
+	if(!requested.exchange(false)) return Poll;
+
+	text.clear();
+	TaskMonitor::format(monitor.getReport(), [this](const char* line){
+		text += line;
+		text += '\n';
+	});
+
+	msg.data.data = text.data();
+	msg.data.size = text.size();
+	msg.data.capacity = text.capacity() + 1;
+
+	if(rcl_publish(&publisher, &msg, nullptr) != RCL_RET_OK){
+		ESP_LOGW(TAG, "Can't publish %zu B task report", text.size());
+	}
+
+	return Poll;
+}
+
+MicroROS::Subscriber* TaskStatsPublisher::getRequest(){
+	return &request;
+}
+
+TaskStatsPublisher::Request::Request(std::atomic<bool>& requested) : requested(requested){}
+
+bool TaskStatsPublisher::Request::create(rcl_node_t* node){
+	subscription = rcl_get_zero_initialized_subscription();
+	return rclc_subscription_init_default(&subscription, node, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Empty), "diagnostics/tasks/request") == RCL_RET_OK;
+}
+
+void TaskStatsPublisher::Request::destroy(rcl_node_t* node){
+	rcl_subscription_fini(&subscription, node);
+}
+
+rcl_subscription_t* TaskStatsPublisher::Request::getSubscription(){
+	return &subscription;
+}
+
+void* TaskStatsPublisher::Request::getMessage(){
+	return &msg;
+}
+
+void TaskStatsPublisher::Request::onMessage(const void* msg){
+	requested = true;
+}
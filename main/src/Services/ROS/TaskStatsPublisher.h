@@ -0,0 +1,55 @@
+#ifndef PERSE_ROVER_TASKSTATSPUBLISHER_H
+#define PERSE_ROVER_TASKSTATSPUBLISHER_H
+
+#include <atomic>
+#include <string>
+#include <std_msgs/msg/string.h>
+#include <std_msgs/msg/empty.h>
+#include "Services/MicroROS.h"
+#include "Services/TaskMonitor.h"
+
+/**
+ * Publishes a TaskMonitor report on diagnostics/tasks (std_msgs/String, the same lines as the periodic log)
+ * whenever anything arrives on diagnostics/tasks/request (std_msgs/Empty).
+ * Both the publisher and getRequest() have to be added to MicroROS.
+ */
+class TaskStatsPublisher : public MicroROS::Publisher {
+public:
+	explicit TaskStatsPublisher(TaskMonitor& monitor);
+
+	bool create(rcl_node_t* node) override;
+	void destroy(rcl_node_t* node) override;
+	int64_t update(int64_t now) override;
+
+	MicroROS::Subscriber* getRequest();
+
+private:
+	TaskMonitor& monitor;
+
+	rcl_publisher_t publisher;
+	std_msgs__msg__String msg{};
+	std::string text;
+
+	std::atomic<bool> requested = false;
+	static constexpr int64_t Poll = 100 * 1000; // [us]
+
+	class Request : public MicroROS::Subscriber {
+	public:
+		explicit Request(std::atomic<bool>& requested);
+
+		bool create(rcl_node_t* node) override;
+		void destroy(rcl_node_t* node) override;
+
+		rcl_subscription_t* getSubscription() override;
+		void* getMessage() override;
+		void onMessage(const void* msg) override;
+
+	private:
+		std::atomic<bool>& requested;
+		rcl_subscription_t subscription;
+		std_msgs__msg__Empty msg{};
+	} request;
+};
+
+
+#endif //PERSE_ROVER_TASKSTATSPUBLISHER_H
@@ -2,33 +2,66 @@
 #include "Util/Events.h"
 #include <lwip/sockets.h>
 #include <esp_log.h>
+#include <algorithm>
+#include <cstring>
 
 static const char* TAG = "TCPServer";
 
-TCPServer::TCPServer(){
-	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
-	if(sock == -1){
-		ESP_LOGE(TAG, "Can't create socket, errno=%d: %s", errno, strerror(errno));
+TCPServer::TCPServer() : txBuf(TxBufSize){
+	sock = listenOn(ControlPort, 1);
+	observerSock = listenOn(ObserverPort, MaxObservers);
+	if(sock == -1) return;
+
+	// Loopback datagram socket connected to itself, a byte sent to it makes wait() return
+	wakeSock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if(wakeSock == -1){
+		ESP_LOGE(TAG, "Can't create wake socket, errno=%d: %s", errno, strerror(errno));
 		return;
 	}
 
+	sockaddr_in wakeAddr{};
+	wakeAddr.sin_family = AF_INET;
+	wakeAddr.sin_port = 0;
+	wakeAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t wakeAddrSize = sizeof(wakeAddr);
+	if(bind(wakeSock, (sockaddr*) &wakeAddr, sizeof(wakeAddr)) != 0 ||
+	   getsockname(wakeSock, (sockaddr*) &wakeAddr, &wakeAddrSize) != 0 ||
+	   connect(wakeSock, (sockaddr*) &wakeAddr, sizeof(wakeAddr)) != 0){
+		ESP_LOGE(TAG, "Can't set up wake socket, errno=%d: %s", errno, strerror(errno));
+		close(wakeSock);
+		wakeSock = -1;
+		return;
+	}
+
+	fcntl(wakeSock, F_SETFL, O_NONBLOCK);
+}
+
+int TCPServer::listenOn(uint16_t port, int backlog){
+	const int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+	if(fd == -1){
+		ESP_LOGE(TAG, "Can't create socket, errno=%d: %s", errno, strerror(errno));
+		return -1;
+	}
+
 	sockaddr_in addr{};
 	addr.sin_family = AF_INET;
-	addr.sin_port = htons(6000);
+	addr.sin_port = htons(port);
 	inet_pton(AF_INET, "11.0.0.1", &addr.sin_addr);
-	if(bind(sock, (sockaddr*) &addr, sizeof(addr)) != 0){
+	if(bind(fd, (sockaddr*) &addr, sizeof(addr)) != 0){
 		ESP_LOGE(TAG, "Can't bind address to socket, errno=%d: %s", errno, strerror(errno));
-		sock = -1;
-		return;
+		close(fd);
+		return -1;
 	}
 
-	if(listen(sock, 1) != 0){
+	if(listen(fd, backlog) != 0){
 		ESP_LOGE(TAG, "Can't listen on socket, errno=%d: %s", errno, strerror(errno));
-		sock = -1;
-		return;
+		close(fd);
+		return -1;
 	}
 
-	fcntl(sock, F_SETFL, O_NONBLOCK);
+	fcntl(fd, F_SETFL, O_NONBLOCK);
+
+	return fd;
 }
 
 bool TCPServer::isConnected() const{
@@ -48,19 +81,26 @@ bool TCPServer::accept(){
 
 	sockaddr_in addr_client{};
 	socklen_t addr_size = sizeof(addr_client);
-	if((client = ::accept(sock, (sockaddr*) &addr_client, &addr_size)) == -1){
+	const int fd = ::accept(sock, (sockaddr*) &addr_client, &addr_size);
+	if(fd == -1){
 		ESP_LOGV(TAG, "Can't accept, errno=%d: %s", errno, strerror(errno));
 		return false;
 	}
 
-	constexpr int keepAlive = 1;
-	constexpr int keepIdle = 4; // Time (in seconds) without packets before keep-alive packet sending begins
-	constexpr int keepInterval = 2; // Interval between keep-alive packets
-	constexpr int keepCount = 2; // Number of keep-alive packets before connection drops
-	setsockopt(client, SOL_SOCKET, SO_KEEPALIVE, &keepAlive, sizeof(int));
-	setsockopt(client, IPPROTO_TCP, TCP_KEEPIDLE, &keepIdle, sizeof(int));
-	setsockopt(client, IPPROTO_TCP, TCP_KEEPINTVL, &keepInterval, sizeof(int));
-	setsockopt(client, IPPROTO_TCP, TCP_KEEPCNT, &keepCount, sizeof(int));
+	configure(fd);
+
+	{
+		std::lock_guard lock(mut);
+		txCount = 0;
+		clientSent = 0;
+		txPeak = 0;
+		overflowed = false;
+		client = fd;
+
+		// Hands back whatever the previous client's backlog grew it to
+		txBuf.resize(TxBufSize);
+		txBuf.shrink_to_fit();
+	}
 
 	char addr_str[32];
 	inet_ntoa_r(addr_client.sin_addr, addr_str, sizeof(addr_str)-1);
@@ -74,76 +114,331 @@ bool TCPServer::accept(){
 }
 
 void TCPServer::disconnect(){
-	if(client == -1){
+	int fd;
+	{
+		std::lock_guard lock(mut);
+		fd = client.exchange(-1);
+		txCount = 0;
+		clientSent = 0;
+
+		if(fd != -1){
+			close(fd);
+		}
+
+		for(auto& observer : observers){
+			if(observer.fd != -1){
+				closeObserver(observer);
+			}
+		}
+	}
+
+	if(fd == -1){
 		ESP_LOGW(TAG, "Disconnect, but client isn't connected");
 		return;
 	}
 
-	close(client);
-	client = -1;
+	wake();
 
 	Event event{ Event::Status::Disconnected };
 	Events::post(Facility::TCP, event);
 }
 
-bool TCPServer::read(uint8_t* buf, size_t count){
-	if(client == -1){
-		ESP_LOGW(TAG, "Read, but client isn't connected");
-		return false;
+bool TCPServer::wait(TickType_t timeout){
+	const int fd = client;
+	if(fd == -1) return false;
+
+	fd_set readSet;
+	fd_set writeSet;
+	FD_ZERO(&readSet);
+	FD_ZERO(&writeSet);
+	int maxFd = std::max(fd, wakeSock);
+	bool writing = false;
+
+	FD_SET(fd, &readSet);
+	if(wakeSock != -1){
+		FD_SET(wakeSock, &readSet);
 	}
 
-	if(count == 0) return true;
+	{
+		std::lock_guard lock(mut);
 
-	size_t total = 0;
-	while(total < count){
-		int now = ::read(client, buf + total, count - total);
+		if(txCount > clientSent){
+			FD_SET(fd, &writeSet);
+			writing = true;
+		}
 
-		if(now == 0){
-			disconnect();
-			return false;
-		}else if(now < 0){
-			if(errno == EAGAIN || errno == EWOULDBLOCK){
-				vTaskDelay(1);
+		bool slotFree = false;
+		for(const auto& observer : observers){
+			if(observer.fd == -1){
+				slotFree = true;
 				continue;
-			}else{
-				disconnect();
-				return false;
 			}
+
+			FD_SET(observer.fd, &readSet);
+			if(txCount > observer.sent && !observer.dropped){
+				FD_SET(observer.fd, &writeSet);
+				writing = true;
+			}
+			maxFd = std::max(maxFd, observer.fd);
 		}
 
-		total += now;
+		if(slotFree && observerSock != -1){
+			FD_SET(observerSock, &readSet);
+			maxFd = std::max(maxFd, observerSock);
+		}
 	}
 
-	return true;
-}
+	timeval tv{};
+	tv.tv_sec = pdTICKS_TO_MS(timeout) / 1000;
+	tv.tv_usec = (pdTICKS_TO_MS(timeout) % 1000) * 1000;
+
+	const int ret = select(maxFd + 1, &readSet, writing ? &writeSet : nullptr, nullptr, timeout == portMAX_DELAY ? nullptr : &tv);
+	if(ret < 0 && errno != EINTR){
+		if(client == -1) return false;
 
-bool TCPServer::write(uint8_t* data, size_t count){
-	if(client == -1){
-		ESP_LOGW(TAG, "Write, but client isn't connected");
+		ESP_LOGW(TAG, "Select failed, errno=%d: %s", errno, strerror(errno));
+		disconnect();
 		return false;
 	}
 
+	if(ret <= 0) return client != -1;
+
+	if(wakeSock != -1 && FD_ISSET(wakeSock, &readSet)){
+		clearWake();
+	}
+
+	if(observerSock != -1 && FD_ISSET(observerSock, &readSet)){
+		acceptObserver();
+	}
+
+	{
+		std::lock_guard lock(mut);
+		for(auto& observer : observers){
+			if(observer.fd != -1 && FD_ISSET(observer.fd, &readSet)){
+				drainObserver(observer);
+			}
+		}
+	}
+
+	return client != -1;
+}
+
+void TCPServer::wake(){
+	if(wakeSock == -1) return;
+	if(wakePending.exchange(true)) return;
+
+	const uint8_t byte = 0;
+	::send(wakeSock, &byte, sizeof(byte), 0);
+}
+
+void TCPServer::clearWake(){
+	// Cleared before draining, so a wake() arriving in between is never lost
+	wakePending = false;
+
+	uint8_t buf[8];
+	while(::recv(wakeSock, buf, sizeof(buf), 0) > 0);
+}
+
+int TCPServer::read(uint8_t* buf, size_t count){
+	const int fd = client;
+	if(fd == -1) return -1;
+	if(count == 0) return 0;
+
+	const int now = ::recv(fd, buf, count, 0);
+	if(now > 0) return now;
+
+	if(now < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
+		return 0;
+	}
+
+	if(client != -1){
+		disconnect();
+	}
+	return -1;
+}
+
+bool TCPServer::write(const uint8_t* data, size_t count, bool droppable){
 	if(count == 0) return true;
 
-	size_t total = 0;
-	while(total < count){
-		int now = ::write(client, data + total, count - total);
+	bool wasEmpty;
+	{
+		std::lock_guard lock(mut);
+		if(client == -1 || overflowed) return false;
 
-		if(now == 0){
-			disconnect();
+		// Observers never make the buffer grow, those that would hold more than TxBufSize back are dropped
+		if(txCount + count > TxBufSize){
+			for(auto& observer : observers){
+				if(observer.fd != -1 && !observer.dropped && txCount - observer.sent + count > TxBufSize){
+					ESP_LOGW(TAG, "Observer fell behind, dropping it");
+					observer.dropped = true;
+				}
+			}
+			compact();
+		}
+
+		if(droppable && txCount + count > TxBufSize){
 			return false;
-		}else if(now < 0){
-			if(errno == EAGAIN || errno == EWOULDBLOCK){
-				vTaskDelay(1);
-				continue;
-			}else{
-				disconnect();
-				return false;
+		}
+
+		if(txCount + count > MaxTxBufSize){
+			ESP_LOGE(TAG, "Client stopped taking data, %zu bytes unsent, disconnecting", txCount - clientSent);
+			overflowed = true;
+			wake();
+			return false;
+		}
+
+		if(txCount + count > txBuf.size()){
+			txBuf.resize(std::min(MaxTxBufSize, std::max(txBuf.size() * 2, txCount + count)));
+		}
+
+		wasEmpty = txCount == clientSent;
+		memcpy(txBuf.data() + txCount, data, count);
+		txCount += count;
+		txPeak = std::max(txPeak, txCount - clientSent);
+	}
+
+	if(wasEmpty){
+		wake();
+	}
+
+	return true;
+}
+
+bool TCPServer::flush(){
+	bool failed = false;
+	{
+		std::lock_guard lock(mut);
+		const int fd = client;
+		if(fd == -1) return false;
+
+		failed = overflowed || !flushTo(fd, clientSent);
+
+		for(auto& observer : observers){
+			if(observer.fd == -1) continue;
+
+			if(observer.dropped || !flushTo(observer.fd, observer.sent)){
+				closeObserver(observer);
 			}
 		}
 
-		total += now;
+		compact();
+	}
+
+	if(failed){
+		disconnect();
+		return false;
 	}
 
 	return true;
 }
+
+size_t TCPServer::getPending(){
+	std::lock_guard lock(mut);
+	return txCount - clientSent;
+}
+
+size_t TCPServer::getPendingPeak(){
+	std::lock_guard lock(mut);
+	return txPeak;
+}
+
+size_t TCPServer::getObserverCount(){
+	std::lock_guard lock(mut);
+	return std::count_if(observers.cbegin(), observers.cend(), [](const Observer& observer){ return observer.fd != -1; });
+}
+
+void TCPServer::configure(int fd){
+	constexpr int keepAlive = 1;
+	constexpr int keepIdle = 4; // Time (in seconds) without packets before keep-alive packet sending begins
+	constexpr int keepInterval = 2; // Interval between keep-alive packets
+	constexpr int keepCount = 2; // Number of keep-alive packets before connection drops
+	setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &keepAlive, sizeof(int));
+	setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &keepIdle, sizeof(int));
+	setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &keepInterval, sizeof(int));
+	setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &keepCount, sizeof(int));
+
+	// Packets are already batched by flush(), Nagle would only hold them back
+	constexpr int noDelay = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(int));
+	fcntl(fd, F_SETFL, O_NONBLOCK);
+}
+
+void TCPServer::acceptObserver(){
+	sockaddr_in addr_client{};
+	socklen_t addr_size = sizeof(addr_client);
+	const int fd = ::accept(observerSock, (sockaddr*) &addr_client, &addr_size);
+	if(fd == -1){
+		ESP_LOGV(TAG, "Can't accept observer, errno=%d: %s", errno, strerror(errno));
+		return;
+	}
+
+	configure(fd);
+
+	{
+		std::lock_guard lock(mut);
+
+		auto observer = std::find_if(observers.begin(), observers.end(), [](const Observer& observer){ return observer.fd == -1; });
+		if(client == -1 || observer == observers.end()){
+			close(fd);
+			return;
+		}
+
+		// Starts with the next packet, the buffer only ever holds whole packets
+		*observer = { fd, txCount, false };
+	}
+
+	char addr_str[32];
+	inet_ntoa_r(addr_client.sin_addr, addr_str, sizeof(addr_str)-1);
+
+	ESP_LOGI(TAG, "Observer %s connected", addr_str);
+}
+
+void TCPServer::drainObserver(Observer& observer){
+	uint8_t buf[32];
+	int now;
+	while((now = ::recv(observer.fd, buf, sizeof(buf), 0)) > 0);
+
+	if(now == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)){
+		closeObserver(observer);
+	}
+}
+
+void TCPServer::closeObserver(Observer& observer){
+	close(observer.fd);
+	observer = {};
+
+	ESP_LOGI(TAG, "Observer disconnected");
+}
+
+bool TCPServer::flushTo(int fd, size_t& sent){
+	if(sent >= txCount) return true;
+
+	const int now = ::send(fd, txBuf.data() + sent, txCount - sent, 0);
+	if(now > 0){
+		sent += now;
+		return true;
+	}
+
+	return now < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+void TCPServer::compact(){
+	size_t base = clientSent;
+	for(const auto& observer : observers){
+		if(observer.fd == -1 || observer.dropped) continue;
+		base = std::min(base, observer.sent);
+	}
+
+	if(base == 0) return;
+
+	memmove(txBuf.data(), txBuf.data() + base, txCount - base);
+	txCount -= base;
+	clientSent -= base;
+
+	for(auto& observer : observers){
+		if(observer.fd == -1) continue;
+
+		// Dropped observers are closed before they'd send again, keep their offset from going negative
+		observer.sent = observer.sent > base ? observer.sent - base : 0;
+	}
+}
@@ -3,7 +3,23 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <freertos/FreeRTOS.h>
 
+/**
+ * Control link with one controlling client and up to MaxObservers read-only observers. All socket I/O is non-blocking.
+ * Outgoing data from any task is appended once to a send buffer shared by all connections, and flushed with one write
+ * per connection by the task driving the link, which sleeps in wait() until the controller sends something,
+ * queued data can go out, an observer connects, or it gets woken up.
+ * The role comes from the port: the controller connects to ControlPort, observers to ObserverPort, so an observer
+ * can never end up in control, no matter when it connects. Observers are accepted while a controller is connected,
+ * everything they send is discarded, and they are dropped together with the controller or when they fall
+ * TxBufSize behind. Data for the controller is never dropped: the buffer grows up to MaxTxBufSize while the controller
+ * is slow, and a controller that stops taking data altogether is disconnected.
+ */
 class TCPServer {
 public:
 
@@ -20,13 +36,87 @@ public:
 	bool accept();
 	void disconnect();
 
-	bool read(uint8_t* buf, size_t count);
-	bool write(uint8_t* data, size_t count);
+	/**
+	 * Blocks until there is data to read, pending data can be flushed, or wake() was called.
+	 * @return false if the client isn't connected or got disconnected
+	 */
+	bool wait(TickType_t timeout = portMAX_DELAY);
+
+	/**
+	 * Wakes up a task blocked in wait(). Safe to call from any task.
+	 */
+	void wake();
+
+	/**
+	 * Reads whatever the controller has sent, never blocks.
+	 * @return Number of bytes read, -1 if the client disconnected
+	 */
+	int read(uint8_t* buf, size_t count);
+
+	/**
+	 * Queues data for the next flush(). The data is written as a whole or not at all. Safe to call from any task.
+	 * @param droppable Data that's superseded by a newer copy anyway, only queued while the buffer is within TxBufSize
+	 * @return false if the client isn't connected, droppable data didn't fit, or the controller fell MaxTxBufSize behind
+	 * and is disconnected by the next flush()
+	 */
+	bool write(const uint8_t* data, size_t count, bool droppable = false);
+
+	/**
+	 * Sends as much of the queued data as each socket takes right now, in a single write per connection.
+	 * @return false if the client disconnected
+	 */
+	bool flush();
+
+	/**
+	 * @return Number of bytes queued and not yet taken by the controller's socket
+	 */
+	size_t getPending();
+
+	/**
+	 * @return Highest number of queued bytes since the client connected
+	 */
+	size_t getPendingPeak();
+
+	size_t getObserverCount();
+
+	static constexpr uint16_t ControlPort = 6000;
+	static constexpr uint16_t ObserverPort = 6002;
+
+	static constexpr size_t TxBufSize = 1024; // [B] also what an observer may fall behind, and the limit for droppable data
+	static constexpr size_t MaxTxBufSize = 8 * 1024; // [B] what the controller may fall behind before it's disconnected
 
 private:
 	int sock = -1;
+	int observerSock = -1;
+	std::atomic_int client = -1;
+
+	int wakeSock = -1;
+	std::atomic_bool wakePending = false;
+	void clearWake();
+
+	static constexpr size_t MaxObservers = 3;
+
+	struct Observer {
+		int fd = -1;
+		size_t sent = 0; // offset in txBuf up to which this observer has been sent everything
+		bool dropped = false; // fell behind, closed by the next flush()
+	};
+	std::array<Observer, MaxObservers> observers;
+
+	std::vector<uint8_t> txBuf;
+	size_t txCount = 0;
+	size_t clientSent = 0; // offset in txBuf up to which the controller has been sent everything
+	size_t txPeak = 0;
+	bool overflowed = false; // the controller fell MaxTxBufSize behind, disconnected by the next flush()
+	std::mutex mut; // guards the send buffer, the observers and closing the client socket
 
-	int client = -1;
+	static int listenOn(uint16_t port, int backlog);
+	static void configure(int fd);
+	void acceptObserver();
+	void drainObserver(Observer& observer);
+	void closeObserver(Observer& observer);
+	bool flushTo(int fd, size_t& sent);
+	void compact();
 
 };
 
@@ -0,0 +1,156 @@
+#include "TaskMonitor.h"
+#include <esp_log.h>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+static const char* TAG = "TaskMonitor";
+
+TaskMonitor::TaskMonitor() : SleepyThreaded(LogInterval, "TaskMonitor"){
+	start();
+}
+
+TaskMonitor::~TaskMonitor(){
+	stop();
+}
+
+void TaskMonitor::sleepyLoop(){
+	// The first run only sets the baseline for CPU shares
+	if(!primed){
+		getReport();
+		primed = true;
+		return;
+	}
+
+	format(getReport(), [](const char* line){
+		ESP_LOGI(TAG, "%s", line);
+	});
+}
+
+TaskMonitor::Report TaskMonitor::getReport(){
+	Report report{};
+	report.threads = Threaded::getStats();
+	report.jobs = Scheduler::getStats();
+
+#if configUSE_TRACE_FACILITY
+	std::lock_guard lock(mut);
+
+	// A few spare entries for tasks created in the meantime
+	std::vector<TaskStatus_t> status(uxTaskGetNumberOfTasks() + 4);
+	RunTime total = 0;
+	status.resize(uxTaskGetSystemState(status.data(), status.size(), &total));
+
+	const RunTime elapsed = total - lastTotalRunTime;
+	lastTotalRunTime = total;
+
+	std::unordered_map<TaskHandle_t, RunTime> runTime;
+	runTime.reserve(status.size());
+
+	std::array<TaskHandle_t, portNUM_PROCESSORS> idle{};
+	for(size_t i = 0; i < portNUM_PROCESSORS; ++i){
+		idle[i] = xTaskGetIdleTaskHandleForCPU(i);
+		report.coreLoad[i] = 0;
+	}
+
+	report.tasks.reserve(status.size());
+	for(const auto& task : status){
+		// Tasks that weren't around for the previous report get measured from zero
+		const RunTime previous = lastRunTime.contains(task.xHandle) ? lastRunTime.at(task.xHandle) : 0;
+		const RunTime ran = task.ulRunTimeCounter - previous;
+		runTime[task.xHandle] = task.ulRunTimeCounter;
+
+		TaskInfo info = {
+				.name = {},
+				.core = -1,
+				.priority = (uint8_t) task.uxCurrentPriority,
+				.stackFree = task.usStackHighWaterMark,
+				.stackSize = 0,
+				.cpu = elapsed == 0 ? 0 : 100.0f * (float) ran / (float) elapsed
+		};
+		strncpy(info.name, task.pcTaskName, sizeof(info.name) - 1);
+
+#if configTASKLIST_INCLUDE_COREID
+		if(task.xCoreID != tskNO_AFFINITY){
+			info.core = (int8_t) task.xCoreID;
+		}
+#endif
+
+		for(const auto& thread : report.threads){
+			if(thread.task != task.xHandle) continue;
+
+			info.stackSize = thread.stackSize;
+			info.core = thread.core;
+			break;
+		}
+
+		if(strcmp(task.pcTaskName, "Sched") == 0){
+			info.stackSize = Scheduler::WorkerStack;
+		}
+
+		for(size_t i = 0; i < portNUM_PROCESSORS; ++i){
+			if(task.xHandle != idle[i]) continue;
+
+			report.coreLoad[i] = std::clamp(100.0f - info.cpu, 0.0f, 100.0f);
+		}
+
+		report.tasks.push_back(info);
+	}
+
+	lastRunTime = std::move(runTime);
+
+	std::sort(report.tasks.begin(), report.tasks.end(), [](const TaskInfo& a, const TaskInfo& b){
+		return a.cpu > b.cpu;
+	});
+#endif
+
+	return report;
+}
+
+void TaskMonitor::format(const Report& report, const std::function<void(const char* line)>& out){
+	char line[160];
+
+	int len = snprintf(line, sizeof(line), "cores:");
+	for(size_t i = 0; i < portNUM_PROCESSORS; ++i){
+		len += snprintf(line + len, sizeof(line) - len, " %zu %.1f%%", i, report.coreLoad[i]);
+	}
+	out(line);
+
+	for(const auto& task : report.tasks){
+		if(task.stackSize != 0){
+			snprintf(line, sizeof(line), "task %-16s core %2d prio %2u cpu %5.1f%% stack %5lu of %5lu B free",
+					 task.name, task.core, task.priority, task.cpu, task.stackFree, task.stackSize);
+		}else{
+			snprintf(line, sizeof(line), "task %-16s core %2d prio %2u cpu %5.1f%% stack %5lu B free",
+					 task.name, task.core, task.priority, task.cpu, task.stackFree);
+		}
+		out(line);
+	}
+
+	static constexpr const char* BucketNames[Threaded::LoopStats::Buckets] = {
+			"<0.1ms", "<1ms", "<5ms", "<10ms", "<50ms", "<100ms", "<500ms", ">500ms"
+	};
+
+	for(const auto& thread : report.threads){
+		len = snprintf(line, sizeof(line), "loop %-16s %7lu loops %4lu missed max %7lu us |",
+					   thread.name, thread.loop.loops, thread.loop.missed, thread.loop.max);
+
+		for(size_t i = 0; i < Threaded::LoopStats::Buckets && len < (int) sizeof(line); ++i){
+			if(thread.loop.histogram[i] == 0) continue;
+			len += snprintf(line + len, sizeof(line) - len, " %s %lu", BucketNames[i], thread.loop.histogram[i]);
+		}
+		out(line);
+	}
+
+	for(const auto& job : report.jobs){
+		if(job.interval == 0){
+			snprintf(line, sizeof(line), "job %-16s on demand %6lu runs jitter avg %5lu max %6lu us busy avg %5lu max %6lu us cpu %.1f%%",
+					 job.name, job.runs, job.jitterAvg, job.jitterMax, job.busyAvg, job.busyMax, job.cpu);
+			out(line);
+			continue;
+		}
+
+		snprintf(line, sizeof(line), "job %-16s every %4lu ms jitter avg %5lu max %6lu us busy avg %5lu max %6lu us cpu %.1f%%",
+				 job.name, job.interval * portTICK_PERIOD_MS, job.jitterAvg, job.jitterMax, job.busyAvg, job.busyMax, job.cpu);
+		out(line);
+	}
+}
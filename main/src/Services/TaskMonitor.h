@@ -0,0 +1,65 @@
+#ifndef PERSE_ROVER_TASKMONITOR_H
+#define PERSE_ROVER_TASKMONITOR_H
+
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include "Util/Threaded.h"
+#include "Util/Scheduler.h"
+
+/**
+ * Collects the instrumentation of every task: FreeRTOS run time and stack high-water marks for all tasks,
+ * loop timings of every Threaded, and the Scheduler's job stats. A report is logged every LogInterval,
+ * and can be requested at any time (see TaskStatsPublisher).
+ *
+ * Run time stats need CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS,
+ * without them CPU shares read as 0.
+ */
+class TaskMonitor : private SleepyThreaded {
+public:
+	TaskMonitor();
+	~TaskMonitor() override;
+
+	struct TaskInfo {
+		char name[configMAX_TASK_NAME_LEN];
+		int8_t core; // -1 if not pinned
+		uint8_t priority;
+		uint32_t stackFree; // [B] lowest ever
+		uint32_t stackSize; // [B] 0 if not created by a Threaded or the Scheduler
+		float cpu; // [%] of one core
+	};
+
+	struct Report {
+		std::array<float, portNUM_PROCESSORS> coreLoad; // [%]
+		std::vector<TaskInfo> tasks;
+		std::vector<Threaded::Stats> threads;
+		std::vector<Scheduler::JobStats> jobs;
+	};
+
+	/**
+	 * CPU shares are measured since the previous report, whoever asked for it.
+	 */
+	Report getReport();
+
+	/**
+	 * Formats a report into text, one line at a time.
+	 */
+	static void format(const Report& report, const std::function<void(const char* line)>& out);
+
+private:
+	void sleepyLoop() override;
+
+	static constexpr uint32_t LogInterval = 30000; // [ms]
+	bool primed = false;
+
+	using RunTime = decltype(TaskStatus_t::ulRunTimeCounter);
+	std::unordered_map<TaskHandle_t, RunTime> lastRunTime;
+	RunTime lastTotalRunTime = 0;
+	std::mutex mut;
+
+};
+
+
+#endif //PERSE_ROVER_TASKMONITOR_H
@@ -1,6 +1,9 @@
 #include "UDPEmitter.h"
 #include <lwip/sockets.h>
 #include <esp_log.h>
+#include <cstring>
+#include <algorithm>
+#include "Util/CRC32.h"
 
 static const char* TAG = "UDPEmitter";
 
@@ -36,6 +39,7 @@ bool UDPEmitter::write(uint8_t* data, size_t count){
 			return false;
 		}else if(now < 0){
 			if(errno == EAGAIN || errno == EWOULDBLOCK){
+				retries++;
 				vTaskDelay(1);
 				continue;
 			}else{
@@ -48,3 +52,92 @@ bool UDPEmitter::write(uint8_t* data, size_t count){
 
 	return true;
 }
+
+uint32_t UDPEmitter::takeRetries(){
+	const uint32_t count = retries;
+	retries = 0;
+	return count;
+}
+
+bool UDPEmitter::writeFrame(const uint8_t* meta, size_t metaSize, const uint8_t* jpeg, size_t jpegSize){
+	const size_t size = metaSize + jpegSize;
+	if(size == 0) return true;
+
+	const size_t count = (size + FragmentPayload - 1) / FragmentPayload;
+	if(count > UINT16_MAX || metaSize > UINT16_MAX){
+		ESP_LOGW(TAG, "Frame too large to fragment, %zu B", size);
+		return false;
+	}
+
+	FeedFragmentHeader header = {
+			.magic = FeedFragmentMagic,
+			.version = FeedProtocolVersion,
+			.reserved = 0,
+			.frameID = frameID++,
+			.index = 0,
+			.count = (uint16_t) count,
+			.frameSize = (uint32_t) size,
+			.metaSize = (uint16_t) metaSize,
+			.crc = 0
+	};
+
+	for(size_t offset = 0; offset < size; offset += FragmentPayload, header.index++){
+		const size_t end = std::min(offset + FragmentPayload, size);
+
+		// Up to three parts: header, tail of the metadata, head of the JPEG
+		iovec parts[3] = { { &header, sizeof(header) } };
+		size_t partCount = 1;
+
+		if(offset < metaSize){
+			const size_t metaEnd = std::min(end, metaSize);
+			parts[partCount++] = { (void*) (meta + offset), metaEnd - offset };
+		}
+
+		if(end > metaSize){
+			const size_t jpegStart = std::max(offset, metaSize) - metaSize;
+			parts[partCount++] = { (void*) (jpeg + jpegStart), end - metaSize - jpegStart };
+		}
+
+		header.crc = 0;
+		for(size_t i = 1; i < partCount; ++i){
+			header.crc = crc32(parts[i].iov_base, parts[i].iov_len, header.crc);
+		}
+
+		if(!send(parts, partCount)){
+			ESP_LOGD(TAG, "Frame %u dropped at fragment %u/%u", header.frameID, header.index, header.count);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool UDPEmitter::send(iovec* parts, size_t count){
+	if(sock == -1){
+		ESP_LOGW(TAG, "Write, but socket not set-up");
+		return false;
+	}
+
+	const msghdr msg = {
+			.msg_name = &dest,
+			.msg_namelen = sizeof(dest),
+			.msg_iov = parts,
+			.msg_iovlen = (int) count,
+			.msg_control = nullptr,
+			.msg_controllen = 0,
+			.msg_flags = 0
+	};
+
+	while(true){
+		const int now = ::sendmsg(sock, &msg, 0);
+		if(now >= 0) return true;
+
+		if(errno == EAGAIN || errno == EWOULDBLOCK){
+			retries++;
+			vTaskDelay(1);
+			continue;
+		}
+
+		return false;
+	}
+}
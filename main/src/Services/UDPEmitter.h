@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <cstddef>
 #include <lwip/sockets.h>
+#include <sdkconfig.h>
+#include "FeedProtocol.h"
 
 class UDPEmitter {
 public:
@@ -12,11 +14,34 @@ public:
 
 	bool write(uint8_t* data, size_t count);
 
+	/**
+	 * Sends a whole frame as numbered, checksummed fragments (see FeedProtocol.h).
+	 * Fragments are gathered straight from both source buffers, nothing is copied.
+	 * If a fragment can't be sent, the rest of the frame is skipped since the receiver drops it anyway,
+	 * which gets the next frame out sooner.
+	 * @param meta Serialized DriveInfo without the camera frame
+	 * @param jpeg Camera frame
+	 * @return false if the frame didn't go out completely
+	 */
+	bool writeFrame(const uint8_t* meta, size_t metaSize, const uint8_t* jpeg, size_t jpegSize);
+
+	/**
+	 * @return Number of times the socket pushed back (EAGAIN) since the last call
+	 */
+	uint32_t takeRetries();
+
+	static constexpr size_t FragmentPayload = CONFIG_TCP_MSS - sizeof(FeedFragmentHeader);
+
 private:
 	int sock = -1;
 
 	sockaddr_in dest{};
 
+	uint16_t frameID = 0;
+	uint32_t retries = 0;
+
+	bool send(iovec* parts, size_t count);
+
 };
 
 
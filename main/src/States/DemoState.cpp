@@ -80,7 +80,7 @@ void DemoState::loop(){
 		if(evts.get(evt, 5)){
 			auto data = (Input::Data*) evt.data;
 			if(data->btn == Input::Pair && data->action == Input::Data::Press){
-				free(evt.data);
+				Events::release(evt.data);
 
 				auto stateMachine = (StateMachine*) Services.get(Service::StateMachine);
 				stateMachine->transition<PairState>();
@@ -89,7 +89,7 @@ void DemoState::loop(){
 			}
 		}
 
-		free(evt.data);
+		Events::release(evt.data);
 	}
 
 	if(millis() - actionTime < Actions[actionIndex].duration) return;
@@ -109,12 +109,12 @@ void DemoState::doAction(const DemoState::Action& action){
 	}else if(action.type == Action::Pinch){
 		arm.setLocally(ArmState{ .Pinch = (int8_t) action.pos });
 	}else if(action.type == Action::Move){
-		// motors.setLocally(MotorDriveState{ .DriveDirection = { .dir = (uint8_t) action.dir, .speed = 1.0f }});
+		// motors.setLocally(MotorDriveState::fromDriveDir({ .dir = (uint8_t) action.dir, .speed = 1.0f }));
 	}
 }
 
 void DemoState::stopAction(const DemoState::Action& action){
 	if(action.type == Action::Move){
-		motors.setLocally(MotorDriveState{ .DriveDirection = { 0, 0 }});
+		motors.setLocally(MotorDriveState{});
 	}
 }
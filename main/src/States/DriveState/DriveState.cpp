@@ -166,7 +166,7 @@ void DriveState::loop(){
 			}
 		}
 
-		free(event.data);
+		Events::release(event.data);
 	}
 
 	randSoundPlayer.loop();
@@ -63,7 +63,7 @@ void PairState::loop() {
 		}
 	}
 
-	free(event.data);
+	Events::release(event.data);
 }
 
 void PairState::startPair(){
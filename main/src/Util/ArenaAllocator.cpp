@@ -0,0 +1,145 @@
+#include "ArenaAllocator.h"
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+
+static const char* TAG = "ArenaAllocator";
+
+static constexpr uint32_t Freed = UINT32_MAX;
+
+ArenaAllocator::ArenaAllocator(size_t capacity) : capacity(capacity){
+	buf = (uint8_t*) heap_caps_malloc(capacity, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+	if(buf == nullptr){
+		ESP_LOGE(TAG, "Can't allocate %zu B arena, everything will go to the heap", capacity);
+	}
+}
+
+ArenaAllocator::~ArenaAllocator(){
+	heap_caps_free(buf);
+}
+
+void* ArenaAllocator::alloc(size_t size){
+	if(!isOwner()){
+		return malloc(size);
+	}
+
+	const size_t blockSize = sizeof(Header) + ((size + Align - 1) & ~(Align - 1));
+
+	if(buf == nullptr || blockSize > capacity - used){
+		fallbacks++;
+		ESP_LOGW(TAG, "Arena full, %zu B from the heap", size);
+		return malloc(size);
+	}
+
+	auto hdr = (Header*) (buf + used);
+	hdr->size = size;
+	hdr->prev = last == SIZE_MAX ? UINT32_MAX : last;
+
+	last = used;
+	used += blockSize;
+	peak = std::max(peak.load(), used.load());
+
+	return hdr + 1;
+}
+
+void* ArenaAllocator::calloc(size_t count, size_t size){
+	void* ptr = alloc(count * size);
+	if(ptr != nullptr){
+		memset(ptr, 0, count * size);
+	}
+
+	return ptr;
+}
+
+void* ArenaAllocator::realloc(void* ptr, size_t size){
+	if(ptr == nullptr) return alloc(size);
+	if(!owns(ptr)) return ::realloc(ptr, size);
+
+	Header* hdr = header(ptr);
+
+	// The most recent block can grow or shrink in place
+	const size_t offset = (uint8_t*) hdr - buf;
+	if(offset == last && isOwner()){
+		const size_t blockSize = sizeof(Header) + ((size + Align - 1) & ~(Align - 1));
+		if(blockSize <= capacity - offset){
+			hdr->size = size;
+			used = offset + blockSize;
+			peak = std::max(peak.load(), used.load());
+			return ptr;
+		}
+	}
+
+	void* moved = alloc(size);
+	if(moved == nullptr) return nullptr;
+
+	memcpy(moved, ptr, std::min<size_t>(hdr->size, size));
+	free(ptr);
+
+	return moved;
+}
+
+void ArenaAllocator::free(void* ptr){
+	if(ptr == nullptr) return;
+
+	if(!owns(ptr)){
+		::free(ptr);
+		return;
+	}
+
+	header(ptr)->size = Freed;
+
+	// Only the owner moves the top, anyone else's frees wait for reset()
+	if(!isOwner()) return;
+
+	// Unwind from the top while the most recent blocks are free
+	while(last != SIZE_MAX){
+		auto hdr = (Header*) (buf + last);
+		if(hdr->size != Freed) break;
+
+		used = last;
+		last = hdr->prev == UINT32_MAX ? SIZE_MAX : hdr->prev;
+	}
+}
+
+void ArenaAllocator::reset(){
+	used = 0;
+	last = SIZE_MAX;
+}
+
+void ArenaAllocator::open(){
+	owner = xTaskGetCurrentTaskHandle();
+}
+
+void ArenaAllocator::seal(){
+	owner = nullptr;
+}
+
+size_t ArenaAllocator::getCapacity() const{
+	return capacity;
+}
+
+size_t ArenaAllocator::getUsed() const{
+	return used;
+}
+
+size_t ArenaAllocator::getPeak() const{
+	return peak;
+}
+
+uint32_t ArenaAllocator::getFallbacks() const{
+	return fallbacks;
+}
+
+bool ArenaAllocator::owns(const void* ptr) const{
+	return buf != nullptr && ptr >= buf && ptr < buf + capacity;
+}
+
+ArenaAllocator::Header* ArenaAllocator::header(void* ptr) const{
+	return ((Header*) ptr) - 1;
+}
+
+bool ArenaAllocator::isOwner() const{
+	return owner != nullptr && owner == xTaskGetCurrentTaskHandle();
+}
@@ -0,0 +1,76 @@
+#ifndef PERSE_ROVER_ARENAALLOCATOR_H
+#define PERSE_ROVER_ARENAALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/**
+ * Bump allocator over a single buffer that is allocated once, at boot.
+ * Meant for libraries that allocate while setting up and rarely afterwards: allocation is a pointer bump,
+ * freeing the most recent block gives its space back, and other frees are only reclaimed by reset().
+ * Requests that don't fit fall back to the heap and are counted, so an undersized arena shows up in getFallbacks().
+ *
+ * The arena only serves the task that opened it, and only until it is sealed: open() starts a setup phase on the calling task,
+ * seal() ends it. Everything else, other tasks and anything allocated after seal(), goes to the heap, where it is freed for real,
+ * so objects that come and go during a session can't pile up in the arena. Any task can free anything, arena blocks freed
+ * by another task or after seal() are only reclaimed by reset(). Allocating and freeing must still be serialized by the caller,
+ * the getters can be called from any task.
+ */
+class ArenaAllocator {
+public:
+	explicit ArenaAllocator(size_t capacity);
+	~ArenaAllocator();
+
+	void* alloc(size_t size);
+	void* calloc(size_t count, size_t size);
+	void* realloc(void* ptr, size_t size);
+	void free(void* ptr);
+
+	/**
+	 * Drops everything allocated in the arena. Only valid once none of it is in use anymore.
+	 */
+	void reset();
+
+	/**
+	 * Hands the arena to the calling task, its allocations come from the arena until seal().
+	 */
+	void open();
+
+	/**
+	 * Ends the setup phase, from now on all allocations go to the heap. Blocks already in the arena stay valid.
+	 */
+	void seal();
+
+	size_t getCapacity() const;
+	size_t getUsed() const;
+	size_t getPeak() const;
+	uint32_t getFallbacks() const;
+
+private:
+	uint8_t* buf;
+	const size_t capacity;
+
+	std::atomic<size_t> used = 0;
+	std::atomic<size_t> peak = 0;
+	size_t last = SIZE_MAX; // offset of the most recent block's header, SIZE_MAX if none
+	std::atomic<uint32_t> fallbacks = 0;
+	TaskHandle_t owner = nullptr; // task allowed to allocate from the arena, nullptr while sealed
+
+	struct Header {
+		uint32_t size;
+		uint32_t prev; // offset of the previous block's header, lets free() unwind more than one block
+	};
+	static constexpr size_t Align = 8;
+	static_assert(sizeof(Header) % Align == 0);
+
+	bool owns(const void* ptr) const;
+	bool isOwner() const;
+	Header* header(void* ptr) const;
+
+};
+
+
+#endif //PERSE_ROVER_ARENAALLOCATOR_H
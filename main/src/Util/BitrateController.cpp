@@ -0,0 +1,125 @@
+#include "BitrateController.h"
+#include <algorithm>
+
+BitrateController::BitrateController(uint8_t resolutionLevels, uint32_t minInterval, uint32_t maxInterval) :
+		resolutionLevels(std::max<uint8_t>(resolutionLevels, 1)), minInterval(minInterval), maxInterval(maxInterval),
+		maxResolution(this->resolutionLevels - 1), resolution(maxResolution), interval(minInterval){
+
+}
+
+void BitrateController::setCeiling(uint8_t quality){
+	ceiling = quality;
+
+	// Operator asked for a new quality, start from it and let the loop correct if the link can't carry it
+	this->quality = std::max(ceiling, MinQuality);
+	cleanFrames = 0;
+}
+
+void BitrateController::setWeakLink(bool weak){
+	if(weak == weakLink) return;
+
+	weakLink = weak;
+	cleanFrames = 0;
+
+	if(weakLink){
+		backOff();
+	}
+}
+
+void BitrateController::setMaxResolution(uint8_t level){
+	maxResolution = std::min<uint8_t>(level, resolutionLevels - 1);
+	resolution = std::min(resolution, maxResolution);
+}
+
+void BitrateController::frameSent(size_t bytes, uint32_t sendTime, uint32_t retries){
+	if(resolutionFrames < MaxResolutionHold){
+		resolutionFrames++;
+	}
+
+	if(probing && resolutionFrames >= ProbeWindow){
+		probing = false;
+		upHold = ResolutionHold;
+	}
+
+	avgFrameBytes = avgFrameBytes == 0 ? (float) bytes : avgFrameBytes * 0.8f + (float) bytes * 0.2f;
+
+	const bool overTarget = getEstimatedRate() > getTargetRate();
+	const bool congested = retries > 0 || sendTime > interval;
+
+	if(congested || overTarget){
+		cleanFrames = 0;
+		backOff();
+		return;
+	}
+
+	if(++cleanFrames < RecoverFrames) return;
+	cleanFrames = 0;
+
+	if((float) getEstimatedRate() < (float) getTargetRate() * Headroom){
+		stepUp();
+	}
+}
+
+uint8_t BitrateController::getQuality() const{
+	return std::min(quality, ceiling);
+}
+
+uint8_t BitrateController::getResolution() const{
+	return resolution;
+}
+
+uint32_t BitrateController::getInterval() const{
+	return interval;
+}
+
+uint32_t BitrateController::getTargetRate() const{
+	return weakLink ? WeakTargetRate : TargetRate;
+}
+
+uint32_t BitrateController::getEstimatedRate() const{
+	return (uint32_t) (avgFrameBytes * 1000.0f / (float) interval);
+}
+
+void BitrateController::backOff(){
+	if(quality > MinQuality){
+		quality = std::max<int>(MinQuality, quality - std::max<int>(QualityStep, quality / 4));
+	}else if(resolution > 0 && resolutionFrames >= ResolutionHold){
+		setResolution(resolution - 1);
+		avgFrameBytes /= 2; // roughly half the pixels, don't wait for the average to catch up
+	}else{
+		interval = std::min(maxInterval, interval + interval / 2);
+	}
+}
+
+void BitrateController::stepUp(){
+	if(interval > minInterval){
+		interval = std::max(minInterval, interval - interval / 4);
+		return;
+	}
+
+	if(resolution < maxResolution){
+		if(resolutionFrames < upHold) return;
+
+		// Twice the pixels has to fit as well, or the next frame backs off right away.
+		// If it doesn't, the link can at least carry a better quality at this resolution.
+		if((float) getEstimatedRate() * 2 < (float) getTargetRate() * Headroom){
+			setResolution(resolution + 1);
+			avgFrameBytes *= 2;
+			return;
+		}
+	}
+
+	if(quality < ceiling){
+		quality = std::min<int>(ceiling, quality + 1);
+	}
+}
+
+void BitrateController::setResolution(uint8_t level){
+	if(level < resolution && probing){
+		upHold = std::min<uint16_t>(upHold * 2, MaxResolutionHold);
+	}
+
+	probing = level > resolution;
+	resolution = level;
+	resolutionFrames = 0;
+}
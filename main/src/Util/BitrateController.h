@@ -0,0 +1,92 @@
+#ifndef PERSE_ROVER_BITRATECONTROLLER_H
+#define PERSE_ROVER_BITRATECONTROLLER_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Closed-loop camera feed rate control. Picks JPEG quality, a resolution level and the frame interval
+ * to keep the feed at or below a target byte rate, backing off quickly on congestion and recovering slowly.
+ * Platform independent, fed with measurements by the caller, so it can be driven by a simulated link.
+ *
+ * Backing off lowers quality first, then resolution, then frame rate. Recovery goes in reverse: frame rate first,
+ * then resolution, then quality up to the ceiling set by the operator.
+ *
+ * Resolution steps are the expensive ones, since the camera has to switch frame size. A resolution is kept for at least
+ * ResolutionHold frames, frame rate takes up the slack meanwhile. A step up is only taken if the roughly doubled
+ * frame size would still fit under the target, otherwise quality goes up instead. A step up that has to be taken back
+ * within ProbeWindow doubles the wait before the next one, up to MaxResolutionHold, so a link that can't carry
+ * the larger resolution isn't probed every couple of seconds.
+ */
+class BitrateController {
+public:
+	/**
+	 * @param resolutionLevels Number of resolution steps, level 0 is the smallest
+	 */
+	BitrateController(uint8_t resolutionLevels, uint32_t minInterval, uint32_t maxInterval);
+
+	/**
+	 * Highest quality allowed, as requested by the operator. [0 - 30]
+	 */
+	void setCeiling(uint8_t quality);
+
+	/**
+	 * Lowers the target rate while the controller reports a weak signal.
+	 */
+	void setWeakLink(bool weak);
+
+	/**
+	 * Caps the resolution level, for example while the frames also have to be scanned.
+	 */
+	void setMaxResolution(uint8_t level);
+
+	/**
+	 * @param bytes Size of the frame that was sent
+	 * @param sendTime Time it took to send it, in milliseconds
+	 * @param retries Number of times the socket pushed back while sending it
+	 */
+	void frameSent(size_t bytes, uint32_t sendTime, uint32_t retries);
+
+	uint8_t getQuality() const;
+	uint8_t getResolution() const;
+	uint32_t getInterval() const;
+	uint32_t getTargetRate() const;
+	uint32_t getEstimatedRate() const;
+
+	static constexpr uint32_t TargetRate = 120 * 1024; // B/s
+	static constexpr uint32_t WeakTargetRate = 30 * 1024; // B/s
+
+private:
+	const uint8_t resolutionLevels;
+	const uint32_t minInterval;
+	const uint32_t maxInterval;
+
+	static constexpr uint8_t MinQuality = 1;
+	static constexpr uint8_t QualityStep = 2;
+	static constexpr uint8_t RecoverFrames = 10; // congestion-free frames before stepping up
+	static constexpr float Headroom = 0.8f; // step up only while below this share of the target
+	static constexpr uint16_t ResolutionHold = 40; // frames
+	static constexpr uint16_t MaxResolutionHold = ResolutionHold * 16; // frames
+	static constexpr uint16_t ProbeWindow = ResolutionHold * 2; // frames, a step up taken back within it didn't work out
+
+	uint8_t ceiling = 0;
+	bool weakLink = false;
+	uint8_t maxResolution;
+
+	uint8_t quality = 0;
+	uint8_t resolution = 0;
+	uint32_t interval;
+
+	float avgFrameBytes = 0;
+	uint8_t cleanFrames = 0;
+	uint16_t resolutionFrames = MaxResolutionHold; // since the last resolution step, saturates
+	uint16_t upHold = ResolutionHold; // frames before the next step up
+	bool probing = false; // last step was up, less than ProbeWindow ago
+
+	void backOff();
+	void stepUp();
+	void setResolution(uint8_t level);
+};
+
+
+#endif //PERSE_ROVER_BITRATECONTROLLER_H
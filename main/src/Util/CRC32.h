@@ -0,0 +1,31 @@
+#ifndef PERSE_ROVER_CRC32_H
+#define PERSE_ROVER_CRC32_H
+
+#include <cstdint>
+#include <cstddef>
+
+#ifdef ESP_PLATFORM
+#include <esp_rom_crc.h>
+#endif
+
+/**
+ * Standard CRC-32 (IEEE 802.3, same as zlib). Uses the ROM implementation on the ESP32
+ * and a bitwise fallback elsewhere, so receivers on other platforms get the same result.
+ */
+inline uint32_t crc32(const void* data, size_t size, uint32_t crc = 0){
+#ifdef ESP_PLATFORM
+	return esp_rom_crc32_le(crc, (const uint8_t*) data, size);
+#else
+	crc = ~crc;
+	auto bytes = (const uint8_t*) data;
+	for(size_t i = 0; i < size; ++i){
+		crc ^= bytes[i];
+		for(uint8_t bit = 0; bit < 8; ++bit){
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+	}
+	return ~crc;
+#endif
+}
+
+#endif //PERSE_ROVER_CRC32_H
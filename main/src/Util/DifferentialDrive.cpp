@@ -0,0 +1,44 @@
+#include "DifferentialDrive.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+DifferentialDrive::Wheels DifferentialDrive::mix(float linear, float angular){
+	linear = std::clamp(linear, -1.0f, 1.0f);
+	angular = std::clamp(angular, -1.0f, 1.0f);
+
+	float left = linear - angular;
+	float right = linear + angular;
+
+	const float peak = std::max({ 1.0f, std::abs(left), std::abs(right) });
+	left /= peak;
+	right /= peak;
+
+	return { (int8_t) std::lround(left * 100.0f), (int8_t) std::lround(right * 100.0f) };
+}
+
+DifferentialDrive::Motion DifferentialDrive::fromDirection(uint8_t dir, float speed){
+	// Left and right wheel power for each direction, clockwise from forward
+	static constexpr std::pair<float, float> Wheels[8] = {
+			{ 1.0f, 1.0f },
+			{ 1.0f, 0.3f },
+			{ 1.0f, -1.0f },
+			{ -1.0f, -0.3f },
+			{ -1.0f, -1.0f },
+			{ -0.3f, -1.0f },
+			{ -1.0f, 1.0f },
+			{ 0.3f, 1.0f }
+	};
+
+	if(dir >= 8){
+		return { 0, 0 };
+	}
+
+	const auto [left, right] = Wheels[dir];
+	speed = std::clamp(speed, 0.0f, 1.0f);
+
+	return {
+			.linear = (left + right) / 2.0f * speed,
+			.angular = (right - left) / 2.0f * speed
+	};
+}
@@ -0,0 +1,37 @@
+#ifndef PERSE_ROVER_DIFFERENTIALDRIVE_H
+#define PERSE_ROVER_DIFFERENTIALDRIVE_H
+
+#include <cstdint>
+
+/**
+ * Mixing between the rover's motion and its two wheels. Platform independent, so the mapping can be checked on the host.
+ * Motion is linear and angular speed, both [-1, 1], forward and turning left (counter-clockwise) are positive.
+ * Wheel power is [-100, 100], as taken by MotorControl.
+ */
+class DifferentialDrive {
+public:
+	struct Motion {
+		float linear;
+		float angular;
+	};
+
+	struct Wheels {
+		int8_t left;
+		int8_t right;
+	};
+
+	/**
+	 * Clamps both inputs to [-1, 1] and mixes them into wheel power. When a wheel would go past full power,
+	 * both wheels are scaled down together, so the turn radius is kept.
+	 */
+	static Wheels mix(float linear, float angular);
+
+	/**
+	 * Motion for one of the eight DriveDir directions, clockwise from forward, which mixes back into the wheel powers
+	 * these directions have always had, scaled by speed [0, 1]. Anything past the eighth direction stops.
+	 */
+	static Motion fromDirection(uint8_t dir, float speed);
+};
+
+
+#endif //PERSE_ROVER_DIFFERENTIALDRIVE_H
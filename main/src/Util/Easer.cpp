@@ -1,23 +1,10 @@
 #include "Easer.h"
 
-QueueHandle_t  Easer::easerQueue = xQueueCreate(24, sizeof(Easer*));
-ThreadedClosure Easer::easerTask = ThreadedClosure([](){
-	Easer* ptr;
-	if(!xQueueReceive(Easer::easerQueue, &ptr, portMAX_DELAY)) return;
+Easer::Easer(const char* name, int32_t step, uint32_t period, std::function<void(int32_t)> cb) : step(step), period(period), cb(std::move(cb)),
+																								 job(name, 0, [this](){ process(); }){}
 
-	if(ptr == nullptr) return;
-
-	ptr->process();
-
-}, "easerTask", 3 * 1024);
-
-//TODO - abort task and clear queue when last Easer instance is destroyed
-
-Easer::Easer(const char* name, int32_t step, uint32_t period, std::function<void(int32_t)> cb) : timer(name, period, [this](){ timerFn(); }), step(step),
-																								 cb(std::move(cb)){
-	if(!easerTask.running()){
-		easerTask.start();
-	}
+Easer::~Easer(){
+	Scheduler::remove(&job);
 }
 
 void Easer::set(int32_t val){
@@ -31,17 +18,15 @@ void Easer::set(int32_t val){
 	}
 
 	if(current != target){
-		timer.reset();
+		Scheduler::trigger(&job, pdMS_TO_TICKS(period));
 	}
 }
 
-void IRAM_ATTR Easer::timerFn(){
-	BaseType_t priority = pdFALSE;
-	Easer* ptr = this;
-	xQueueSendFromISR(easerQueue, &ptr, &priority);
-}
-
 void Easer::process(){
+	const int32_t current = this->current;
+	const int32_t target = this->target;
+	if(current == target) return; // set back while the step was pending
+
 	int32_t newCurrent = current;
 	if(target > current){
 		newCurrent += step;
@@ -50,14 +35,13 @@ void Easer::process(){
 	}
 
 	if((target > current && newCurrent > target) || (target < current && newCurrent < target)){
-		current = target;
-	}else{
-		current = newCurrent;
+		newCurrent = target;
 	}
 
-	cb(current);
+	this->current = newCurrent;
+	cb(newCurrent);
 
-	if(current != target){
-		timer.start();
+	if(newCurrent != this->target){
+		Scheduler::trigger(&job, pdMS_TO_TICKS(period));
 	}
 }
@@ -2,31 +2,32 @@
 #define PERSE_ROVER_EASER_H
 
 
-#include "Periph/Timer.h"
-#include "Threaded.h"
-
+#include <atomic>
+#include <functional>
+#include "Util/Scheduler.h"
+
+/**
+ * Steps a value towards its target, one step every period [ms]. The steps run as a triggered Scheduler job,
+ * so an Easer costs neither a timer nor a task while it's idle.
+ */
 class Easer {
 public:
 	Easer(const char* name, int32_t step, uint32_t period, std::function<void(int32_t)> cb);
+	~Easer();
 
 	void set(int32_t target);
 
 private:
-	Timer timer;
-
 	int32_t step;
 	uint32_t period;
 	std::function<void(int32_t)> cb;
 
-	void timerFn();
-
 	bool isSet = false;
-	int32_t current;
-	int32_t target;
+	std::atomic<int32_t> current = 0;
+	std::atomic<int32_t> target = 0;
 
 	void process();
-	static QueueHandle_t easerQueue; //queue of ptrs that need to be processed
-	static ThreadedClosure easerTask;
+	Scheduler::Job job;
 
 };
 
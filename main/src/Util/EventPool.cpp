@@ -0,0 +1,98 @@
+#include "EventPool.h"
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <cstddef>
+
+EventPool::EventPool() : freeHead(0){
+	for(uint16_t i = 0; i < BlockCount; ++i){
+		blocks[i].refs = 0;
+		blocks[i].next = (i + 1 < BlockCount) ? i + 1 : None;
+	}
+}
+
+void* EventPool::alloc(const void* data, size_t size, uint16_t refs){
+	if(size == 0 || refs == 0) return nullptr;
+
+	if(size <= BlockSize){
+		if(Block* block = pop()){
+			memcpy(block->data, data, size);
+			block->refs.store(refs, std::memory_order_release);
+			return block->data;
+		}
+	}
+
+	fallbacks++;
+
+	auto header = (HeapHeader*) malloc(HeapOffset + size);
+	if(header == nullptr) return nullptr;
+
+	new(header) HeapHeader{ refs };
+	uint8_t* payload = (uint8_t*) header + HeapOffset;
+	memcpy(payload, data, size);
+
+	return payload;
+}
+
+void EventPool::release(void* payload){
+	if(payload == nullptr) return;
+
+	if(owns(payload)){
+		auto block = (Block*) ((uint8_t*) payload - offsetof(Block, data));
+		if(block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+			push(block);
+		}
+		return;
+	}
+
+	auto header = (HeapHeader*) ((uint8_t*) payload - HeapOffset);
+	if(header->refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+		free(header);
+	}
+}
+
+uint32_t EventPool::getFallbacks() const{
+	return fallbacks;
+}
+
+uint16_t EventPool::getFree() const{
+	return freeCount;
+}
+
+EventPool::Block* EventPool::pop(){
+	uint32_t head = freeHead.load(std::memory_order_acquire);
+
+	while(true){
+		const uint16_t index = head & 0xFFFF;
+		if(index == None) return nullptr;
+
+		const uint32_t tag = (head >> 16) + 1;
+		const uint32_t next = (tag << 16) | blocks[index].next;
+
+		if(freeHead.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_acquire)){
+			freeCount--;
+			return &blocks[index];
+		}
+	}
+}
+
+void EventPool::push(Block* block){
+	const uint16_t index = block - blocks;
+	uint32_t head = freeHead.load(std::memory_order_acquire);
+
+	while(true){
+		block->next = head & 0xFFFF;
+
+		const uint32_t tag = (head >> 16) + 1;
+		const uint32_t next = (tag << 16) | index;
+
+		if(freeHead.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_acquire)){
+			freeCount++;
+			return;
+		}
+	}
+}
+
+bool EventPool::owns(const void* payload) const{
+	return payload >= (const void*) blocks && payload < (const void*) (blocks + BlockCount);
+}
@@ -0,0 +1,59 @@
+#ifndef PERSE_ROVER_EVENTPOOL_H
+#define PERSE_ROVER_EVENTPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+
+/**
+ * Fixed pool of refcounted event payloads. A posted event is copied once into a block that all subscribers share,
+ * and the block returns to the pool when the last subscriber releases it.
+ * Allocation and release are lock-free, so posting never takes a lock or touches the heap in the common case.
+ * Payloads larger than BlockSize, or posted while the pool is exhausted, fall back to a refcounted heap allocation.
+ */
+class EventPool {
+public:
+	EventPool();
+
+	/**
+	 * @param refs Number of release() calls it takes to free the payload
+	 * @return Copy of data, nullptr if size or refs is 0
+	 */
+	void* alloc(const void* data, size_t size, uint16_t refs);
+
+	void release(void* payload);
+
+	uint32_t getFallbacks() const;
+	uint16_t getFree() const;
+
+	static constexpr size_t BlockSize = 32;
+	static constexpr uint16_t BlockCount = 64;
+
+private:
+	struct Block {
+		std::atomic<uint16_t> refs;
+		uint16_t next;
+		alignas(8) uint8_t data[BlockSize];
+	};
+
+	struct HeapHeader {
+		std::atomic<uint16_t> refs;
+	};
+	static constexpr size_t HeapOffset = 8; // payload follows the header, kept 8-byte aligned
+
+	Block blocks[BlockCount];
+
+	static constexpr uint16_t None = UINT16_MAX;
+
+	// Index of the first free block in the low half, ABA tag in the high half
+	std::atomic<uint32_t> freeHead;
+	std::atomic<uint16_t> freeCount = BlockCount;
+	std::atomic<uint32_t> fallbacks = 0;
+
+	Block* pop();
+	void push(Block* block);
+	bool owns(const void* payload) const;
+};
+
+
+#endif //PERSE_ROVER_EVENTPOOL_H
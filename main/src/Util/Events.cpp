@@ -1,13 +1,16 @@
 #include "Events.h"
 #include <cstring>
+#include <array>
+#include <esp_log.h>
 
-std::unordered_map<Facility, std::unordered_set<EventQueue*>> Events::queues;
-std::mutex Events::mut;
+std::unordered_map<Facility, std::unordered_map<EventQueue*, Events::TopicMask>> Events::queues;
+std::shared_mutex Events::mut;
+EventPool Events::pool;
 
-void Events::listen(Facility facility, EventQueue* queue){
+void Events::listen(Facility facility, EventQueue* queue, TopicMask topics){
 	std::lock_guard lock(mut);
 
-	queues[facility].insert(queue);
+	queues[facility][queue] |= topics;
 }
 
 void Events::unlisten(EventQueue* queue){
@@ -18,25 +21,47 @@ void Events::unlisten(EventQueue* queue){
 	}
 }
 
-void Events::post(Facility facility, const void* data, size_t size){
-	std::unique_lock lock(mut);
+void Events::post(Facility facility, const void* data, size_t size, uint8_t topic){
+	std::array<EventQueue*, MaxSubscribers> subs;
+	size_t count = 0;
+
+	// Held until every subscriber got the event, posts run side by side but unlisten() waits for them
+	std::shared_lock lock(mut);
 
 	auto pair = queues.find(facility);
 	if(pair == queues.end()) return;
 
-	const std::unordered_set<EventQueue*> subs = pair->second;
-	lock.unlock();
+	const TopicMask bit = topicBit(topic);
+
+	for(const auto& [queue, topics] : pair->second){
+		if((topics & bit) == 0) continue;
 
-	for(const auto queue : subs){
-		void* qData = nullptr;
-		if(size != 0){
-			qData = malloc(size);
-			memcpy(qData, data, size);
+		if(count == MaxSubscribers){
+			ESP_LOGW("Events", "More than %zu subscribers on facility %d", MaxSubscribers, (int) facility);
+			break;
+		}
+		subs[count++] = queue;
+	}
+
+	if(count == 0) return;
+
+	void* payload = pool.alloc(data, size, count);
+
+	for(size_t i = 0; i < count; ++i){
+		if(!subs[i]->post(facility, payload)){
+			release(payload);
 		}
-		queue->post(facility, qData);
 	}
 }
 
+void Events::release(void* data){
+	pool.release(data);
+}
+
+const EventPool& Events::getPool(){
+	return pool;
+}
+
 
 EventQueue::EventQueue(size_t count){
 	queue = xQueueCreate(count, sizeof(InternalEvent));
@@ -68,17 +93,27 @@ bool EventQueue::post(Facility facility, void* data){
 			.killPill = false
 	};
 
-	return xQueueSend(queue, &event, 0) == pdTRUE;
+	if(xQueueSend(queue, &event, 0) != pdTRUE) return false;
+
+	if(postHook){
+		postHook();
+	}
+
+	return true;
 }
 
 void EventQueue::reset(){
 	while(uxQueueMessagesWaiting(queue) > 0){
 		Event evt = {};
 		get(evt, 0);
-		free(evt.data);
+		Events::release(evt.data);
 	}
 }
 
+void EventQueue::setPostHook(std::function<void()> hook){
+	postHook = std::move(hook);
+}
+
 void EventQueue::unblock(){
 	const InternalEvent event = {
 			.killPill = true
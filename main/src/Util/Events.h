@@ -7,6 +7,9 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <mutex>
+#include <shared_mutex>
+#include <functional>
+#include "EventPool.h"
 
 enum class Facility { WiFi, Comm, TCP, Pair, Input, Battery, Feed, Modules };
 
@@ -15,13 +18,68 @@ struct Event {
 	void* data;
 };
 
+/**
+ * Ties an event payload type to its facility and topic, for the typed listen() and post().
+ * Specialized next to the payload type, with a static constexpr Facility facility
+ * and a static uint8_t topic(const T&) picking the topic of each posted event.
+ */
+template<typename T>
+struct EventTraits;
+
 class EventQueue;
 class Events {
 public:
-	static void listen(Facility facility, EventQueue* queue);
+	/**
+	 * Topics narrow a facility down, so a queue is only woken by the events it cares about,
+	 * for example Comm events by their CommType. Events posted without a topic go to every listener.
+	 * Only topics below MaxTopics can be told apart, anything above is treated as NoTopic on both ends:
+	 * posted, it goes to every listener, listened to, it receives everything.
+	 */
+	using TopicMask = uint64_t;
+	static constexpr TopicMask AllTopics = ~0ULL;
+	static constexpr uint8_t NoTopic = UINT8_MAX;
+	static constexpr uint8_t MaxTopics = 64;
+
+	static constexpr TopicMask topicBit(uint8_t topic){
+		return topic < MaxTopics ? (1ULL << topic) : AllTopics;
+	}
+
+	template<typename... Ts>
+	static constexpr TopicMask topics(Ts... topics){
+		return (topicBit((uint8_t) topics) | ... | 0ULL);
+	}
+
+	/**
+	 * Listening to the same facility again adds the topics to the ones already listened to.
+	 */
+	static void listen(Facility facility, EventQueue* queue, TopicMask topics = AllTopics);
+
+	/**
+	 * Waits for posts already delivering to finish, so once it returns the queue and its post hook aren't touched anymore.
+	 * Not to be called from a post hook.
+	 */
 	static void unlisten(EventQueue* queue);
 
-	static void post(Facility facility, const void* data, size_t size);
+	template<typename T, auto... Topics>
+	static void listen(EventQueue* queue){
+		if constexpr(sizeof...(Topics) == 0){
+			listen(EventTraits<T>::facility, queue);
+		}else{
+			static_assert(((static_cast<uint8_t>(Topics) < MaxTopics) && ...), "Topic doesn't fit in a TopicMask");
+			listen(EventTraits<T>::facility, queue, topics(Topics...));
+		}
+	}
+
+	/**
+	 * Copies data once into a pooled payload shared by all subscribers.
+	 * Every received Event::data has to be handed back with release().
+	 */
+	static void post(Facility facility, const void* data, size_t size, uint8_t topic = NoTopic);
+
+	template <typename T>
+	static void post(const T& data){
+		post(EventTraits<T>::facility, &data, sizeof(T), EventTraits<T>::topic(data));
+	}
 
 	template <typename T>
 	static void post(Facility facility, const T& data){
@@ -33,9 +91,19 @@ public:
 		post(facility, data, sizeof(T));
 	}
 
+	static void release(void* data);
+
+	/**
+	 * Payload pool shared by all facilities, for monitoring its use
+	 */
+	static const EventPool& getPool();
+
 private:
-	static std::unordered_map<Facility, std::unordered_set<EventQueue*>> queues;
-	static std::mutex mut;
+	static std::unordered_map<Facility, std::unordered_map<EventQueue*, TopicMask>> queues;
+	static std::shared_mutex mut; // shared while a post is delivering, listeners change exclusively
+	static EventPool pool;
+
+	static constexpr size_t MaxSubscribers = 16;
 
 };
 
@@ -49,8 +117,15 @@ public:
 
 	void unblock();
 
+	/**
+	 * Called on the posting task after every event that made it into the queue, for listeners that
+	 * drain the queue from a triggered Scheduler job instead of blocking on get(). Set it before listening.
+	 */
+	void setPostHook(std::function<void()> hook);
+
 private:
 	QueueHandle_t queue;
+	std::function<void()> postHook;
 
 	struct InternalEvent {
 		Event evt;
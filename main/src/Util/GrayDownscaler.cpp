@@ -0,0 +1,168 @@
+#include "GrayDownscaler.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <esp_attr.h>
+
+// RGB565 channels expanded to 8 bits, channel * 255 / max
+static constexpr auto Expand5 = [](){
+	std::array<uint16_t, 32> lut{};
+	for(uint16_t i = 0; i < 32; ++i){
+		lut[i] = (i * 255) / 31;
+	}
+	return lut;
+}();
+
+static constexpr auto Expand6 = [](){
+	std::array<uint16_t, 64> lut{};
+	for(uint16_t i = 0; i < 64; ++i){
+		lut[i] = (i * 255) / 63;
+	}
+	return lut;
+}();
+
+// (r + g + b) / 3 for sums up to 3 * 255, exact
+static inline uint8_t div3(uint32_t sum){
+	return (sum * 683) >> 11;
+}
+
+GrayDownscaler::GrayDownscaler(uint16_t srcWidth, uint16_t srcHeight, float scale) : srcWidth(srcWidth), srcHeight(srcHeight),
+		dstWidth(std::max(1L, std::lround(srcWidth * scale))), dstHeight(std::max(1L, std::lround(srcHeight * scale))),
+		xTaps(calcTaps(srcWidth, dstWidth, scale)), yTaps(calcTaps(srcHeight, dstHeight, scale)){
+	for(auto& line : lines){
+		line.resize(srcWidth);
+	}
+}
+
+uint16_t GrayDownscaler::getWidth() const{
+	return dstWidth;
+}
+
+uint16_t GrayDownscaler::getHeight() const{
+	return dstHeight;
+}
+
+uint8_t GrayDownscaler::luma(uint16_t rgb565){
+	const uint8_t r = (rgb565 & 0xF800) >> 11;
+	const uint8_t g = (rgb565 & 0x07E0) >> 5;
+	const uint8_t b = (rgb565 & 0x001F);
+
+	return div3(Expand5[r] + Expand6[g] + Expand5[b]);
+}
+
+void GrayDownscaler::process(const uint8_t* rgb565, uint8_t* out){
+	run<true>(rgb565, out);
+}
+
+void GrayDownscaler::processScalar(const uint8_t* rgb565, uint8_t* out){
+	run<false>(rgb565, out);
+}
+
+std::vector<GrayDownscaler::Tap> GrayDownscaler::calcTaps(uint16_t srcSize, uint16_t dstSize, float scale){
+	std::vector<Tap> taps(dstSize);
+
+	// Same sampling grid as cv::resize with INTER_LINEAR: pixel centers are aligned
+	const float invScale = 1.0f / scale;
+	for(uint16_t i = 0; i < dstSize; ++i){
+		float pos = ((float) i + 0.5f) * invScale - 0.5f;
+		int index = (int) std::floor(pos);
+		float frac = pos - (float) index;
+
+		if(index < 0){
+			index = 0;
+			frac = 0;
+		}
+
+		// Keep index + 1 inside the source, the last pixel is reached with a zero weight on the first tap
+		if(index >= srcSize - 1){
+			index = std::max(srcSize - 2, 0);
+			frac = srcSize > 1 ? 1.0f : 0.0f;
+		}
+
+		const uint16_t weight = std::lround((1.0f - frac) * CoefOne);
+		taps[i] = { (uint16_t) index, weight };
+	}
+
+	return taps;
+}
+
+template<bool Wide>
+void GrayDownscaler::run(const uint8_t* rgb565, uint8_t* out){
+	lineRows = { -1, -1 };
+
+	const uint16_t lastRow = srcHeight - 1;
+
+	for(uint16_t dy = 0; dy < dstHeight; ++dy){
+		const Tap& yTap = yTaps[dy];
+		const uint8_t* top = getLine<Wide>(rgb565, yTap.index);
+		const uint8_t* bottom = getLine<Wide>(rgb565, std::min<uint16_t>(yTap.index + 1, lastRow));
+
+		const uint32_t wTop = yTap.weight;
+		const uint32_t wBottom = CoefOne - wTop;
+
+		uint8_t* dst = out + dy * dstWidth;
+		for(uint16_t dx = 0; dx < dstWidth; ++dx){
+			const Tap& xTap = xTaps[dx];
+			const uint32_t wLeft = xTap.weight;
+			const uint32_t wRight = CoefOne - wLeft;
+			const uint16_t x = xTap.index;
+
+			const uint32_t upper = top[x] * wLeft + top[x + 1] * wRight;
+			const uint32_t lower = bottom[x] * wLeft + bottom[x + 1] * wRight;
+
+			dst[dx] = (upper * wTop + lower * wBottom + (1u << (2 * CoefBits - 1))) >> (2 * CoefBits);
+		}
+	}
+}
+
+template<bool Wide>
+const uint8_t* GrayDownscaler::getLine(const uint8_t* rgb565, uint16_t row){
+	for(uint8_t i = 0; i < 2; ++i){
+		if(lineRows[i] == row){
+			return lines[i].data();
+		}
+	}
+
+	// Rows are requested in ascending order, the lower cached row is never needed again
+	const uint8_t slot = lineRows[0] < lineRows[1] ? 0 : 1;
+	lineRows[slot] = row;
+
+	const uint8_t* src = rgb565 + (size_t) row * srcWidth * 2;
+	if(Wide){
+		convertLineWide(src, lines[slot].data());
+	}else{
+		convertLineScalar(src, lines[slot].data());
+	}
+
+	return lines[slot].data();
+}
+
+void GrayDownscaler::convertLineScalar(const uint8_t* src, uint8_t* dst) const{
+	for(uint16_t i = 0; i < srcWidth; ++i){
+		const uint16_t color = (src[2 * i] << 8) | src[2 * i + 1];
+		dst[i] = luma(color);
+	}
+}
+
+void IRAM_ATTR GrayDownscaler::convertLineWide(const uint8_t* src, uint8_t* dst) const{
+	uint16_t i = 0;
+
+	// Two pixels per word. Loaded little-endian, each 16-bit lane holds one pixel with its bytes swapped,
+	// so the channels are picked out of both lanes at once without swapping first.
+	for(; i + 1 < srcWidth; i += 2){
+		uint32_t word;
+		memcpy(&word, src + 2 * i, sizeof(word));
+
+		const uint32_t r = (word >> 3) & 0x001F001F;
+		const uint32_t g = ((word & 0x00070007) << 3) | ((word >> 13) & 0x00070007);
+		const uint32_t b = (word >> 8) & 0x001F001F;
+
+		dst[i] = div3(Expand5[r & 0xFFFF] + Expand6[g & 0xFFFF] + Expand5[b & 0xFFFF]);
+		dst[i + 1] = div3(Expand5[r >> 16] + Expand6[g >> 16] + Expand5[b >> 16]);
+	}
+
+	for(; i < srcWidth; ++i){
+		const uint16_t color = (src[2 * i] << 8) | src[2 * i + 1];
+		dst[i] = luma(color);
+	}
+}
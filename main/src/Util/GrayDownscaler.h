@@ -0,0 +1,68 @@
+#ifndef PERSE_ROVER_GRAYDOWNSCALER_H
+#define PERSE_ROVER_GRAYDOWNSCALER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <vector>
+
+/**
+ * Converts a big-endian RGB565 frame into a downscaled 8-bit grayscale image in a single pass.
+ * Byte swap, luma conversion and bilinear downsampling are fused, so no full-size gray buffer is ever built.
+ * Only the two source rows needed for the current output row are converted, and each source row is converted once.
+ */
+class GrayDownscaler {
+public:
+	GrayDownscaler(uint16_t srcWidth, uint16_t srcHeight, float scale);
+
+	uint16_t getWidth() const;
+	uint16_t getHeight() const;
+
+	/**
+	 * Fast path. Reads two pixels per 32-bit load and unpacks both channels side by side.
+	 * @param rgb565 Source frame, srcWidth * srcHeight pixels, byte order as delivered by the camera
+	 * @param out Destination, getWidth() * getHeight() bytes, rows packed without padding
+	 */
+	void process(const uint8_t* rgb565, uint8_t* out);
+
+	/**
+	 * Portable reference path, one pixel at a time. Output is identical to process().
+	 */
+	void processScalar(const uint8_t* rgb565, uint8_t* out);
+
+	static uint8_t luma(uint16_t rgb565);
+
+private:
+	const uint16_t srcWidth;
+	const uint16_t srcHeight;
+	const uint16_t dstWidth;
+	const uint16_t dstHeight;
+
+	static constexpr uint8_t CoefBits = 11;
+	static constexpr uint16_t CoefOne = 1 << CoefBits;
+
+	struct Tap {
+		uint16_t index; // first source pixel, the second one is index + 1
+		uint16_t weight; // weight of the first source pixel, [0 - CoefOne]
+	};
+
+	std::vector<Tap> xTaps;
+	std::vector<Tap> yTaps;
+
+	std::array<std::vector<uint8_t>, 2> lines;
+	std::array<int32_t, 2> lineRows = { -1, -1 };
+
+	static std::vector<Tap> calcTaps(uint16_t srcSize, uint16_t dstSize, float scale);
+
+	template<bool Wide>
+	void run(const uint8_t* rgb565, uint8_t* out);
+
+	template<bool Wide>
+	const uint8_t* getLine(const uint8_t* rgb565, uint16_t row);
+
+	void convertLineScalar(const uint8_t* src, uint8_t* dst) const;
+	void convertLineWide(const uint8_t* src, uint8_t* dst) const;
+};
+
+
+#endif //PERSE_ROVER_GRAYDOWNSCALER_H
@@ -0,0 +1,81 @@
+#include "JpegArena.h"
+#include <img_converters.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <cstring>
+#include <algorithm>
+
+static const char* TAG = "JpegArena";
+
+JpegArena::JpegArena(size_t capacity){
+	reserve(capacity);
+}
+
+JpegArena::~JpegArena(){
+	free(buf);
+}
+
+bool JpegArena::encode(const camera_fb_t* frame, uint8_t quality){
+	used = 0;
+	overflow = false;
+
+	if(frame == nullptr || frame->buf == nullptr || frame->len == 0){
+		return false;
+	}
+
+	if(!fmt2jpg_cb(frame->buf, frame->len, frame->width, frame->height, frame->format, quality, &JpegArena::write, this) || overflow){
+		used = 0;
+		return false;
+	}
+
+	return true;
+}
+
+uint8_t* JpegArena::data() const{
+	return buf;
+}
+
+size_t JpegArena::size() const{
+	return used;
+}
+
+size_t JpegArena::write(void* arg, size_t index, const void* data, size_t len){
+	auto arena = static_cast<JpegArena*>(arg);
+
+	if(data == nullptr){ // encoder signals the end of the stream
+		return 0;
+	}
+
+	if(arena->overflow || !arena->reserve(index + len)){
+		arena->overflow = true;
+		return 0;
+	}
+
+	memcpy(arena->buf + index, data, len);
+	arena->used = std::max(arena->used, index + len);
+
+	return len;
+}
+
+bool JpegArena::reserve(size_t size){
+	if(size <= capacity) return true;
+
+	if(size > MaxCapacity){
+		ESP_LOGW(TAG, "JPEG frame larger than %zu B", MaxCapacity);
+		return false;
+	}
+
+	// Grow in big steps so it settles after the first few frames
+	const size_t newCapacity = std::min(std::max(size, capacity * 2), MaxCapacity);
+
+	auto newBuf = (uint8_t*) heap_caps_realloc(buf, newCapacity, MALLOC_CAP_SPIRAM);
+	if(newBuf == nullptr){
+		ESP_LOGE(TAG, "Can't grow to %zu B", newCapacity);
+		return false;
+	}
+
+	buf = newBuf;
+	capacity = newCapacity;
+
+	return true;
+}
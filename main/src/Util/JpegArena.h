@@ -0,0 +1,40 @@
+#ifndef PERSE_ROVER_JPEGARENA_H
+#define PERSE_ROVER_JPEGARENA_H
+
+#include <cstdint>
+#include <cstddef>
+#include <esp_camera.h>
+
+/**
+ * Reusable JPEG output buffer in PSRAM. Frames are encoded straight into it, instead of frame2jpg
+ * allocating a fresh output buffer for every frame. Grows on demand and never shrinks.
+ */
+class JpegArena {
+public:
+	explicit JpegArena(size_t capacity = DefaultCapacity);
+	virtual ~JpegArena();
+
+	/**
+	 * Encodes the frame, replacing the previous contents.
+	 * @return false if encoding failed or the output would be larger than MaxCapacity
+	 */
+	bool encode(const camera_fb_t* frame, uint8_t quality);
+
+	uint8_t* data() const;
+	size_t size() const;
+
+private:
+	static constexpr size_t DefaultCapacity = 16 * 1024;
+	static constexpr size_t MaxCapacity = 128 * 1024;
+
+	uint8_t* buf = nullptr;
+	size_t capacity = 0;
+	size_t used = 0;
+	bool overflow = false; // encoder doesn't stop on a failed write, so failures are tracked here
+
+	static size_t write(void* arg, size_t index, const void* data, size_t len);
+	bool reserve(size_t size);
+};
+
+
+#endif //PERSE_ROVER_JPEGARENA_H
@@ -0,0 +1,81 @@
+#ifndef PERSE_ROVER_LATESTREADING_H
+#define PERSE_ROVER_LATESTREADING_H
+
+#include <cstdint>
+#include <mutex>
+#include <algorithm>
+
+/**
+ * Holds the latest reading of a sensor for a publisher. Readings are reported from any task, and handed on
+ * at most once per interval and only if a new one came in since the last hand-off.
+ * Platform independent, the caller passes the time in.
+ */
+template<typename T>
+class LatestReading {
+public:
+	/**
+	 * @param interval Minimum time between two hand-offs [us], 0 hands on every reading
+	 * @param idlePoll How often a due reading is checked for once the interval has passed [us]
+	 */
+	LatestReading(int64_t interval, int64_t idlePoll) : interval(interval), idlePoll(idlePoll){}
+
+	/**
+	 * Stores a reading, replacing one that wasn't handed on yet. Safe to call from any task.
+	 * @param now Time the reading was taken [us]
+	 */
+	void report(const T& reading, int64_t now){
+		std::lock_guard lock(mut);
+		this->reading = reading;
+		sampled = now;
+		fresh = true;
+	}
+
+	/**
+	 * Hands on the latest reading if the interval has passed and a new one came in. Only called from the publishing task.
+	 * @param publish void(const T& reading, int64_t sampled), called without the lock held
+	 * @return Time until update() should be called again [us]
+	 */
+	template<typename F>
+	int64_t update(int64_t now, F publish){
+		if(now - lastPublish < interval){
+			return interval - (now - lastPublish);
+		}
+
+		T current;
+		int64_t sampledAt;
+		{
+			std::lock_guard lock(mut);
+			if(!fresh) return idlePoll;
+
+			current = reading;
+			sampledAt = sampled;
+			fresh = false;
+		}
+		lastPublish = now;
+
+		publish(current, sampledAt);
+
+		return std::max(interval, idlePoll);
+	}
+
+	/**
+	 * Forgets the last hand-off, the interval counts from time 0 again.
+	 */
+	void restart(){
+		lastPublish = 0;
+	}
+
+private:
+	const int64_t interval;
+	const int64_t idlePoll;
+
+	int64_t lastPublish = 0;
+
+	std::mutex mut;
+	T reading{};
+	int64_t sampled = 0;
+	bool fresh = false;
+};
+
+
+#endif //PERSE_ROVER_LATESTREADING_H
@@ -3,22 +3,23 @@
 #include <esp_heap_caps.h>
 #include <freertos/FreeRTOS.h>
 #include "ArucoValidator.h"
+#include "stdafx.h"
 
 #undef EPS
 #include <opencv2/imgproc.hpp>
 #include <opencv2/core/mat.hpp>
 
-MarkerScanner::MarkerScanner(uint8_t frameWidth, uint8_t frameHeight) : width(frameWidth), height(frameHeight){
-	smallData = std::unique_ptr<uint8_t>((uint8_t*) heap_caps_malloc(width * height, MALLOC_CAP_SPIRAM));
-	bwData = std::unique_ptr<uint8_t>((uint8_t*) heap_caps_malloc(width * height, MALLOC_CAP_SPIRAM));
+MarkerScanner::MarkerScanner(uint8_t frameWidth, uint8_t frameHeight) : width(frameWidth), height(frameHeight),
+		scale(scaleMin + accuracy * (scaleMax - scaleMin)), downscaler(frameHeight, frameWidth, scale){
+	// Frame rows are the width, columns the height
+	const int rows = downscaler.getHeight();
+	const int cols = downscaler.getWidth();
 
-	small = cv::Mat(width, height, CV_8U, smallData.get());
-	bw = cv::Mat(width, height, CV_8U, bwData.get());
+	smallData = std::unique_ptr<uint8_t>((uint8_t*) heap_caps_malloc(rows * cols, MALLOC_CAP_SPIRAM));
+	bwData = std::unique_ptr<uint8_t>((uint8_t*) heap_caps_malloc(rows * cols, MALLOC_CAP_SPIRAM));
 
-	small.data = smallData.get();
-	bw.data = bwData.get();
-
-	scale = scaleMin + accuracy * (scaleMax - scaleMin);
+	small = cv::Mat(rows, cols, CV_8U, smallData.get());
+	bw = cv::Mat(rows, cols, CV_8U, bwData.get());
 
 	float floatBox = boxMin + accuracy * (scaleMax - scaleMin);
 	int intBox = std::roundf(floatBox);
@@ -46,35 +47,36 @@ bool MarkerScanner::process(const uint8_t* rawFrame, DriveInfo& driveInfo){
 	driveInfo.markerInfo.action = MarkerAction::None;
 	driveInfo.markerInfo.markers.clear();
 
-	std::vector<uint8_t> grayFrame(width * height);
-	// Only for RGB565
-	for(size_t i = 0; i < grayFrame.size(); ++i){
-		uint16_t color = ((uint16_t*) rawFrame)[i];
-		color = (color >> 8) | (color << 8);
-
-		uint8_t r = (color & 0xF800) >> 11;
-		uint8_t g = (color & 0x07E0) >> 5;
-		uint8_t b = (color & 0x001F);
-
-		r = std::clamp((r * 255) / 31, 0, 255);
-		g = std::clamp((g * 255) / 63, 0, 255);
-		b = std::clamp((b * 255) / 31, 0, 255);
-
-		grayFrame[i] = (r + g + b) / 3;
-	}
+	timings = {};
+	uint64_t stageStart = micros();
+	auto lap = [&stageStart](uint32_t& stage){
+		const uint64_t now = micros();
+		stage += now - stageStart;
+		stageStart = now;
+	};
 
-	const cv::Mat gray(width, height, CV_8U, grayFrame.data());
+	// Byte swap, grayscale and resize in one pass, straight into the preallocated buffer
+	downscaler.process(rawFrame, small.data);
+	lap(timings.downscale);
 
-	cv::resize(gray, small, {}, scale, scale, cv::InterpolationFlags::INTER_LINEAR);
 	GaussianBlur(small, small, cv::Size(3, 3), 0, 0);
+	lap(timings.blur);
+
 	cv::adaptiveThreshold(small, bw, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, box - 2, 10);
+	lap(timings.threshold);
 
 	std::vector<std::vector<cv::Point>> contours;
 	cv::findContours(bw, contours, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE);
+	lap(timings.contours);
 
 	for(const std::vector<cv::Point>& contour: contours){
+		stageStart = micros();
+
 		std::vector<cv::Point> approx(4);
-		if(!contourValid(contour, approx)){
+		const bool quad = contourValid(contour, approx);
+		lap(timings.quads);
+
+		if(!quad){
 			continue;
 		}
 
@@ -83,9 +85,13 @@ bool MarkerScanner::process(const uint8_t* rawFrame, DriveInfo& driveInfo){
 
 		cv::Mat aruco(7, 7, CV_8U);
 		cv::threshold(content, aruco, 160, 255, cv::THRESH_BINARY);
+		lap(timings.warp);
 
 		ArucoValidator validator(aruco);
-		if(!validator.validate()){
+		const bool valid = validator.validate();
+		lap(timings.validate);
+
+		if(!valid){
 			continue;
 		}
 
@@ -116,6 +122,14 @@ bool MarkerScanner::process(const uint8_t* rawFrame, DriveInfo& driveInfo){
 	return true;
 }
 
+const MarkerScanner::Timings& MarkerScanner::getTimings() const{
+	return timings;
+}
+
+float MarkerScanner::score(const Marker& marker) const{
+	return contourEval(marker.projected);
+}
+
 bool MarkerScanner::contourValid(const std::vector<cv::Point>& contour, std::vector<cv::Point>& approx){
 	if(contour.size() < 4){
 		return false;
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <DriveInfo.h>
+#include "GrayDownscaler.h"
 
 #undef EPS
 
@@ -15,6 +16,28 @@ public:
 	
 	bool process(const uint8_t* rawFrame, DriveInfo& driveInfo);
 
+	/**
+	 * Time spent in each stage of the last process() call, in microseconds.
+	 * contours is findContours alone, quads is the polygon fit and checks summed over all contours,
+	 * warp and validate are summed over the contours that passed as quads.
+	 */
+	struct Timings {
+		uint32_t downscale = 0;
+		uint32_t blur = 0;
+		uint32_t threshold = 0;
+		uint32_t contours = 0;
+		uint32_t quads = 0;
+		uint32_t warp = 0;
+		uint32_t validate = 0;
+	};
+
+	const Timings& getTimings() const;
+
+	/**
+	 * Score that markers are sorted by in process(), favors large markers close to the center of the frame.
+	 */
+	float score(const Marker& marker) const;
+
 private:
 	uint8_t width = 0;
 	uint8_t height = 0;
@@ -31,6 +54,10 @@ private:
 	int8_t box;
 	float scale;
 
+	GrayDownscaler downscaler;
+
+	Timings timings;
+
 	cv::Mat small;
 	cv::Mat bw;
 
@@ -0,0 +1,69 @@
+#ifndef PERSE_ROVER_RINGBUFFER_H
+#define PERSE_ROVER_RINGBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <algorithm>
+
+/**
+ * Fixed-size byte ring buffer for a single owner, not thread-safe.
+ * Incoming data can be written in place through writePtr()/commit(), so a socket can read straight into it.
+ */
+template<size_t Size>
+class RingBuffer {
+public:
+	size_t size() const{
+		return count;
+	}
+
+	size_t space() const{
+		return Size - count;
+	}
+
+	/**
+	 * Contiguous free region following the stored data. Data written there becomes readable after commit().
+	 * @param length Set to the size of the region, 0 if the buffer is full
+	 */
+	uint8_t* writePtr(size_t& length){
+		const size_t tail = (head + count) % Size;
+		length = count == Size ? 0 : (tail >= head ? Size - tail : head - tail);
+		return buf.data() + tail;
+	}
+
+	void commit(size_t length){
+		count += std::min(length, space());
+	}
+
+	/**
+	 * Copies out and removes count bytes.
+	 * @return false if fewer than count bytes are stored, nothing is removed in that case
+	 */
+	bool read(uint8_t* out, size_t length){
+		if(length > count) return false;
+
+		const size_t first = std::min(length, Size - head);
+		memcpy(out, buf.data() + head, first);
+		memcpy(out + first, buf.data(), length - first);
+
+		head = (head + length) % Size;
+		count -= length;
+
+		return true;
+	}
+
+	void clear(){
+		head = 0;
+		count = 0;
+	}
+
+private:
+	std::array<uint8_t, Size> buf;
+	size_t head = 0;
+	size_t count = 0;
+
+};
+
+
+#endif //PERSE_ROVER_RINGBUFFER_H
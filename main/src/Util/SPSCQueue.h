@@ -0,0 +1,140 @@
+#ifndef PERSE_ROVER_SPSCQUEUE_H
+#define PERSE_ROVER_SPSCQUEUE_H
+
+#include <cstddef>
+#include <array>
+#include <atomic>
+#include <utility>
+#include <sdkconfig.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/**
+ * Bounded lock-free queue for exactly one producer task and one consumer task, a drop-in for Queue<T> on paths
+ * where the kernel queue's copy and critical section on every post/get show up. Anything posted from more than one task
+ * stays on Queue<T>: a mutex around the producers gives back what the lock-free path saves, and blocks them on each other.
+ *
+ * Items are moved in and out, so it can carry non-trivial types such as refcounted handles or unique_ptrs.
+ * Either side can block; the waiting task is woken with a task notification on NotifyIndex, which leaves
+ * the default notification (index 0) to whatever else the task uses it for.
+ */
+template<typename T, size_t Size>
+class SPSCQueue {
+public:
+	/**
+	 * Producer side. Waits up to timeout for a free slot.
+	 * @return false if the queue stayed full, item is left untouched
+	 */
+	bool post(T&& item, TickType_t timeout = portMAX_DELAY){
+		return wait(producer, timeout, [this, &item](){ return push(std::move(item)); });
+	}
+
+	bool post(const T& item, TickType_t timeout = portMAX_DELAY){
+		return wait(producer, timeout, [this, &item](){ return push(T(item)); });
+	}
+
+	/**
+	 * Consumer side. Waits up to timeout for an item.
+	 * @return false if nothing arrived within the timeout
+	 */
+	bool get(T& item, TickType_t timeout = portMAX_DELAY){
+		return wait(consumer, timeout, [this, &item](){ return pop(item); });
+	}
+
+	/**
+	 * Consumer side. Drops everything queued.
+	 */
+	void reset(){
+		for(T item; pop(item););
+	}
+
+	size_t count() const{
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+
+	static constexpr UBaseType_t NotifyIndex = configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 ? 1 : 0;
+
+private:
+#ifdef CONFIG_ESP32S3_DATA_CACHE_LINE_SIZE
+	static constexpr size_t CacheLine = CONFIG_ESP32S3_DATA_CACHE_LINE_SIZE;
+#else
+	static constexpr size_t CacheLine = 64;
+#endif
+
+	// Each side's index on a cache line of its own, with its copy of the other side's index that is only refreshed when
+	// the queue looks full (or empty), so the two cores don't keep pulling the same line from each other
+	alignas(CacheLine) std::atomic<size_t> tail = 0; // next to write, owned by the producer
+	size_t headCache = 0;
+	std::atomic<TaskHandle_t> producer = nullptr; // waiting for a free slot
+
+	alignas(CacheLine) std::atomic<size_t> head = 0; // next to read, owned by the consumer
+	size_t tailCache = 0;
+	std::atomic<TaskHandle_t> consumer = nullptr; // waiting for an item
+
+	alignas(CacheLine) std::array<T, Size> slots;
+
+	bool push(T&& item){
+		const size_t t = tail.load(std::memory_order_relaxed);
+		if(t - headCache >= Size){
+			headCache = head.load(std::memory_order_acquire);
+			if(t - headCache >= Size) return false;
+		}
+
+		slots[t % Size] = std::move(item);
+		tail.store(t + 1, std::memory_order_release);
+
+		wake(consumer);
+		return true;
+	}
+
+	bool pop(T& item){
+		const size_t h = head.load(std::memory_order_relaxed);
+		if(h == tailCache){
+			tailCache = tail.load(std::memory_order_acquire);
+			if(h == tailCache) return false;
+		}
+
+		item = std::move(slots[h % Size]);
+		slots[h % Size] = T();
+		head.store(h + 1, std::memory_order_release);
+
+		wake(producer);
+		return true;
+	}
+
+	static void wake(std::atomic<TaskHandle_t>& waiter){
+		// The index store has to be visible before the other side's waiter is read, or both could end up sleeping
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if(TaskHandle_t task = waiter.load(std::memory_order_relaxed)){
+			xTaskNotifyGiveIndexed(task, NotifyIndex);
+		}
+	}
+
+	/**
+	 * Retries attempt until it succeeds or the timeout runs out, sleeping on a notification in between.
+	 * Stale notifications only cause an extra retry.
+	 */
+	template<typename F>
+	static bool wait(std::atomic<TaskHandle_t>& waiter, TickType_t timeout, F&& attempt){
+		if(attempt()) return true;
+		if(timeout == 0) return false;
+
+		waiter.store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		const TickType_t start = xTaskGetTickCount();
+		bool done;
+		while(!(done = attempt())){
+			const TickType_t elapsed = xTaskGetTickCount() - start;
+			if(timeout != portMAX_DELAY && elapsed >= timeout) break;
+
+			ulTaskNotifyTakeIndexed(NotifyIndex, pdTRUE, timeout == portMAX_DELAY ? portMAX_DELAY : timeout - elapsed);
+		}
+
+		waiter.store(nullptr, std::memory_order_relaxed);
+		return done;
+	}
+};
+
+#endif //PERSE_ROVER_SPSCQUEUE_H
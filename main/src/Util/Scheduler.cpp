@@ -0,0 +1,388 @@
+#include "Scheduler.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+
+static const char* TAG = "Scheduler";
+
+Scheduler::Job::Job(const char* name, TickType_t interval, std::function<void()> fn) : name(name), interval(interval), fn(std::move(fn)){}
+
+bool Scheduler::Job::active() const{
+	return state != Idle;
+}
+
+Scheduler::Scheduler() : cursor(xTaskGetTickCount()), statsTime(esp_timer_get_time()){}
+
+Scheduler& Scheduler::get(){
+	static Scheduler scheduler;
+	return scheduler;
+}
+
+void Scheduler::begin(){
+	if(started) return;
+	started = true;
+
+	// One worker per core, so a long job on one core doesn't hold up everything else
+	for(size_t i = 0; i < Workers; ++i){
+		workerArgs[i] = { this, i };
+		xTaskCreatePinnedToCore(workerFunc, "Sched", WorkerStack, &workerArgs[i], WorkerPriority, &workers[i], i % portNUM_PROCESSORS);
+	}
+}
+
+void Scheduler::add(Job* job){
+	Scheduler& scheduler = get();
+	std::lock_guard lock(scheduler.mut);
+	scheduler.begin();
+	job->removed = false;
+
+	if(job->state != Job::Idle){
+		// Added back while its removal was still waiting for the run to end
+		job->removing = false;
+		return;
+	}
+
+	job->deadline = xTaskGetTickCount();
+	job->due = esp_timer_get_time();
+	scheduler.list(job);
+	scheduler.pushReady(job);
+	scheduler.wakeIdle();
+}
+
+void Scheduler::trigger(Job* job, TickType_t delay){
+	Scheduler& scheduler = get();
+	std::lock_guard lock(scheduler.mut);
+	if(job->removed) return;
+
+	scheduler.begin();
+	scheduler.list(job);
+
+	const TickType_t deadline = xTaskGetTickCount() + delay;
+	const int64_t due = esp_timer_get_time() + (int64_t) delay * portTICK_PERIOD_MS * 1000;
+
+	switch(job->state){
+		case Job::Idle:
+			break;
+		case Job::Waiting:
+			if((int32_t) (deadline - job->deadline) >= 0) return;
+			scheduler.unlink(job);
+			break;
+		case Job::Ready:
+			return;
+		case Job::Running:
+			if(job->retrigger && job->retriggerDelay <= delay) return;
+			job->retrigger = true;
+			job->retriggerDelay = delay;
+			return;
+	}
+
+	job->deadline = deadline;
+	job->due = due;
+	scheduler.insert(job);
+	scheduler.wakeIdle();
+}
+
+void Scheduler::remove(Job* job, TickType_t wait){
+	Scheduler& scheduler = get();
+	{
+		std::lock_guard lock(scheduler.mut);
+		job->removed = true;
+
+		switch(job->state){
+			case Job::Idle:
+				scheduler.unlist(job);
+				return;
+			case Job::Waiting:
+			case Job::Ready:
+				scheduler.unlink(job);
+				job->state = Job::Idle;
+				scheduler.unlist(job);
+				return;
+			case Job::Running:
+				job->removing = true;
+				if(job->worker == xTaskGetCurrentTaskHandle()) return;
+				break;
+		}
+	}
+
+	const TickType_t start = xTaskGetTickCount();
+	while(job->active() && xTaskGetTickCount() - start < wait){
+		vTaskDelay(1);
+	}
+}
+
+std::vector<Scheduler::JobStats> Scheduler::getStats(){
+	Scheduler& scheduler = get();
+	std::lock_guard lock(scheduler.mut);
+
+	const int64_t now = esp_timer_get_time();
+	const int64_t window = std::max<int64_t>(1, now - scheduler.statsTime);
+	scheduler.statsTime = now;
+
+	std::vector<JobStats> stats;
+	stats.reserve(scheduler.jobs.size());
+
+	for(Job* job : scheduler.jobs){
+		stats.push_back({
+				.name = job->name,
+				.interval = job->interval,
+				.runs = job->runs,
+				.missed = job->missed,
+				.jitterAvg = job->runs == 0 ? 0 : (uint32_t) (job->jitterTotal / job->runs),
+				.jitterMax = job->jitterMax,
+				.busyAvg = job->runs == 0 ? 0 : (uint32_t) (job->busyTotal / job->runs),
+				.busyMax = job->busyMax,
+				.cpu = 100.0f * (float) job->busyWindow / (float) window
+		});
+		job->busyWindow = 0;
+	}
+
+	return stats;
+}
+
+void Scheduler::logStats(){
+	for(const auto& job : getStats()){
+		if(job.interval == 0){
+			ESP_LOGI(TAG, "%-10s on demand: %6lu runs, jitter avg %5lu max %6lu us, busy avg %5lu max %6lu us, %.1f%% CPU",
+					 job.name, job.runs, job.jitterAvg, job.jitterMax, job.busyAvg, job.busyMax, job.cpu);
+			continue;
+		}
+
+		ESP_LOGI(TAG, "%-10s every %4lu ms: %6lu runs, %3lu missed, jitter avg %5lu max %6lu us, busy avg %5lu max %6lu us, %.1f%% CPU",
+				 job.name, job.interval * portTICK_PERIOD_MS, job.runs, job.missed, job.jitterAvg, job.jitterMax, job.busyAvg, job.busyMax, job.cpu);
+	}
+}
+
+void Scheduler::workerFunc(void* arg){
+	auto worker = (WorkerArg*) arg;
+	worker->scheduler->work(worker->index);
+}
+
+void Scheduler::work(size_t index){
+	for(;;){
+		Job* job;
+		TickType_t wait = 0;
+		{
+			std::lock_guard lock(mut);
+			idle[index] = false;
+
+			advance(xTaskGetTickCount());
+
+			job = popReady();
+			if(job != nullptr){
+				job->state = Job::Running;
+				job->worker = workers[index];
+
+				// More is due than this worker can take
+				if(readyHead != nullptr){
+					wakeIdle();
+				}
+			}else{
+				idle[index] = true;
+				wait = nextWait(xTaskGetTickCount());
+			}
+		}
+
+		if(job == nullptr){
+			ulTaskNotifyTake(pdTRUE, wait);
+			continue;
+		}
+
+		run(job);
+	}
+}
+
+void Scheduler::run(Job* job){
+	const TickType_t startTick = xTaskGetTickCount();
+	const int64_t start = esp_timer_get_time();
+	job->fn();
+	const int64_t end = esp_timer_get_time();
+
+	std::lock_guard lock(mut);
+
+	const int64_t intervalUs = (int64_t) job->interval * portTICK_PERIOD_MS * 1000;
+	const uint32_t jitter = std::max<int64_t>(0, start - job->due);
+	const uint32_t busy = end - start;
+
+	job->runs++;
+	job->jitterTotal += jitter;
+	job->jitterMax = std::max(job->jitterMax, jitter);
+	job->busyTotal += busy;
+	job->busyMax = std::max(job->busyMax, busy);
+	job->busyWindow += busy;
+	if(job->interval != 0 && jitter >= intervalUs){
+		job->missed++;
+	}
+
+	job->worker = nullptr;
+
+	if(job->removing){
+		job->removing = false;
+		job->retrigger = false;
+		job->state = Job::Idle;
+		unlist(job);
+		return;
+	}
+
+	if(job->interval == 0){
+		if(!job->retrigger){
+			job->state = Job::Idle;
+			return;
+		}
+
+		job->retrigger = false;
+		job->deadline = xTaskGetTickCount() + job->retriggerDelay;
+		job->due = end + (int64_t) job->retriggerDelay * portTICK_PERIOD_MS * 1000;
+		insert(job);
+		return;
+	}
+
+	// Same as a dedicated SleepyThreaded, the interval counts from the start of the previous run
+	job->deadline = startTick + job->interval;
+	job->due = start + intervalUs;
+
+	const TickType_t now = xTaskGetTickCount();
+	if((int32_t) (job->deadline - now) < 0){
+		job->missed++;
+		job->deadline = now;
+		job->due = end;
+	}
+
+	insert(job);
+}
+
+void Scheduler::advance(TickType_t now){
+	if((int32_t) (now - cursor) < 0) return;
+
+	// After sleeping for more than a turn every slot gets visited once
+	const TickType_t span = std::min<TickType_t>(now - cursor + 1, WheelSize);
+
+	for(TickType_t i = 0; i < span && waiting > 0; ++i){
+		Job** link = &wheel[(cursor + i) % WheelSize];
+
+		while(*link != nullptr){
+			Job* job = *link;
+
+			if((int32_t) (job->deadline - now) > 0){
+				// Due on a later turn
+				link = &job->next;
+				continue;
+			}
+
+			*link = job->next;
+			job->next = nullptr;
+			waiting--;
+			pushReady(job);
+		}
+	}
+
+	cursor = now + 1;
+}
+
+TickType_t Scheduler::nextWait(TickType_t now) const{
+	if(readyHead != nullptr) return 0;
+	if(waiting == 0) return portMAX_DELAY;
+
+	TickType_t wait = portMAX_DELAY;
+	for(const Job* slot : wheel){
+		for(const Job* job = slot; job != nullptr; job = job->next){
+			const int32_t left = (int32_t) (job->deadline - now);
+			wait = std::min<TickType_t>(wait, std::max<int32_t>(left, 1));
+		}
+	}
+
+	return wait;
+}
+
+void Scheduler::insert(Job* job){
+	// Already behind the wheel's cursor, it would only be found a turn later
+	if((int32_t) (job->deadline - cursor) < 0){
+		pushReady(job);
+		return;
+	}
+
+	job->state = Job::Waiting;
+
+	Job*& slot = wheel[job->deadline % WheelSize];
+	job->next = slot;
+	slot = job;
+	waiting++;
+}
+
+void Scheduler::unlink(Job* job){
+	if(job->state == Job::Waiting){
+		for(Job** link = &wheel[job->deadline % WheelSize]; *link != nullptr; link = &(*link)->next){
+			if(*link != job) continue;
+
+			*link = job->next;
+			waiting--;
+			break;
+		}
+	}else if(job->state == Job::Ready){
+		Job* prev = nullptr;
+		for(Job* it = readyHead; it != nullptr; prev = it, it = it->next){
+			if(it != job) continue;
+
+			if(prev == nullptr){
+				readyHead = job->next;
+			}else{
+				prev->next = job->next;
+			}
+
+			if(readyTail == job){
+				readyTail = prev;
+			}
+			break;
+		}
+	}
+
+	job->next = nullptr;
+}
+
+void Scheduler::list(Job* job){
+	if(job->listed) return;
+
+	jobs.push_back(job);
+	job->listed = true;
+}
+
+void Scheduler::unlist(Job* job){
+	if(!job->listed) return;
+
+	std::erase(jobs, job);
+	job->listed = false;
+}
+
+void Scheduler::pushReady(Job* job){
+	job->state = Job::Ready;
+	job->next = nullptr;
+
+	if(readyTail == nullptr){
+		readyHead = job;
+	}else{
+		readyTail->next = job;
+	}
+	readyTail = job;
+}
+
+Scheduler::Job* Scheduler::popReady(){
+	Job* job = readyHead;
+	if(job == nullptr) return nullptr;
+
+	readyHead = job->next;
+	if(readyHead == nullptr){
+		readyTail = nullptr;
+	}
+	job->next = nullptr;
+
+	return job;
+}
+
+void Scheduler::wakeIdle(){
+	for(size_t i = 0; i < Workers; ++i){
+		if(!idle[i] || workers[i] == nullptr) continue;
+
+		idle[i] = false;
+		xTaskNotifyGive(workers[i]);
+		return;
+	}
+}
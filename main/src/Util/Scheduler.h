@@ -0,0 +1,152 @@
+#ifndef PERSE_ROVER_SCHEDULER_H
+#define PERSE_ROVER_SCHEDULER_H
+
+#include <array>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/**
+ * Runs periodic and triggered jobs on a small pool of worker tasks, instead of giving every loop a task and a stack of its own.
+ * Deadlines are kept in a hashed timer wheel with one slot per tick. Jobs due further out than one turn of the wheel
+ * stay in their slot until it comes around again. Whichever worker is idle advances the wheel and runs the due jobs,
+ * a job never runs on two workers at once.
+ *
+ * Jobs share the workers, so they should return quickly. Anything that blocks for long belongs in its own Threaded.
+ */
+class Scheduler {
+public:
+	class Job {
+	public:
+		/**
+		 * @param interval Time from the start of one run to the start of the next [ticks], 0 for a job that only runs when triggered
+		 */
+		Job(const char* name, TickType_t interval, std::function<void()> fn);
+
+		/**
+		 * @return true while the job is scheduled or running
+		 */
+		bool active() const;
+
+	private:
+		friend class Scheduler;
+
+		const char* name;
+		const TickType_t interval;
+		const std::function<void()> fn;
+
+		enum State : uint8_t {
+			Idle, Waiting, Ready, Running
+		};
+		std::atomic<State> state = Idle;
+		bool removing = false;
+		bool removed = false; // by remove(), trigger() leaves it alone until it's added again
+		bool listed = false; // in Scheduler::jobs
+		bool retrigger = false; // triggered while running
+		TickType_t retriggerDelay = 0;
+		TaskHandle_t worker = nullptr;
+
+		Job* next = nullptr; // in a wheel slot or in the ready list
+		TickType_t deadline = 0;
+		int64_t due = 0; // [us] deadline in esp_timer time, for jitter
+
+		uint32_t runs = 0;
+		uint32_t missed = 0;
+		uint64_t jitterTotal = 0;
+		uint32_t jitterMax = 0;
+		uint64_t busyTotal = 0;
+		uint32_t busyMax = 0;
+		uint64_t busyWindow = 0; // since the last getStats()
+	};
+
+	/**
+	 * Schedules a job, its first run is due right away. The job must stay alive until it is removed.
+	 */
+	static void add(Job* job);
+
+	/**
+	 * Runs a job once, delay ticks from now. If it's already due sooner nothing changes, and if it's running it runs again
+	 * delay ticks after the current run ends. Can be called from any task, also from the job itself, but not from an ISR.
+	 * Stats of a triggered job are kept until it is removed. Once the job is removed, triggering it does nothing until it's added again.
+	 */
+	static void trigger(Job* job, TickType_t delay = 0);
+
+	/**
+	 * Unschedules a job. A run in progress is waited for, unless wait is 0 or remove() is called from the job itself.
+	 * Until the run is over, Job::active() stays true. A trigger() racing the removal can't bring the job back, only add() does.
+	 */
+	static void remove(Job* job, TickType_t wait = portMAX_DELAY);
+
+	struct JobStats {
+		const char* name;
+		TickType_t interval;
+		uint32_t runs;
+		uint32_t missed; // runs that started a whole interval late, or ran into their next deadline
+		uint32_t jitterAvg; // [us] from the deadline to the start of the run
+		uint32_t jitterMax; // [us]
+		uint32_t busyAvg; // [us] time spent in one run
+		uint32_t busyMax; // [us]
+		float cpu; // [%] of one core since the previous getStats()
+	};
+
+	static std::vector<JobStats> getStats();
+	static void logStats();
+
+	/**
+	 * [B] Every job runs on the worker stacks. Sized for the deepest of them: Easer needed 3 KB as a task of its own,
+	 * TaskMonitor formats floats through the log, and DeviceController jobs echo state through Comm. The workers show up
+	 * as "Sched" in the TaskMonitor report with their stack high-water mark, which is what this gets tuned from.
+	 */
+	static constexpr size_t WorkerStack = 6 * 1024;
+
+private:
+	Scheduler();
+
+	static Scheduler& get();
+
+	static constexpr size_t Workers = 2;
+	static constexpr uint8_t WorkerPriority = 5;
+	std::array<TaskHandle_t, Workers> workers{};
+	std::array<bool, Workers> idle{};
+	bool started = false;
+
+	struct WorkerArg {
+		Scheduler* scheduler;
+		size_t index;
+	};
+	std::array<WorkerArg, Workers> workerArgs;
+
+	static constexpr size_t WheelSize = 64;
+	std::array<Job*, WheelSize> wheel{};
+	TickType_t cursor; // next tick to be processed
+	size_t waiting = 0; // jobs in the wheel
+
+	Job* readyHead = nullptr;
+	Job* readyTail = nullptr;
+
+	std::vector<Job*> jobs; // everything added and not fully removed, for the stats
+	int64_t statsTime = 0; // [us]
+
+	std::mutex mut;
+
+	void begin();
+	static void workerFunc(void* arg);
+	void work(size_t index);
+	void run(Job* job);
+
+	void advance(TickType_t now);
+	TickType_t nextWait(TickType_t now) const;
+	void insert(Job* job);
+	void unlink(Job* job);
+	void list(Job* job);
+	void unlist(Job* job);
+	void pushReady(Job* job);
+	Job* popReady();
+	void wakeIdle();
+};
+
+
+#endif //PERSE_ROVER_SCHEDULER_H
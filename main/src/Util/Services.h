@@ -20,7 +20,9 @@ enum class Service {
 	MotorDriveController,
 	LowBattery,
 	Settings,
-	MicroROS
+	MicroROS,
+	SensorBridge,
+	TaskMonitor
 };
 
 class ServiceLocator {
@@ -0,0 +1,120 @@
+#ifndef PERSE_ROVER_TELEMETRYLANE_H
+#define PERSE_ROVER_TELEMETRYLANE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <algorithm>
+
+/**
+ * Rate-limited lane for readings where only the latest one matters. Every key keeps one slot: a reading replaces
+ * the one still waiting under its key, and a key is sent at most once per interval.
+ * Platform independent and not thread-safe, the caller locks it and passes the time in.
+ */
+template<typename T, size_t Slots>
+class TelemetryLane {
+public:
+	/**
+	 * @param interval Minimum time between two sends under the same key [ms]
+	 */
+	explicit TelemetryLane(uint32_t interval) : interval(interval){}
+
+	/**
+	 * Stores a reading, replacing the one still waiting under the same key.
+	 * @return false if every slot is taken by other keys, the reading is dropped
+	 */
+	bool put(uint16_t key, const T& data){
+		Slot* slot = nullptr;
+		for(auto& s : slots){
+			if(s.used && s.key == key){
+				slot = &s;
+				break;
+			}else if(!s.used && slot == nullptr){
+				slot = &s;
+			}
+		}
+
+		if(slot == nullptr) return false;
+
+		if(slot->used && slot->pending){
+			coalesced++;
+		}else if(!slot->used){
+			*slot = { .used = true, .key = key };
+		}
+
+		slot->pending = true;
+		slot->data = data;
+		return true;
+	}
+
+	/**
+	 * Hands every reading that's due to send, stopping at the first one it refuses. A refused reading stays pending.
+	 * @param send bool(const T&), returns false when the link can't take the reading now
+	 */
+	template<typename F>
+	void take(uint64_t now, F send){
+		for(auto& slot : slots){
+			if(!slot.pending || now - slot.lastSent < interval) continue;
+			if(!send(slot.data)) break;
+
+			slot.pending = false;
+			slot.lastSent = now;
+			sent++;
+		}
+	}
+
+	/**
+	 * @return Time until the next pending reading is due [ms], 0 if one is due already, UINT64_MAX if nothing is pending
+	 */
+	uint64_t untilDue(uint64_t now) const{
+		uint64_t wait = UINT64_MAX;
+		for(const auto& slot : slots){
+			if(!slot.pending) continue;
+
+			const uint64_t since = now - slot.lastSent;
+			wait = std::min(wait, since >= interval ? 0 : interval - since);
+		}
+		return wait;
+	}
+
+	void clear(){
+		slots = {};
+	}
+
+	size_t getPending() const{
+		return std::count_if(slots.cbegin(), slots.cend(), [](const Slot& slot){ return slot.pending; });
+	}
+
+	size_t getUsed() const{
+		return std::count_if(slots.cbegin(), slots.cend(), [](const Slot& slot){ return slot.used; });
+	}
+
+	uint32_t getSent() const{
+		return sent;
+	}
+
+	/**
+	 * @return Readings replaced by a newer one before they were sent
+	 */
+	uint32_t getCoalesced() const{
+		return coalesced;
+	}
+
+private:
+	const uint32_t interval;
+
+	struct Slot {
+		bool used = false;
+		bool pending = false;
+		uint16_t key = 0;
+		uint64_t lastSent = 0;
+		T data{};
+	};
+	std::array<Slot, Slots> slots{};
+
+	uint32_t sent = 0;
+	uint32_t coalesced = 0;
+};
+
+
+#endif //PERSE_ROVER_TELEMETRYLANE_H
@@ -1,10 +1,26 @@
 #include "Threaded.h"
 #include "stdafx.h"
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <mutex>
+#include <algorithm>
+
+struct ThreadRegistry {
+	std::mutex mut;
+	std::vector<Threaded*> threads;
+};
+
+static ThreadRegistry& registry(){
+	static ThreadRegistry registry;
+	return registry;
+}
 
 Threaded::Threaded(const char* name, size_t stackSize, uint8_t priority, int8_t core) : name(name), stackSize(stackSize), priority(priority), core(core){
 	stopSem = xSemaphoreCreateBinary();
 	stopMut = xSemaphoreCreateMutex();
+
+	std::lock_guard lock(registry().mut);
+	registry().threads.push_back(this);
 }
 
 Threaded::~Threaded(){
@@ -13,6 +29,11 @@ Threaded::~Threaded(){
 		abort();
 	}
 
+	{
+		std::lock_guard lock(registry().mut);
+		std::erase(registry().threads, this);
+	}
+
 	vSemaphoreDelete(stopSem);
 	vSemaphoreDelete(stopMut);
 }
@@ -52,11 +73,19 @@ void Threaded::threadFunc(void* arg){
 	auto thr = static_cast<Threaded*>(arg);
 
 	while(thr->state == Running){
+		if(thr->selfTimed){
+			thr->loop();
+			continue;
+		}
+
+		const int64_t start = esp_timer_get_time();
 		thr->loop();
+		thr->recordLoop(esp_timer_get_time() - start);
 	}
 
 	thr->onStop();
 
+	thr->task = nullptr;
 	thr->state = Stopped;
 	xSemaphoreGive(thr->stopSem);
 
@@ -77,6 +106,51 @@ bool Threaded::running(){
 	return state == Running || state == Stopping;
 }
 
+void Threaded::recordLoop(uint32_t time, bool missed){
+	const auto bucket = std::upper_bound(LoopStats::BucketLimits.begin(), LoopStats::BucketLimits.end(), time) - LoopStats::BucketLimits.begin();
+	histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+	loops.fetch_add(1, std::memory_order_relaxed);
+
+	if(missed){
+		this->missed.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if(time > maxLoop.load(std::memory_order_relaxed)){
+		maxLoop.store(time, std::memory_order_relaxed);
+	}
+}
+
+std::vector<Threaded::Stats> Threaded::getStats(){
+	std::lock_guard lock(registry().mut);
+
+	std::vector<Stats> stats;
+	stats.reserve(registry().threads.size());
+
+	for(const Threaded* thread : registry().threads){
+		Stats entry = {
+				.name = thread->name,
+				.task = thread->task,
+				.stackSize = thread->stackSize,
+				.priority = thread->priority,
+				.core = thread->core,
+				.loop = {
+						.histogram = {},
+						.loops = thread->loops.load(std::memory_order_relaxed),
+						.missed = thread->missed.load(std::memory_order_relaxed),
+						.max = thread->maxLoop.load(std::memory_order_relaxed)
+				}
+		};
+
+		for(size_t i = 0; i < LoopStats::Buckets; ++i){
+			entry.loop.histogram[i] = thread->histogram[i].load(std::memory_order_relaxed);
+		}
+
+		stats.push_back(entry);
+	}
+
+	return stats;
+}
+
 ThreadedClosure::ThreadedClosure(Lambda loopFn, const char* name, size_t stackSize, uint8_t priority, int8_t core) : Threaded(name, stackSize, priority, core), fn(std::move(loopFn)){}
 
 void ThreadedClosure::loop(){
@@ -85,14 +159,92 @@ void ThreadedClosure::loop(){
 
 SleepyThreaded::SleepyThreaded(TickType_t loopInterval, const char* name, size_t stackSize, uint8_t priority, int8_t core) : Threaded(name, stackSize, priority, core), SleepTime(loopInterval){
 	pauseSem = xSemaphoreCreateBinary();
+	selfTimed = true;
+}
+
+SleepyThreaded::SleepyThreaded(TickType_t loopInterval, const char* name) : Threaded(name, 0), SleepTime(loopInterval),
+																			job(std::make_unique<Scheduler::Job>(name, pdMS_TO_TICKS(loopInterval), [this](){ timedSleepyLoop(); })){
+	pauseSem = xSemaphoreCreateBinary();
+	selfTimed = true;
 }
 
 SleepyThreaded::~SleepyThreaded(){
+	if(job){
+		Scheduler::remove(job.get());
+	}
+
 	vSemaphoreDelete(pauseSem);
 }
 
+void SleepyThreaded::start(){
+	lastStart = 0;
+
+	if(!job){
+		Threaded::start();
+		return;
+	}
+
+	std::lock_guard lock(lifeMut);
+
+	// Started again before the last run of a stop() was over, it just keeps going
+	if(stopping){
+		stopping = false;
+		Scheduler::add(job.get());
+		return;
+	}
+
+	if(started || !onStart()) return;
+	started = true;
+
+	Scheduler::add(job.get());
+}
+
+void SleepyThreaded::stop(TickType_t wait){
+	if(!job){
+		Threaded::stop(wait);
+		return;
+	}
+
+	{
+		std::lock_guard lock(lifeMut);
+		if(!started || stopping) return;
+		stopping = true;
+	}
+
+	Scheduler::remove(job.get(), wait);
+
+	// From sleepyLoop itself, or the wait ran out: the run in progress calls onStop when it's over
+	if(!job->active()){
+		finishStop();
+	}
+}
+
+void SleepyThreaded::finishStop(){
+	std::lock_guard lock(lifeMut);
+	if(!stopping) return;
+
+	stopping = false;
+	started = false;
+	onStop();
+}
+
+bool SleepyThreaded::running(){
+	if(!job){
+		return Threaded::running();
+	}
+
+	return job->active();
+}
+
 void SleepyThreaded::pause(){
 	if(paused) return;
+
+	if(job){
+		stop();
+		paused = true;
+		return;
+	}
+
 	xSemaphoreGive(pauseSem);
 	while(!paused){
 		vTaskDelay(1);
@@ -109,8 +261,9 @@ void SleepyThreaded::resetTime(){
 }
 
 void SleepyThreaded::loop(){
-	if(millis() - lastLoop < SleepTime){
-		if(xSemaphoreTake(pauseSem, millis() - lastLoop + 1) == pdTRUE){
+	const uint64_t elapsed = millis() - lastLoop;
+	if(elapsed < SleepTime){
+		if(xSemaphoreTake(pauseSem, SleepTime - elapsed) == pdTRUE){
 			stop(0);
 			paused = true;
 			return;
@@ -119,7 +272,21 @@ void SleepyThreaded::loop(){
 	}
 
 	resetTime();
+	timedSleepyLoop();
+}
+
+void SleepyThreaded::timedSleepyLoop(){
+	const int64_t start = esp_timer_get_time();
+	const bool late = lastStart != 0 && start - lastStart >= 2 * (int64_t) SleepTime * 1000;
+	lastStart = start;
+
 	sleepyLoop();
+
+	recordLoop(esp_timer_get_time() - start, late);
+
+	if(job){
+		finishStop();
+	}
 }
 
 SleepyThreadedClosure::SleepyThreadedClosure(TickType_t loopInterval, SleepyThreadedClosure::Lambda loopFn, const char *name, size_t stackSize, uint8_t priority, int8_t core) :
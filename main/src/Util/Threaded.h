@@ -6,15 +6,44 @@
 #include <freertos/task.h>
 #include <freertos/semphr.h>
 #include <functional>
+#include <memory>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include "Scheduler.h"
 
 class Threaded {
 public:
 	virtual ~Threaded();
 
-	void start();
-	void stop(TickType_t wait = portMAX_DELAY);
-
-	bool running();
+	virtual void start();
+	virtual void stop(TickType_t wait = portMAX_DELAY);
+
+	virtual bool running();
+
+	struct LoopStats {
+		static constexpr size_t Buckets = 8;
+		static constexpr std::array<uint32_t, Buckets - 1> BucketLimits = { 100, 1000, 5000, 10000, 50000, 100000, 500000 }; // [us]
+		std::array<uint32_t, Buckets> histogram; // iterations shorter than each BucketLimit, the last bucket is everything longer
+		uint32_t loops;
+		uint32_t missed; // SleepyThreaded only, iterations that started a whole interval late
+		uint32_t max; // [us]
+	};
+
+	struct Stats {
+		const char* name;
+		TaskHandle_t task; // nullptr while stopped, and for SleepyThreaded on the shared Scheduler
+		size_t stackSize; // [B] 0 for SleepyThreaded on the shared Scheduler
+		uint8_t priority;
+		int8_t core;
+		LoopStats loop;
+	};
+
+	/**
+	 * @return Every existing Threaded with its loop timings since it was constructed
+	 */
+	static std::vector<Stats> getStats();
 
 protected:
 	Threaded(const char* name, size_t stackSize = 12000, uint8_t priority = 5, int8_t core = -1);
@@ -27,6 +56,13 @@ protected:
 
 	virtual void loop() = 0;
 
+	/**
+	 * Every loop() call is timed from start to end, including whatever the loop blocks on.
+	 * Subclasses that know better (SleepyThreaded) set selfTimed and report their iterations with recordLoop.
+	 */
+	bool selfTimed = false;
+	void recordLoop(uint32_t time, bool missed = false);
+
 private:
 	const char* name;
 	size_t stackSize;
@@ -38,10 +74,16 @@ private:
 	} state = Stopped;
 
 	static void threadFunc(void* arg);
-	TaskHandle_t task;
+	TaskHandle_t task = nullptr;
 	SemaphoreHandle_t stopSem;
 	SemaphoreHandle_t stopMut;
 
+	// Written by the loop only, read by getStats from anywhere
+	std::array<std::atomic<uint32_t>, LoopStats::Buckets> histogram{};
+	std::atomic<uint32_t> loops = 0;
+	std::atomic<uint32_t> missed = 0;
+	std::atomic<uint32_t> maxLoop = 0;
+
 };
 
 class ThreadedClosure : public Threaded {
@@ -63,8 +105,24 @@ public:
 	void pause();
 	void resume();
 
+	void start() override;
+	void stop(TickType_t wait = portMAX_DELAY) override;
+
+	bool running() override;
+
 protected:
-	SleepyThreaded(TickType_t loopInterval, const char* name, size_t stackSize = 12000, uint8_t priority = 5, int8_t core = -1);
+	/**
+	 * Runs sleepyLoop on a task of its own.
+	 */
+	SleepyThreaded(TickType_t loopInterval, const char* name, size_t stackSize, uint8_t priority = 5, int8_t core = -1);
+
+	/**
+	 * Runs sleepyLoop as a Scheduler job on the shared workers, without a stack of its own.
+	 * sleepyLoop must not block for long: no waiting for sensor conversions, on audio, TCP or other queues, and no creating
+	 * or destroying other jobs. onStart is called by start() and onStop once the last run after stop() is over, on whichever task
+	 * that happens. beforeStop and afterStopSignal aren't called.
+	 */
+	SleepyThreaded(TickType_t loopInterval, const char* name);
 
 	void resetTime();
 	virtual void sleepyLoop() = 0;
@@ -76,6 +134,16 @@ private:
 	SemaphoreHandle_t pauseSem;
 	bool paused = false;
 
+	// Only in shared mode
+	std::unique_ptr<Scheduler::Job> job;
+	std::mutex lifeMut; // orders onStart and onStop against the job's runs
+	bool started = false; // onStart called, onStop not yet
+	bool stopping = false; // stop() called, onStop is due after the last run
+	void finishStop();
+
+	int64_t lastStart = 0; // [us] of the previous sleepyLoop, for missed deadlines
+	void timedSleepyLoop();
+
 	void loop() final;
 
 };
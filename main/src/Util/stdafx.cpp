@@ -1,4 +1,5 @@
 #include "stdafx.h"
+#include <cstdio>
 #include <esp_timer.h>
 #include <esp_heap_caps.h>
 #include <freertos/FreeRTOS.h>
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "Util/ArenaAllocator.h"
+
+static constexpr size_t Capacity = 4 * 1024;
+
+TEST(ArenaAllocator, OnlyServesTheOpeningTask){
+	ArenaAllocator arena(Capacity);
+
+	// Closed until opened
+	void* heap = arena.alloc(64);
+	EXPECT_EQ(arena.getUsed(), 0u);
+	arena.free(heap);
+
+	arena.open();
+	void* block = arena.alloc(64);
+	EXPECT_GT(arena.getUsed(), 0u);
+	const size_t used = arena.getUsed();
+
+	void* other = nullptr;
+	std::thread([&arena, &other](){ other = arena.alloc(64); }).join();
+	EXPECT_EQ(arena.getUsed(), used);
+	arena.free(other);
+
+	arena.free(block);
+	EXPECT_EQ(arena.getUsed(), 0u);
+	EXPECT_EQ(arena.getFallbacks(), 0u);
+}
+
+TEST(ArenaAllocator, ChurnAfterSealingDoesntGrowTheArena){
+	ArenaAllocator arena(Capacity);
+
+	// Session setup: a few long-lived blocks
+	arena.open();
+	void* setup[4];
+	for(auto& block : setup){
+		block = arena.calloc(1, 128);
+	}
+	arena.seal();
+	const size_t used = arena.getUsed();
+
+	// Endpoints coming and going for much longer than the arena could hold, freed from another task too
+	for(int i = 0; i < 1000; ++i){
+		void* endpoint = arena.alloc(256);
+		memset(endpoint, 0xAA, 256);
+		std::thread([&arena, endpoint](){ arena.free(endpoint); }).join();
+	}
+	EXPECT_EQ(arena.getUsed(), used);
+	EXPECT_EQ(arena.getFallbacks(), 0u);
+
+	// Setup blocks freed after sealing are left for reset(), reallocating one moves it to the heap
+	void* moved = arena.realloc(setup[3], 512);
+	EXPECT_EQ(arena.getUsed(), used);
+	arena.free(moved);
+
+	for(int i = 0; i < 3; ++i){
+		arena.free(setup[i]);
+	}
+	arena.reset();
+	EXPECT_EQ(arena.getUsed(), 0u);
+}
+
+TEST(ArenaAllocator, OverflowFallsBackToTheHeap){
+	ArenaAllocator arena(Capacity);
+	arena.open();
+
+	void* fits = arena.alloc(Capacity / 2);
+	void* spills = arena.alloc(Capacity);
+	ASSERT_NE(spills, nullptr);
+	EXPECT_EQ(arena.getFallbacks(), 1u);
+
+	arena.free(spills);
+	arena.free(fits);
+	EXPECT_EQ(arena.getUsed(), 0u);
+	EXPECT_EQ(arena.getPeak(), Capacity / 2 + 8);
+}
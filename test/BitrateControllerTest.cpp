@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <functional>
+#include "Util/BitrateController.h"
+
+/**
+ * Feed loop against a simulated link, with the Feed's two resolution levels (96x96 and 160x120).
+ * Frame size grows with pixels and quality, and varies from frame to frame like JPEG does.
+ * Sending takes size / capacity, and the socket pushes back once a frame takes longer than the frame interval.
+ */
+class Link {
+public:
+	explicit Link(uint32_t seed) : rng(seed){}
+
+	struct Result {
+		uint32_t resolutionChanges = 0;
+		uint64_t bytes = 0;
+		uint32_t time = 0; // [ms]
+		uint32_t congested = 0; // frames the socket pushed back on
+		uint32_t lowResolution = 0; // frames at the smaller resolution
+	};
+
+	/**
+	 * @param capacity Link rate at frame n, in B/s
+	 */
+	Result run(BitrateController& controller, uint32_t frames, const std::function<uint32_t(uint32_t)>& capacity){
+		Result result;
+		uint8_t resolution = controller.getResolution();
+
+		for(uint32_t n = 0; n < frames; ++n){
+			if(controller.getResolution() != resolution){
+				resolution = controller.getResolution();
+				result.resolutionChanges++;
+			}
+
+			const uint32_t pixels = resolution == 0 ? 96 * 96 : 160 * 120;
+			const float bytesPerPixel = 0.1f + 0.02f * (float) controller.getQuality();
+			const size_t bytes = (size_t) ((float) pixels * bytesPerPixel * std::uniform_real_distribution<float>(0.85f, 1.15f)(rng));
+
+			const uint32_t sendTime = (uint32_t) ((uint64_t) bytes * 1000 / capacity(n));
+			const uint32_t retries = sendTime > controller.getInterval() ? 1 : 0;
+
+			controller.frameSent(bytes, sendTime, retries);
+
+			result.bytes += bytes;
+			result.time += std::max(sendTime, controller.getInterval());
+			result.congested += retries;
+			result.lowResolution += resolution == 0;
+		}
+
+		return result;
+	}
+
+private:
+	std::mt19937 rng;
+};
+
+static BitrateController makeController(uint8_t ceiling = 30){
+	BitrateController controller(2, 50, 500);
+	controller.setCeiling(ceiling);
+	return controller;
+}
+
+TEST(BitrateController, RoomyLinkKeepsTheLargestResolution){
+	auto controller = makeController();
+	const auto result = Link(1).run(controller, 2000, [](uint32_t){ return 1000 * 1024; });
+
+	EXPECT_EQ(result.resolutionChanges, 0u);
+	EXPECT_EQ(controller.getInterval(), 50u);
+	EXPECT_LE(controller.getEstimatedRate(), BitrateController::TargetRate);
+}
+
+TEST(BitrateController, ResolutionDoesntFlapOnAMarginalLink){
+	// Carries the small resolution, the large one even at the lowest quality is just over it
+	auto controller = makeController();
+	const auto result = Link(2).run(controller, 3000, [](uint32_t){ return 40 * 1024; });
+
+	// Each failed step up doubles the wait for the next one: 40, 80, ... 640 frames, so about 8 tries in 3000 frames.
+	// Stepping up whenever the target allows it is a change every couple of dozen frames.
+	EXPECT_LE(result.resolutionChanges, 2u * 8);
+	EXPECT_GT(result.lowResolution, 3000u * 3 / 4);
+
+	// Below the target, so the link's limit is only found by probing into it now and then
+	EXPECT_LE(result.congested, 3000u / 20);
+	EXPECT_LE(controller.getEstimatedRate(), BitrateController::TargetRate);
+}
+
+TEST(BitrateController, ResolutionStepsAreHeld){
+	// Capacity swings every 10 frames, far quicker than a resolution step is held
+	auto controller = makeController();
+	const auto result = Link(3).run(controller, 2000, [](uint32_t n){ return (n / 10) % 2 ? 40 * 1024 : 400 * 1024; });
+
+	EXPECT_LE(result.resolutionChanges, 2000u / 40);
+}
+
+TEST(BitrateController, BacksOffWhenTheLinkDrops){
+	auto controller = makeController();
+	Link link(4);
+
+	link.run(controller, 500, [](uint32_t){ return 1000 * 1024; });
+	ASSERT_EQ(controller.getResolution(), 1);
+
+	// Drops to a tenth, the feed has to get under it within a second or so
+	const uint32_t capacity = 20 * 1024;
+	const auto result = link.run(controller, 200, [capacity](uint32_t){ return capacity; });
+
+	EXPECT_LE(controller.getEstimatedRate(), capacity);
+	EXPECT_GT(result.lowResolution, 0u);
+
+	const auto settled = link.run(controller, 200, [capacity](uint32_t){ return capacity; });
+	EXPECT_LE(settled.congested, 200u / 10);
+	EXPECT_LE(settled.resolutionChanges, 1u);
+}
+
+TEST(BitrateController, RecoversTheLargestResolution){
+	auto controller = makeController();
+	Link link(5);
+
+	link.run(controller, 300, [](uint32_t){ return 15 * 1024; });
+	ASSERT_EQ(controller.getResolution(), 0);
+
+	link.run(controller, 1000, [](uint32_t){ return 1000 * 1024; });
+	EXPECT_EQ(controller.getResolution(), 1);
+	EXPECT_EQ(controller.getInterval(), 50u);
+}
+
+TEST(BitrateController, WeakLinkLowersTheTarget){
+	auto controller = makeController();
+	Link link(6);
+
+	controller.setWeakLink(true);
+	link.run(controller, 500, [](uint32_t){ return 1000 * 1024; });
+
+	EXPECT_LE(controller.getEstimatedRate(), BitrateController::WeakTargetRate);
+}
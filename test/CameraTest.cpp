@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "TestUtil.h"
+#include "host/FakeCamera.h"
+#include "Devices/Camera.h"
+#include <Pins.hpp>
+#include <driver/gpio.h>
+
+class CameraTest : public ::testing::Test {
+protected:
+	void SetUp() override{
+		FakeCamera::reset();
+	}
+
+	I2C i2c{ I2C_NUM_0, (gpio_num_t) I2C_SDA, (gpio_num_t) I2C_SCL };
+};
+
+TEST_F(CameraTest, FramesAreSharedAndCapped){
+	Camera camera(i2c);
+	ASSERT_EQ(camera.init(), ESP_OK);
+
+	Camera::Frame first = camera.getFrame();
+	Camera::Frame second = camera.getFrame();
+	ASSERT_TRUE(first);
+	ASSERT_TRUE(second);
+
+	// Both buffers taken
+	EXPECT_FALSE(camera.getFrame());
+
+	Camera::Frame copy = first;
+	first.release();
+	EXPECT_FALSE(first);
+	EXPECT_TRUE(copy);
+	EXPECT_EQ(FakeCamera::framesOut(), 2u);
+
+	copy.release();
+	EXPECT_EQ(FakeCamera::framesOut(), 1u);
+	EXPECT_TRUE(camera.getFrame());
+
+	second.release();
+	camera.deinit();
+
+	const FakeCamera::Stats stats = FakeCamera::stats();
+	EXPECT_EQ(stats.framesOutAtDeinit, 0u);
+	EXPECT_EQ(stats.badReturns, 0u);
+}
+
+TEST_F(CameraTest, DeinitWaitsForHeldFrames){
+	static constexpr uint32_t HoldTime = 600;
+
+	Camera camera(i2c);
+	ASSERT_EQ(camera.init(), ESP_OK);
+	EXPECT_EQ(gpio_get_level((gpio_num_t) CAM_PIN_PWDN), 0);
+
+	Camera::Frame frame = camera.getFrame();
+	ASSERT_TRUE(frame);
+	const uint8_t expected = frame->buf[0];
+
+	std::atomic<bool> holding = false;
+	std::atomic<TickType_t> heldSince = 0;
+	std::atomic<bool> deinited = false;
+	bool intact = true;
+
+	// Another task still sending the frame while the camera gets turned off, for longer than the half a second
+	// deinit() warns after
+	std::thread sender([&, frame = std::move(frame)]() mutable {
+		heldSince = xTaskGetTickCount();
+		holding = true;
+		vTaskDelay(pdMS_TO_TICKS(HoldTime));
+
+		for(size_t i = 0; i < frame->len; ++i){
+			intact &= frame->buf[i] == expected;
+		}
+		intact &= !deinited;
+
+		frame.release();
+	});
+
+	ASSERT_TRUE(waitUntil([&holding](){ return holding.load(); }));
+
+	camera.deinit();
+	deinited = true;
+	// From when the sender took over rather than from the call, a loaded host can start deinit() late
+	const TickType_t waited = xTaskGetTickCount() - heldSince;
+
+	sender.join();
+
+	EXPECT_TRUE(intact);
+	EXPECT_GE(waited, pdMS_TO_TICKS(HoldTime));
+	EXPECT_FALSE(camera.isInited());
+	EXPECT_EQ(gpio_get_level((gpio_num_t) CAM_PIN_PWDN), 1);
+
+	const FakeCamera::Stats stats = FakeCamera::stats();
+	EXPECT_EQ(stats.deinits, 1u);
+	EXPECT_EQ(stats.framesOutAtDeinit, 0u);
+	EXPECT_EQ(stats.badReturns, 0u);
+
+	// Back up with fresh buffers
+	ASSERT_EQ(camera.init(), ESP_OK);
+	Camera::Frame next = camera.getFrame();
+	ASSERT_TRUE(next);
+	EXPECT_NE(next->buf[0], FakeCamera::Poison);
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include "Devices/DeviceController.h"
+#include "TestUtil.h"
+
+struct LevelState {
+	int32_t level;
+};
+
+static constexpr uint8_t LevelTopic = 5;
+
+/**
+ * Takes the level straight out of the Comm payload, and counts what reaches the hardware and the link.
+ */
+class LevelController : public DeviceController<LevelState> {
+public:
+	LevelController() : DeviceController("Level", Events::topics(LevelTopic)){}
+
+	using DeviceController::setRemotely;
+
+	std::atomic<int32_t> written = INT32_MIN;
+	std::atomic<uint32_t> writes = 0;
+	mutable std::atomic<uint32_t> localSends = 0;
+	mutable std::atomic<uint32_t> remoteSends = 0;
+	std::atomic<bool> onWorker = false;
+
+protected:
+	void write(const LevelState& state) override{
+		written = state.level;
+		writes++;
+	}
+
+	LevelState getDefaultState() const override{
+		return { 0 };
+	}
+
+	void sendState(const LevelState&, bool local) const override{
+		(local ? localSends : remoteSends)++;
+	}
+
+	void processEvent(const Event& event) override{
+		onWorker = strcmp(pcTaskGetName(nullptr), "Sched") == 0;
+		setRemotely(*(const LevelState*) event.data);
+	}
+};
+
+static void postLevel(int32_t level, uint8_t topic = LevelTopic){
+	const LevelState state = { level };
+	Events::post(Facility::Comm, &state, sizeof(state), topic);
+}
+
+TEST(DeviceController, CommEventsAreHandledOnTheSchedulerWorkers){
+	LevelController controller;
+
+	postLevel(17);
+	ASSERT_TRUE(waitUntil([&controller](){ return controller.written == 17; }));
+
+	EXPECT_EQ(controller.getCurrentState().level, 17);
+	EXPECT_EQ(controller.remoteSends, 1u);
+	EXPECT_TRUE(controller.onWorker);
+}
+
+TEST(DeviceController, OtherTopicsAreIgnored){
+	LevelController controller;
+
+	postLevel(3, LevelTopic + 1);
+	vTaskDelay(pdMS_TO_TICKS(20));
+
+	EXPECT_EQ(controller.writes, 0u);
+}
+
+TEST(DeviceController, BurstIsDrainedInOrder){
+	LevelController controller;
+
+	// The queue holds 10, the job drains whatever is there each time it runs
+	for(int32_t i = 1; i <= 8; ++i){
+		postLevel(i);
+	}
+
+	ASSERT_TRUE(waitUntil([&controller](){ return controller.writes == 8; }));
+	EXPECT_EQ(controller.written, 8);
+}
+
+TEST(DeviceController, DisconnectResetsToDefault){
+	LevelController controller;
+
+	postLevel(9);
+	ASSERT_TRUE(waitUntil([&controller](){ return controller.written == 9; }));
+
+	Events::post(Facility::TCP, TCPServer::Event{ .status = TCPServer::Event::Status::Disconnected });
+	ASSERT_TRUE(waitUntil([&controller](){ return controller.written == 0; }));
+
+	EXPECT_EQ(controller.getCurrentState().level, 0);
+}
+
+TEST(DeviceController, RemoteStateWaitsOutLocalControl){
+	LevelController controller;
+
+	controller.setControl(Local);
+	controller.setLocally({ 4 });
+	EXPECT_EQ(controller.written, 4);
+	EXPECT_EQ(controller.localSends, 1u);
+
+	postLevel(11);
+	vTaskDelay(pdMS_TO_TICKS(20));
+	EXPECT_EQ(controller.written, 4);
+
+	// The state that arrived meanwhile is applied when control goes back
+	controller.setControl(Remote);
+	EXPECT_EQ(controller.written, 11);
+	EXPECT_EQ(controller.getCurrentState().level, 11);
+}
+
+/**
+ * Applies levels handed over by set() from any task on the event job, like MotorDriveController::drive().
+ */
+class DeferredController : public LevelController {
+public:
+	void set(int32_t level){
+		pending = level;
+		triggerJob();
+	}
+
+	using DeviceController::triggerJob;
+
+	std::atomic<int32_t> pending = INT32_MIN;
+	std::atomic<uint32_t> passes = 0;
+	std::atomic<bool> passOnWorker = false;
+
+protected:
+	void afterEvents() override{
+		passOnWorker = strcmp(pcTaskGetName(nullptr), "Sched") == 0;
+		passes++;
+
+		const int32_t level = pending.exchange(INT32_MIN);
+		if(level != INT32_MIN){
+			setRemotely({ level });
+		}
+	}
+};
+
+TEST(DeviceController, TriggeredJobRunsAfterEventsOnTheWorkers){
+	DeferredController controller;
+
+	controller.set(6);
+	ASSERT_TRUE(waitUntil([&controller](){ return controller.written == 6; }));
+	EXPECT_TRUE(controller.passOnWorker);
+
+	// Events and deferred levels go through the same job, the deferred one after the queued events
+	controller.pending = 8;
+	postLevel(7);
+	ASSERT_TRUE(waitUntil([&controller](){ return controller.written == 8; }));
+	EXPECT_EQ(controller.writes, 3u);
+
+	const uint32_t passes = controller.passes;
+	const TickType_t start = xTaskGetTickCount();
+	controller.triggerJob(pdMS_TO_TICKS(30));
+	ASSERT_TRUE(waitUntil([&controller, passes](){ return controller.passes > passes; }));
+	EXPECT_GE(xTaskGetTickCount() - start, pdMS_TO_TICKS(30));
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "Util/DifferentialDrive.h"
+
+TEST(DifferentialDrive, MixesTwistIntoWheels){
+	struct Case {
+		float linear, angular;
+		int8_t left, right;
+	};
+	const Case cases[] = {
+			{ 0, 0, 0, 0 },
+			{ 1, 0, 100, 100 },
+			{ -0.5f, 0, -50, -50 },
+			{ 0, 1, -100, 100 }, // turning left on the spot
+			{ 0, -0.4f, 40, -40 },
+			{ 0.5f, 0.25f, 25, 75 },
+			{ -0.5f, 0.25f, -75, -25 },
+			{ 3, -3, 100, 0 }, // clamped to (1, -1) first
+	};
+
+	for(const auto& c : cases){
+		const auto wheels = DifferentialDrive::mix(c.linear, c.angular);
+		EXPECT_EQ((int) wheels.left, c.left) << c.linear << ", " << c.angular;
+		EXPECT_EQ((int) wheels.right, c.right) << c.linear << ", " << c.angular;
+	}
+}
+
+TEST(DifferentialDrive, PeakIsScaledDownKeepingTheTurnRadius){
+	// 1.5 and 0.5 scaled down by 1.5
+	auto wheels = DifferentialDrive::mix(1, -0.5f);
+	EXPECT_EQ(wheels.left, 100);
+	EXPECT_EQ(wheels.right, 33);
+
+	wheels = DifferentialDrive::mix(-0.8f, -0.6f);
+	EXPECT_EQ(wheels.left, -14);
+	EXPECT_EQ(wheels.right, -100);
+
+	// Over the whole input range no wheel goes past full power
+	for(float linear = -1; linear <= 1; linear += 0.125f){
+		for(float angular = -1; angular <= 1; angular += 0.125f){
+			wheels = DifferentialDrive::mix(linear, angular);
+			ASSERT_LE(std::abs(wheels.left), 100);
+			ASSERT_LE(std::abs(wheels.right), 100);
+
+			const float left = linear - angular;
+			const float right = linear + angular;
+			if(std::max(std::abs(left), std::abs(right)) < 1.0f) continue;
+
+			// Same ratio between the wheels as before scaling, within rounding
+			EXPECT_NEAR(wheels.left * right, wheels.right * left, 2.0f) << linear << ", " << angular;
+		}
+	}
+}
+
+TEST(DifferentialDrive, DirectionsMatchTheOldWheelTable){
+	// Wheel power per DriveDir direction, as the motor controller used to set it directly
+	static constexpr int Old[8][2] = {
+			{ 100, 100 },
+			{ 100, 30 },
+			{ 100, -100 },
+			{ -100, -30 },
+			{ -100, -100 },
+			{ -30, -100 },
+			{ -100, 100 },
+			{ 30, 100 }
+	};
+
+	for(uint8_t dir = 0; dir < 8; dir++){
+		for(float speed : { 1.0f, 0.75f, 0.6f, 0.4f, 0.1f, 0.0f }){
+			const auto motion = DifferentialDrive::fromDirection(dir, speed);
+			const auto wheels = DifferentialDrive::mix(motion.linear, motion.angular);
+
+			// The old table truncated, mixing rounds
+			EXPECT_NEAR(wheels.left, Old[dir][0] * speed, 1.0f) << (int) dir << " at " << speed;
+			EXPECT_NEAR(wheels.right, Old[dir][1] * speed, 1.0f) << (int) dir << " at " << speed;
+		}
+
+		const auto full = DifferentialDrive::fromDirection(dir, 1.0f);
+		const auto wheels = DifferentialDrive::mix(full.linear, full.angular);
+		EXPECT_EQ(wheels.left, Old[dir][0]) << (int) dir;
+		EXPECT_EQ(wheels.right, Old[dir][1]) << (int) dir;
+	}
+
+	const auto stop = DifferentialDrive::fromDirection(8, 1.0f);
+	EXPECT_EQ(stop.linear, 0);
+	EXPECT_EQ(stop.angular, 0);
+
+	const auto over = DifferentialDrive::fromDirection(0, 2.0f);
+	EXPECT_EQ(over.linear, 1.0f);
+}
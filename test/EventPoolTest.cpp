@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include "Util/EventPool.h"
+#include "Util/Events.h"
+#include "TestUtil.h"
+
+TEST(EventPool, PayloadIsFreedAfterTheLastRelease){
+	EventPool pool;
+	const uint32_t value = 0xC0FFEE;
+
+	void* payload = pool.alloc(&value, sizeof(value), 3);
+	ASSERT_NE(payload, nullptr);
+	EXPECT_EQ(*(uint32_t*) payload, value);
+	EXPECT_EQ(pool.getFree(), EventPool::BlockCount - 1);
+
+	pool.release(payload);
+	pool.release(payload);
+	EXPECT_EQ(pool.getFree(), EventPool::BlockCount - 1);
+
+	pool.release(payload);
+	EXPECT_EQ(pool.getFree(), EventPool::BlockCount);
+	EXPECT_EQ(pool.getFallbacks(), 0u);
+}
+
+TEST(EventPool, LargeOrExhaustedFallsBackToTheHeap){
+	EventPool pool;
+
+	uint8_t large[EventPool::BlockSize + 1];
+	memset(large, 0xAB, sizeof(large));
+	void* heap = pool.alloc(large, sizeof(large), 2);
+	ASSERT_NE(heap, nullptr);
+	EXPECT_EQ(memcmp(heap, large, sizeof(large)), 0);
+	EXPECT_EQ(pool.getFallbacks(), 1u);
+	EXPECT_EQ(pool.getFree(), EventPool::BlockCount);
+
+	std::vector<void*> blocks;
+	for(uint16_t i = 0; i <= EventPool::BlockCount; ++i){
+		blocks.push_back(pool.alloc(&i, sizeof(i), 1));
+		EXPECT_EQ(*(uint16_t*) blocks.back(), i);
+	}
+	EXPECT_EQ(pool.getFree(), 0);
+	EXPECT_EQ(pool.getFallbacks(), 2u);
+
+	for(void* block : blocks){
+		pool.release(block);
+	}
+	pool.release(heap);
+	pool.release(heap);
+
+	EXPECT_EQ(pool.getFree(), EventPool::BlockCount);
+}
+
+TEST(EventPool, ConcurrentUseNeverHandsOutABlockTwice){
+	EventPool pool;
+	std::atomic<uint32_t> clobbered = 0;
+
+	// 4 threads holding up to 8 blocks each never exhaust the pool, so every payload has to be a block
+	auto worker = [&pool, &clobbered](uint32_t id){
+		void* held[8];
+		for(uint32_t round = 0; round < 20000; ++round){
+			for(uint32_t i = 0; i < 8; ++i){
+				const uint32_t tag = (id << 24) | (round << 3) | i;
+				held[i] = pool.alloc(&tag, sizeof(tag), 1);
+			}
+			for(uint32_t i = 0; i < 8; ++i){
+				const uint32_t tag = (id << 24) | (round << 3) | i;
+				clobbered += *(uint32_t*) held[i] != tag;
+				pool.release(held[i]);
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for(uint32_t id = 0; id < 4; ++id){
+		threads.emplace_back(worker, id);
+	}
+	for(auto& thread : threads){
+		thread.join();
+	}
+
+	EXPECT_EQ(clobbered, 0u);
+	EXPECT_EQ(pool.getFallbacks(), 0u);
+	EXPECT_EQ(pool.getFree(), EventPool::BlockCount);
+}
+
+struct Stamp {
+	int64_t posted; // [us]
+	uint32_t seq;
+};
+
+struct Consumer {
+	EventQueue queue{ 16 };
+	std::vector<uint32_t> latencies; // [us]
+	std::atomic<uint32_t> received = 0;
+	std::atomic<bool> done = false;
+
+	static void task(void* arg){
+		auto consumer = (Consumer*) arg;
+
+		for(Event event{}; consumer->queue.get(event, portMAX_DELAY);){
+			const auto stamp = (const Stamp*) event.data;
+			consumer->latencies.push_back(esp_timer_get_time() - stamp->posted);
+			Events::release(event.data);
+			consumer->received++;
+		}
+
+		consumer->done = true;
+		vTaskDelete(nullptr);
+	}
+};
+
+TEST(Events, PostToReceiveLatencyWithoutLeaks){
+	const EventPool& pool = Events::getPool();
+	const uint32_t fallbacks = pool.getFallbacks();
+
+	constexpr uint32_t Count = 3000;
+	Consumer consumers[3];
+	for(auto& consumer : consumers){
+		consumer.latencies.reserve(Count);
+		Events::listen(Facility::Battery, &consumer.queue);
+		xTaskCreate(Consumer::task, "consumer", 4 * 1024, &consumer, 5, nullptr);
+	}
+
+	for(uint32_t seq = 0; seq < Count; ++seq){
+		Events::post(Facility::Battery, Stamp{ esp_timer_get_time(), seq });
+
+		// Stay well within the queues, so nothing is dropped and every payload goes through all three consumers
+		if(seq % 8 == 7){
+			ASSERT_TRUE(waitUntil([&consumers, seq](){
+				return std::all_of(std::begin(consumers), std::end(consumers), [seq](const Consumer& c){ return c.received == seq + 1; });
+			}));
+		}
+	}
+
+	for(auto& consumer : consumers){
+		Events::unlisten(&consumer.queue);
+		consumer.queue.unblock();
+	}
+	ASSERT_TRUE(waitUntil([&consumers](){
+		return std::all_of(std::begin(consumers), std::end(consumers), [](const Consumer& c){ return c.done.load(); });
+	}));
+
+	// Every payload was shared by three queues and went back to the pool after the third release
+	EXPECT_EQ(pool.getFree(), EventPool::BlockCount);
+	EXPECT_EQ(pool.getFallbacks(), fallbacks);
+
+	std::vector<uint32_t> latencies;
+	for(const auto& consumer : consumers){
+		EXPECT_EQ(consumer.received, Count);
+		latencies.insert(latencies.end(), consumer.latencies.begin(), consumer.latencies.end());
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	const uint32_t p50 = latencies[latencies.size() / 2];
+	const uint32_t p99 = latencies[latencies.size() * 99 / 100];
+	printf("Post to receive over %zu deliveries: p50 %u us, p99 %u us, max %u us\n", latencies.size(), p50, p99, latencies.back());
+	RecordProperty("p50_us", p50);
+	RecordProperty("p99_us", p99);
+
+	// Thread wakeups on a loaded host, so only a coarse bound
+	EXPECT_LT(p50, 2000u);
+}
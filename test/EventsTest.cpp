@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "Util/Events.h"
+#include "TestUtil.h"
+
+struct Reading {
+	uint32_t value;
+};
+
+TEST(Events, EveryListenerGetsTheSamePayload){
+	EventQueue a(4), b(4);
+	Events::listen(Facility::Battery, &a);
+	Events::listen(Facility::Battery, &b);
+
+	const Reading sent = { 1234 };
+	Events::post(Facility::Battery, sent);
+
+	Event fromA{}, fromB{};
+	ASSERT_TRUE(a.get(fromA, 0));
+	ASSERT_TRUE(b.get(fromB, 0));
+
+	EXPECT_EQ(fromA.facility, Facility::Battery);
+	EXPECT_EQ(fromA.data, fromB.data);
+	EXPECT_EQ(((Reading*) fromA.data)->value, 1234u);
+
+	Events::release(fromA.data);
+	Events::release(fromB.data);
+
+	Events::unlisten(&a);
+	Events::unlisten(&b);
+}
+
+TEST(Events, TopicsFilterListeners){
+	EventQueue low(4), high(4), all(4);
+	Events::listen(Facility::Input, &low, Events::topics(1, 2));
+	Events::listen(Facility::Input, &high, Events::topics(40));
+	Events::listen(Facility::Input, &all);
+
+	const Reading reading = { 7 };
+	Events::post(Facility::Input, &reading, sizeof(reading), 2);
+	Events::post(Facility::Input, &reading, sizeof(reading), 40);
+
+	Event event{};
+	ASSERT_TRUE(low.get(event, 0));
+	Events::release(event.data);
+	EXPECT_FALSE(low.get(event, 0));
+
+	ASSERT_TRUE(high.get(event, 0));
+	Events::release(event.data);
+	EXPECT_FALSE(high.get(event, 0));
+
+	for(int i = 0; i < 2; ++i){
+		ASSERT_TRUE(all.get(event, 0));
+		Events::release(event.data);
+	}
+
+	// Without a topic, everyone gets it
+	Events::post(Facility::Input, reading);
+	for(EventQueue* queue : { &low, &high, &all }){
+		ASSERT_TRUE(queue->get(event, 0));
+		Events::release(event.data);
+	}
+
+	for(EventQueue* queue : { &low, &high, &all }){
+		Events::unlisten(queue);
+	}
+}
+
+TEST(Events, OutOfRangeTopicsMeanNoTopicOnBothEnds){
+	static_assert(Events::topics(70) == Events::AllTopics);
+	static_assert(Events::topics(Events::NoTopic) == Events::AllTopics);
+	static_assert(Events::topics(3, 63) == ((1ULL << 3) | (1ULL << 63)));
+
+	EventQueue wide(4), narrow(4);
+	Events::listen(Facility::Input, &wide, Events::topics(70));
+	Events::listen(Facility::Input, &narrow, Events::topics(5));
+
+	const Reading reading = { 9 };
+	Events::post(Facility::Input, &reading, sizeof(reading), 3);
+	Events::post(Facility::Input, &reading, sizeof(reading), 100);
+
+	// wide gets both, narrow only the one posted past the mask
+	Event event{};
+	for(int i = 0; i < 2; ++i){
+		ASSERT_TRUE(wide.get(event, 0));
+		Events::release(event.data);
+	}
+	EXPECT_FALSE(wide.get(event, 0));
+
+	ASSERT_TRUE(narrow.get(event, 0));
+	Events::release(event.data);
+	EXPECT_FALSE(narrow.get(event, 0));
+
+	Events::unlisten(&wide);
+	Events::unlisten(&narrow);
+}
+
+TEST(Events, UnlistenedQueueGetsNothing){
+	EventQueue queue(4);
+	Events::listen(Facility::Pair, &queue);
+	Events::unlisten(&queue);
+
+	Events::post(Facility::Pair, Reading{ 1 });
+
+	Event event{};
+	EXPECT_FALSE(queue.get(event, 0));
+}
+
+TEST(Events, PostHookRunsOnlyForQueuedEvents){
+	EventQueue queue(2);
+	std::atomic<uint32_t> hooks = 0;
+	queue.setPostHook([&hooks](){ hooks++; });
+	Events::listen(Facility::Modules, &queue);
+
+	// The third one doesn't fit
+	for(uint32_t i = 0; i < 3; ++i){
+		Events::post(Facility::Modules, Reading{ i });
+	}
+	EXPECT_EQ(hooks, 2u);
+
+	Events::unlisten(&queue);
+	queue.reset();
+}
+
+TEST(Events, UnlistenWaitsForPostsInFlight){
+	EventQueue queue(4);
+	std::atomic<bool> inHook = false;
+	std::atomic<bool> hookDone = false;
+	queue.setPostHook([&](){
+		inHook = true;
+		vTaskDelay(pdMS_TO_TICKS(30));
+		hookDone = true;
+	});
+	Events::listen(Facility::Modules, &queue);
+
+	// The poster already picked the queue when the owner starts tearing it down
+	std::thread poster([](){ Events::post(Facility::Modules, Reading{ 1 }); });
+	ASSERT_TRUE(waitUntil([&inHook](){ return inHook.load(); }));
+
+	Events::unlisten(&queue);
+	EXPECT_TRUE(hookDone);
+
+	poster.join();
+	queue.reset();
+}
+
+TEST(Events, BlockedListenerWakesUpOnPost){
+	EventQueue queue(4);
+	Events::listen(Facility::Feed, &queue);
+
+	std::atomic<uint32_t> received = 0;
+
+	struct Arg {
+		EventQueue* queue;
+		std::atomic<uint32_t>* received;
+	} arg = { &queue, &received };
+
+	xTaskCreate([](void* p){
+		auto arg = (Arg*) p;
+		Event event{};
+		if(arg->queue->get(event, portMAX_DELAY)){
+			*arg->received = ((Reading*) event.data)->value;
+			Events::release(event.data);
+		}
+		vTaskDelete(nullptr);
+	}, "listener", 4 * 1024, &arg, 5, nullptr);
+
+	vTaskDelay(pdMS_TO_TICKS(10));
+	Events::post(Facility::Feed, Reading{ 42 });
+
+	EXPECT_TRUE(waitUntil([&received](){ return received == 42; }));
+
+	Events::unlisten(&queue);
+}
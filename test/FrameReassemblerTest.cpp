@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include "FrameReassembler.h"
+#include "Util/CRC32.h"
+
+using Datagram = std::vector<uint8_t>;
+
+static constexpr size_t Payload = 100;
+static constexpr size_t MaxFrame = 4096;
+
+/**
+ * Same split as UDPEmitter::writeFrame, with a smaller payload so frames span more fragments.
+ */
+static std::vector<Datagram> fragment(uint16_t frameID, const std::vector<uint8_t>& frame, uint16_t metaSize, uint8_t version = FeedProtocolVersion){
+	const size_t count = (frame.size() + Payload - 1) / Payload;
+	std::vector<Datagram> datagrams;
+
+	for(size_t i = 0; i < count; ++i){
+		const size_t offset = i * Payload;
+		const size_t size = std::min(Payload, frame.size() - offset);
+
+		const FeedFragmentHeader header = {
+				.magic = FeedFragmentMagic,
+				.version = version,
+				.reserved = 0,
+				.frameID = frameID,
+				.index = (uint16_t) i,
+				.count = (uint16_t) count,
+				.frameSize = (uint32_t) frame.size(),
+				.metaSize = metaSize,
+				.crc = crc32(frame.data() + offset, size)
+		};
+
+		Datagram datagram(sizeof(header) + size);
+		memcpy(datagram.data(), &header, sizeof(header));
+		memcpy(datagram.data() + sizeof(header), frame.data() + offset, size);
+		datagrams.push_back(std::move(datagram));
+	}
+
+	return datagrams;
+}
+
+static std::vector<uint8_t> randomFrame(std::mt19937& rng){
+	std::vector<uint8_t> frame(std::uniform_int_distribution<size_t>(1, MaxFrame)(rng));
+	for(auto& byte : frame){
+		byte = rng();
+	}
+	return frame;
+}
+
+static bool push(FrameReassembler& reassembler, const Datagram& datagram, uint64_t now = 0){
+	return reassembler.push(datagram.data(), datagram.size(), now);
+}
+
+static bool pushAll(FrameReassembler& reassembler, const std::vector<Datagram>& datagrams, uint64_t now = 0){
+	bool completed = false;
+	for(const auto& datagram : datagrams){
+		completed = push(reassembler, datagram, now);
+	}
+	return completed;
+}
+
+static bool holds(const FrameReassembler& reassembler, const std::vector<uint8_t>& frame){
+	return reassembler.size() == frame.size() && memcmp(reassembler.data(), frame.data(), frame.size()) == 0;
+}
+
+TEST(FrameReassembler, FramesComeBackWhole){
+	std::mt19937 rng(1);
+	FrameReassembler reassembler(MaxFrame);
+
+	for(uint16_t id = 0; id < 20; ++id){
+		const auto frame = randomFrame(rng);
+		const uint16_t meta = std::min<size_t>(frame.size(), 60);
+
+		ASSERT_TRUE(pushAll(reassembler, fragment(id, frame, meta)));
+		ASSERT_TRUE(holds(reassembler, frame));
+		EXPECT_EQ(reassembler.metaSize(), meta);
+	}
+
+	EXPECT_EQ(reassembler.getCompleted(), 20u);
+	EXPECT_EQ(reassembler.getDropped(), 0u);
+}
+
+TEST(FrameReassembler, LossReorderingAndDuplicates){
+	std::mt19937 rng(2);
+	FrameReassembler reassembler(MaxFrame);
+
+	constexpr uint16_t Frames = 2000;
+	uint32_t whole = 0, partial = 0, completed = 0;
+	uint32_t begun = 0; // partial frames that got at least one fragment through
+
+	for(uint16_t id = 0; id < Frames; ++id){
+		const auto frame = randomFrame(rng);
+		auto datagrams = fragment(id, frame, 0);
+
+		// 2 % loss, shuffled within the frame, 5 % duplicated
+		std::vector<Datagram> sent;
+		for(auto& datagram : datagrams){
+			if(rng() % 100 < 2) continue;
+			sent.push_back(datagram);
+			if(rng() % 100 < 5) sent.push_back(datagram);
+		}
+		std::shuffle(sent.begin(), sent.end(), rng);
+
+		const bool lost = std::any_of(datagrams.begin(), datagrams.end(), [&sent](const Datagram& d){
+			return std::find(sent.begin(), sent.end(), d) == sent.end();
+		});
+		(lost ? partial : whole)++;
+		begun += lost && !sent.empty();
+
+		for(const auto& datagram : sent){
+			if(push(reassembler, datagram)){
+				// Only ever a frame that was sent whole, never a mix of fragments
+				ASSERT_FALSE(lost) << "frame " << id;
+				ASSERT_TRUE(holds(reassembler, frame)) << "frame " << id;
+				completed++;
+			}
+		}
+	}
+
+	EXPECT_EQ(completed, whole);
+	EXPECT_EQ(reassembler.getCompleted(), whole);
+
+	// A partial frame is dropped once a newer one shows up, so the last one may still be pending
+	EXPECT_GE(reassembler.getDropped() + 1, begun);
+	EXPECT_LE(reassembler.getDropped(), begun);
+	EXPECT_GT(partial, 0u);
+	EXPECT_GT(whole, partial);
+}
+
+TEST(FrameReassembler, LateFragmentsOfOlderFramesAreIgnored){
+	FrameReassembler reassembler(MaxFrame);
+
+	std::vector<uint8_t> first(500, 1), second(500, 2);
+	const auto a = fragment(10, first, 0);
+	const auto b = fragment(11, second, 0);
+
+	// Frame 10 loses its last fragment, which only shows up after frame 11 started
+	for(size_t i = 0; i < a.size() - 1; ++i){
+		EXPECT_FALSE(push(reassembler, a[i]));
+	}
+	EXPECT_FALSE(push(reassembler, b[0]));
+	EXPECT_FALSE(push(reassembler, a.back()));
+
+	for(size_t i = 1; i < b.size(); ++i){
+		push(reassembler, b[i]);
+	}
+	EXPECT_TRUE(holds(reassembler, second));
+	EXPECT_EQ(reassembler.getDropped(), 1u);
+	EXPECT_EQ(reassembler.getRestarts(), 0u);
+}
+
+TEST(FrameReassembler, CorruptedFrameIsDropped){
+	FrameReassembler reassembler(MaxFrame);
+
+	std::vector<uint8_t> frame(450, 7);
+	auto datagrams = fragment(0, frame, 0);
+	datagrams[2].back() ^= 0x10;
+
+	EXPECT_FALSE(pushAll(reassembler, datagrams));
+	EXPECT_EQ(reassembler.getCorrupted(), 1u);
+
+	EXPECT_TRUE(pushAll(reassembler, fragment(1, frame, 0)));
+	EXPECT_TRUE(holds(reassembler, frame));
+}
+
+TEST(FrameReassembler, FrameIDWrapsAround){
+	FrameReassembler reassembler(MaxFrame);
+	std::vector<uint8_t> frame(300, 3);
+
+	for(uint16_t id : { (uint16_t) 65534, (uint16_t) 65535, (uint16_t) 0, (uint16_t) 1 }){
+		EXPECT_TRUE(pushAll(reassembler, fragment(id, frame, 0))) << id;
+	}
+	EXPECT_EQ(reassembler.getRestarts(), 0u);
+}
+
+TEST(FrameReassembler, RoverRestartIsPickedUpAfterALongJumpBack){
+	FrameReassembler reassembler(MaxFrame);
+	std::vector<uint8_t> frame(300, 4);
+
+	ASSERT_TRUE(pushAll(reassembler, fragment(500, frame, 0), 1000));
+
+	// Rover rebooted and counts from 0 again, right away
+	EXPECT_TRUE(pushAll(reassembler, fragment(0, frame, 0), 1010));
+	EXPECT_TRUE(pushAll(reassembler, fragment(1, frame, 0), 1020));
+	EXPECT_EQ(reassembler.getRestarts(), 1u);
+}
+
+TEST(FrameReassembler, RoverRestartIsPickedUpAfterTimeout){
+	FrameReassembler reassembler(MaxFrame);
+	std::vector<uint8_t> frame(300, 5);
+
+	// Restarted after only a few frames, so the jump back is within the reorder window
+	ASSERT_TRUE(pushAll(reassembler, fragment(5, frame, 0), 1000));
+	EXPECT_FALSE(pushAll(reassembler, fragment(0, frame, 0), 1100));
+	EXPECT_FALSE(pushAll(reassembler, fragment(1, frame, 0), 1200));
+
+	EXPECT_TRUE(pushAll(reassembler, fragment(2, frame, 0), 1000 + FrameReassembler::RestartTimeout));
+	EXPECT_EQ(reassembler.getRestarts(), 1u);
+
+	// And from there on it's the normal stream again
+	EXPECT_TRUE(pushAll(reassembler, fragment(3, frame, 0), 1550));
+}
+
+TEST(FrameReassembler, OtherProtocolVersionsAreIgnored){
+	FrameReassembler reassembler(MaxFrame);
+	std::vector<uint8_t> frame(250, 6);
+
+	EXPECT_FALSE(pushAll(reassembler, fragment(0, frame, 0, FeedProtocolVersion + 1)));
+	EXPECT_EQ(reassembler.getIncompatible(), 3u);
+	EXPECT_EQ(reassembler.getCompleted(), 0u);
+
+	EXPECT_TRUE(pushAll(reassembler, fragment(1, frame, 0)));
+}
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include "Util/GrayDownscaler.h"
+
+/**
+ * The path GrayDownscaler replaced in MarkerScanner: a full-size gray frame with the per-pixel divisions,
+ * then cv::resize with INTER_LINEAR. OpenCV isn't available on the host, so the resize is OpenCV 4.2's scalar
+ * fixed-point arithmetic (resize.cpp, HResizeLinear + VResizeLinear with FixedPtCast), written out.
+ */
+static std::vector<uint8_t> referenceGray(const std::vector<uint8_t>& rgb565, int width, int height){
+	std::vector<uint8_t> gray(width * height);
+
+	for(size_t i = 0; i < gray.size(); ++i){
+		uint16_t color = rgb565[2 * i] | (rgb565[2 * i + 1] << 8);
+		color = (color >> 8) | (color << 8);
+
+		uint8_t r = (color & 0xF800) >> 11;
+		uint8_t g = (color & 0x07E0) >> 5;
+		uint8_t b = (color & 0x001F);
+
+		r = std::clamp((r * 255) / 31, 0, 255);
+		g = std::clamp((g * 255) / 63, 0, 255);
+		b = std::clamp((b * 255) / 31, 0, 255);
+
+		gray[i] = (r + g + b) / 3;
+	}
+
+	return gray;
+}
+
+struct ReferenceTap {
+	int index;
+	int16_t alpha[2];
+};
+
+static std::vector<ReferenceTap> referenceTaps(int srcSize, int dstSize, double invScale){
+	constexpr int CoefScale = 1 << 11;
+	const double scale = 1. / invScale;
+
+	std::vector<ReferenceTap> taps(dstSize);
+	for(int d = 0; d < dstSize; ++d){
+		float f = (float) ((d + 0.5) * scale - 0.5);
+		int s = (int) std::floor(f);
+		f -= (float) s;
+
+		if(s < 0){
+			f = 0, s = 0;
+		}
+		if(s >= srcSize - 1){
+			f = 0, s = srcSize - 1;
+		}
+
+		taps[d].index = s;
+		taps[d].alpha[0] = (int16_t) std::lrint((1.f - f) * CoefScale);
+		taps[d].alpha[1] = (int16_t) std::lrint(f * CoefScale);
+	}
+
+	return taps;
+}
+
+static std::vector<uint8_t> referenceResize(const std::vector<uint8_t>& src, int width, int height, int dstWidth, int dstHeight, double scale){
+	const auto xTaps = referenceTaps(width, dstWidth, scale);
+	const auto yTaps = referenceTaps(height, dstHeight, scale);
+
+	auto hResize = [&](int row){
+		std::vector<int> line(dstWidth);
+		const uint8_t* s = src.data() + row * width;
+
+		for(int dx = 0; dx < dstWidth; ++dx){
+			const ReferenceTap& tap = xTaps[dx];
+			const int next = std::min(tap.index + 1, width - 1);
+			line[dx] = s[tap.index] * tap.alpha[0] + s[next] * tap.alpha[1];
+		}
+		return line;
+	};
+
+	std::vector<uint8_t> dst(dstWidth * dstHeight);
+	for(int dy = 0; dy < dstHeight; ++dy){
+		const ReferenceTap& tap = yTaps[dy];
+		const auto top = hResize(tap.index);
+		const auto bottom = hResize(std::min(tap.index + 1, height - 1));
+
+		for(int dx = 0; dx < dstWidth; ++dx){
+			const int value = (tap.alpha[0] * top[dx] + tap.alpha[1] * bottom[dx] + (1 << 21)) >> 22;
+			dst[dy * dstWidth + dx] = std::clamp(value, 0, 255);
+		}
+	}
+
+	return dst;
+}
+
+static std::vector<uint8_t> randomFrame(int width, int height, uint32_t seed){
+	std::mt19937 rng(seed);
+	std::vector<uint8_t> frame(width * height * 2);
+	for(auto& byte : frame){
+		byte = rng();
+	}
+	return frame;
+}
+
+struct Case {
+	uint16_t width;
+	uint16_t height;
+	float scale;
+};
+
+// The scanner's own 160x120 at 0.6, plus odd and tiny sizes that hit the single-pixel tail of the wide path
+static const Case Cases[] = {
+		{ 160, 120, 0.6f }, { 160, 120, 1.0f }, { 160, 120, 0.5f }, { 161, 121, 0.6f }, { 159, 119, 0.6f },
+		{ 163, 97, 0.37f }, { 7, 5, 0.6f }, { 3, 3, 1.0f }, { 2, 2, 0.5f }, { 1, 9, 1.0f }, { 33, 1, 0.8f },
+};
+
+TEST(GrayDownscaler, WidePathMatchesScalarPath){
+	uint32_t seed = 1;
+	for(const Case& c : Cases){
+		GrayDownscaler downscaler(c.width, c.height, c.scale);
+		const size_t size = downscaler.getWidth() * downscaler.getHeight();
+
+		for(int i = 0; i < 4; ++i){
+			const auto frame = randomFrame(c.width, c.height, seed++);
+
+			std::vector<uint8_t> wide(size), scalar(size);
+			downscaler.process(frame.data(), wide.data());
+			downscaler.processScalar(frame.data(), scalar.data());
+
+			ASSERT_EQ(wide, scalar) << c.width << "x" << c.height << " at " << c.scale;
+		}
+	}
+}
+
+TEST(GrayDownscaler, LumaMatchesPerPixelDivisions){
+	for(uint32_t color = 0; color <= 0xFFFF; ++color){
+		const uint8_t r = ((color & 0xF800) >> 11) * 255 / 31;
+		const uint8_t g = ((color & 0x07E0) >> 5) * 255 / 63;
+		const uint8_t b = (color & 0x001F) * 255 / 31;
+
+		ASSERT_EQ(GrayDownscaler::luma(color), (r + g + b) / 3) << std::hex << color;
+	}
+}
+
+TEST(GrayDownscaler, MatchesGrayThenResize){
+	uint32_t seed = 100;
+	for(const Case& c : Cases){
+		GrayDownscaler downscaler(c.width, c.height, c.scale);
+		const int dstWidth = downscaler.getWidth();
+		const int dstHeight = downscaler.getHeight();
+
+		ASSERT_EQ(dstWidth, std::max(1L, std::lround(c.width * (double) c.scale)));
+		ASSERT_EQ(dstHeight, std::max(1L, std::lround(c.height * (double) c.scale)));
+
+		for(int i = 0; i < 4; ++i){
+			const auto frame = randomFrame(c.width, c.height, seed++);
+			const auto expected = referenceResize(referenceGray(frame, c.width, c.height), c.width, c.height, dstWidth, dstHeight, c.scale);
+
+			std::vector<uint8_t> fused(dstWidth * dstHeight);
+			downscaler.process(frame.data(), fused.data());
+
+			ASSERT_EQ(fused, expected) << c.width << "x" << c.height << " at " << c.scale;
+		}
+	}
+}
+
+TEST(GrayDownscaler, EdgeColumnsAndRowsArentLost){
+	// Black frame with a white last column and last row, at full size they have to come through untouched
+	constexpr uint16_t Width = 161, Height = 121;
+	std::vector<uint8_t> frame(Width * Height * 2, 0);
+	for(uint16_t y = 0; y < Height; ++y){
+		for(uint16_t x = 0; x < Width; ++x){
+			if(x != Width - 1 && y != Height - 1) continue;
+			frame[2 * (y * Width + x)] = 0xFF;
+			frame[2 * (y * Width + x) + 1] = 0xFF;
+		}
+	}
+
+	GrayDownscaler downscaler(Width, Height, 1.0f);
+	std::vector<uint8_t> out(Width * Height);
+
+	for(bool wide : { true, false }){
+		if(wide){
+			downscaler.process(frame.data(), out.data());
+		}else{
+			downscaler.processScalar(frame.data(), out.data());
+		}
+
+		for(uint16_t y = 0; y < Height; ++y){
+			for(uint16_t x = 0; x < Width; ++x){
+				const bool edge = x == Width - 1 || y == Height - 1;
+				ASSERT_EQ(out[y * Width + x], edge ? 255 : 0) << x << ", " << y << (wide ? " wide" : " scalar");
+			}
+		}
+	}
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "Util/LatestReading.h"
+
+// Same timing as ModulePublisher, in [us]
+static constexpr int64_t Interval = 200 * 1000;
+static constexpr int64_t IdlePoll = 20 * 1000;
+
+struct Published {
+	int value;
+	int64_t sampled;
+};
+
+class LatestReadingTest : public ::testing::Test {
+protected:
+	int64_t update(LatestReading<int>& latest, int64_t now){
+		return latest.update(now, [this](const int& value, int64_t sampled){
+			published.push_back({ value, sampled });
+		});
+	}
+
+	std::vector<Published> published;
+};
+
+TEST_F(LatestReadingTest, WaitsOutTheInterval){
+	LatestReading<int> latest(Interval, IdlePoll);
+
+	latest.report(1, 1000);
+	EXPECT_EQ(update(latest, 50 * 1000), Interval - 50 * 1000);
+	EXPECT_TRUE(published.empty());
+
+	EXPECT_EQ(update(latest, Interval), Interval);
+	ASSERT_EQ(published.size(), 1u);
+	EXPECT_EQ(published[0].value, 1);
+
+	// The next interval counts from the publish
+	latest.report(2, Interval + 1000);
+	EXPECT_EQ(update(latest, Interval + 150 * 1000), 50 * 1000);
+	EXPECT_EQ(published.size(), 1u);
+
+	EXPECT_EQ(update(latest, 2 * Interval), Interval);
+	ASSERT_EQ(published.size(), 2u);
+	EXPECT_EQ(published[1].value, 2);
+}
+
+TEST_F(LatestReadingTest, PollsUntilAFreshReadingComesIn){
+	LatestReading<int> latest(Interval, IdlePoll);
+
+	EXPECT_EQ(update(latest, Interval), IdlePoll);
+	EXPECT_TRUE(published.empty());
+
+	latest.report(1, Interval + 5000);
+	EXPECT_EQ(update(latest, Interval + IdlePoll), Interval);
+	ASSERT_EQ(published.size(), 1u);
+
+	// The same reading isn't published twice
+	EXPECT_EQ(update(latest, 3 * Interval), IdlePoll);
+	EXPECT_EQ(published.size(), 1u);
+}
+
+TEST_F(LatestReadingTest, OnlyTheLatestReadingIsPublishedWithItsSampleTime){
+	LatestReading<int> latest(Interval, IdlePoll);
+
+	latest.report(1, 10 * 1000);
+	latest.report(2, 20 * 1000);
+	latest.report(3, 30 * 1000);
+
+	update(latest, Interval + 100 * 1000);
+	ASSERT_EQ(published.size(), 1u);
+	EXPECT_EQ(published[0].value, 3);
+	EXPECT_EQ(published[0].sampled, 30 * 1000);
+}
+
+TEST_F(LatestReadingTest, ZeroIntervalPublishesEveryReading){
+	LatestReading<int> latest(0, IdlePoll);
+
+	for(int i = 0; i < 3; i++){
+		latest.report(i, i * 1000);
+		EXPECT_EQ(update(latest, i * 1000 + 500), IdlePoll);
+	}
+
+	ASSERT_EQ(published.size(), 3u);
+	for(int i = 0; i < 3; i++){
+		EXPECT_EQ(published[i].value, i);
+		EXPECT_EQ(published[i].sampled, i * 1000);
+	}
+
+	EXPECT_EQ(update(latest, 10 * 1000), IdlePoll);
+	EXPECT_EQ(published.size(), 3u);
+}
+
+TEST_F(LatestReadingTest, RestartCountsTheIntervalFromZero){
+	LatestReading<int> latest(Interval, IdlePoll);
+
+	latest.report(1, 0);
+	update(latest, 10 * Interval);
+	ASSERT_EQ(published.size(), 1u);
+
+	// A recreated publisher sends the first fresh reading without waiting out the old interval
+	latest.restart();
+	latest.report(2, 10 * Interval + 1000);
+	EXPECT_EQ(update(latest, 10 * Interval + 2000), Interval);
+	EXPECT_EQ(published.size(), 2u);
+}
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Renders the labelled ScannerBench corpus: raw RGB565 160x120 frames, byte order as returned by esp_camera_fb_get.
+
+The file name starts with the ID of the marker in the frame, or "none" if there is none, see main/examples/ScannerBench.cpp.
+Frames are synthetic: the marker is warped onto a textured background at 4x resolution, then downsampled, blurred,
+lit unevenly and given sensor noise. Recorded frames can be added next to them under the same naming.
+
+Needs numpy and opencv-python. Output is deterministic, re-run it after changing a case:
+    python3 test/ScanBench/generate.py
+"""
+
+import os
+import numpy as np
+import cv2
+
+Width, Height = 160, 120
+Super = 4
+
+# Row codewords from ArucoValidator::hammingDistance, each row carries two bits of the ID
+Codewords = [[1, 0, 0, 0, 0], [1, 0, 1, 1, 1], [0, 1, 0, 0, 1], [0, 1, 1, 1, 0]]
+
+
+def marker(id):
+	"""9x9 cells: black quiet zone, white 7x7 border, data cells black for 1."""
+	cells = np.zeros((9, 9), np.uint8)
+	cells[1:8, 1:8] = 255
+	for row in range(5):
+		word = Codewords[(id >> (8 - 2 * row)) & 3]
+		for col in range(5):
+			cells[row + 2][col + 2] = 0 if word[col] else 255
+	return cells
+
+
+def background(rng, kind):
+	h, w = Height * Super, Width * Super
+	if kind == "desk":
+		base = rng.normal(150, 8, (h // 16, w // 16))
+		img = cv2.resize(base, (w, h), interpolation=cv2.INTER_CUBIC)
+	elif kind == "floor":
+		img = np.full((h, w), 120.0)
+		for y in range(0, h, 96):
+			img[y:y + 3, :] = 70
+		for x in range(0, w, 96):
+			img[:, x:x + 3] = 70
+	elif kind == "boxes":
+		# Dark rectangles that are quads but not markers
+		img = np.full((h, w), 200.0)
+		for _ in range(5):
+			x, y = rng.integers(0, w - 120), rng.integers(0, h - 120)
+			s = rng.integers(60, 160)
+			img[y:y + s, x:x + s] = rng.integers(20, 80)
+			img[y + s // 4:y + 3 * s // 4, x + s // 4:x + 3 * s // 4] = 230
+	else:
+		img = np.full((h, w), 210.0)
+	return img
+
+
+def render(id, size, center, angle=0.0, tilt=0.0, bg="plain", light=1.0, gradient=0.0, noise=2.0, blur=0.6, seed=0):
+	rng = np.random.default_rng(seed)
+	img = background(rng, bg)
+
+	if id is not None:
+		cells = marker(id).astype(np.float64)
+		src = np.float32([[0, 0], [9, 0], [9, 9], [0, 9]])
+
+		# Square of the given side in frame pixels, rotated in plane, one side foreshortened by the tilt
+		half = size / 2.0
+		corners = np.array([[-half, -half], [half, -half], [half, half], [-half, half]])
+		corners[1:3, 1] *= 1.0 - tilt
+		rot = np.array([[np.cos(angle), -np.sin(angle)], [np.sin(angle), np.cos(angle)]])
+		dst = (corners @ rot.T + center) * Super
+
+		transform = cv2.getPerspectiveTransform(src, dst.astype(np.float32))
+		warped = cv2.warpPerspective(cv2.resize(cells, (9 * 16, 9 * 16), interpolation=cv2.INTER_NEAREST), transform @ np.diag([1 / 16, 1 / 16, 1]),
+									 (Width * Super, Height * Super), flags=cv2.INTER_LINEAR, borderValue=-1)
+		mask = cv2.warpPerspective(np.ones((9 * 16, 9 * 16)), transform @ np.diag([1 / 16, 1 / 16, 1]), (Width * Super, Height * Super),
+								   flags=cv2.INTER_LINEAR)
+		img = img * (1 - mask) + np.clip(warped, 0, 255) * mask
+
+	img = cv2.resize(img, (Width, Height), interpolation=cv2.INTER_AREA)
+	if blur > 0:
+		img = cv2.GaussianBlur(img, (0, 0), blur)
+
+	ramp = np.linspace(1.0 - gradient, 1.0, Width)[None, :]
+	img = img * light * ramp + rng.normal(0, noise, img.shape)
+	img = np.clip(img, 0, 255)
+
+	# Slightly warm sensor tint, then pack as RGB565 with the bytes swapped like the camera delivers them
+	r = np.clip(img * 1.05, 0, 255).astype(np.uint16)
+	g = img.astype(np.uint16)
+	b = np.clip(img * 0.92, 0, 255).astype(np.uint16)
+	color = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+	return color.astype(">u2").tobytes()
+
+
+Center = (80, 60)
+
+Cases = {
+	"5_near_center": dict(id=5, size=70, center=Center),
+	"12_mid_plain": dict(id=12, size=45, center=(70, 55), seed=1),
+	"300_mid_desk": dict(id=300, size=45, center=(95, 62), bg="desk", seed=2),
+	"47_far": dict(id=47, size=26, center=(60, 50), seed=3),
+	"1000_far_floor": dict(id=1000, size=22, center=(110, 70), bg="floor", seed=4),
+	"7_rotated": dict(id=7, size=50, center=Center, angle=0.5, seed=5),
+	"129_tilted": dict(id=129, size=55, center=(75, 60), tilt=0.35, seed=6),
+	"64_rotated_tilted": dict(id=64, size=48, center=(85, 58), angle=-0.8, tilt=0.25, bg="desk", seed=7),
+	"18_dim": dict(id=18, size=50, center=Center, light=0.35, noise=3.0, seed=8),
+	"555_uneven_light": dict(id=555, size=50, center=Center, light=0.9, gradient=0.6, seed=9),
+	"90_edge": dict(id=90, size=40, center=(135, 30), seed=10),
+	"none_plain": dict(id=None, size=0, center=Center, seed=11),
+	"none_desk": dict(id=None, size=0, center=Center, bg="desk", seed=12),
+	"none_floor": dict(id=None, size=0, center=Center, bg="floor", seed=13),
+	"none_boxes": dict(id=None, size=0, center=Center, bg="boxes", seed=14),
+}
+
+if __name__ == "__main__":
+	out = os.path.dirname(os.path.abspath(__file__))
+	for name, case in Cases.items():
+		with open(os.path.join(out, name + ".rgb"), "wb") as file:
+			file.write(render(**case))
+	print(f"{len(Cases)} frames in {out}")
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <algorithm>
+#include <thread>
+#include "Util/Scheduler.h"
+#include "TestUtil.h"
+
+TEST(Scheduler, PeriodicJobKeepsItsInterval){
+	std::atomic<uint32_t> runs = 0;
+	Scheduler::Job job("periodic", pdMS_TO_TICKS(10), [&runs](){ runs++; });
+
+	Scheduler::add(&job);
+	vTaskDelay(pdMS_TO_TICKS(205));
+	Scheduler::remove(&job);
+
+	// First run is due right away, then one every 10 ms
+	EXPECT_GE(runs, 18u);
+	EXPECT_LE(runs, 22u);
+	EXPECT_FALSE(job.active());
+}
+
+TEST(Scheduler, TriggeredJobRunsOncePerTrigger){
+	std::atomic<uint32_t> runs = 0;
+	Scheduler::Job job("once", 0, [&runs](){ runs++; });
+
+	Scheduler::trigger(&job);
+	ASSERT_TRUE(waitUntil([&runs](){ return runs == 1; }));
+	ASSERT_TRUE(waitUntil([&job](){ return !job.active(); }));
+
+	vTaskDelay(pdMS_TO_TICKS(30));
+	EXPECT_EQ(runs, 1u);
+
+	Scheduler::trigger(&job);
+	ASSERT_TRUE(waitUntil([&runs](){ return runs == 2; }));
+
+	Scheduler::remove(&job);
+}
+
+TEST(Scheduler, PendingTriggersCoalesce){
+	std::atomic<uint32_t> runs = 0;
+	Scheduler::Job job("coalesce", 0, [&runs](){ runs++; });
+
+	for(int i = 0; i < 5; ++i){
+		Scheduler::trigger(&job, pdMS_TO_TICKS(20));
+	}
+
+	vTaskDelay(pdMS_TO_TICKS(80));
+	EXPECT_EQ(runs, 1u);
+
+	Scheduler::remove(&job);
+}
+
+TEST(Scheduler, EarlierTriggerWins){
+	std::atomic<int64_t> ranAt = 0;
+	Scheduler::Job job("earlier", 0, [&ranAt](){ ranAt = esp_timer_get_time(); });
+
+	const int64_t start = esp_timer_get_time();
+	Scheduler::trigger(&job, pdMS_TO_TICKS(500));
+	Scheduler::trigger(&job, pdMS_TO_TICKS(10));
+
+	ASSERT_TRUE(waitUntil([&ranAt](){ return ranAt != 0; }, 200));
+	EXPECT_LT(ranAt - start, 100 * 1000);
+
+	Scheduler::remove(&job);
+}
+
+TEST(Scheduler, TriggerWhileRunningRunsAgainAfterwards){
+	std::atomic<uint32_t> runs = 0;
+	std::atomic_bool release = false;
+
+	Scheduler::Job job("rerun", 0, [&](){
+		runs++;
+		while(runs == 1 && !release){
+			vTaskDelay(1);
+		}
+	});
+
+	Scheduler::trigger(&job);
+	ASSERT_TRUE(waitUntil([&runs](){ return runs == 1; }));
+
+	// Both land on the run in progress, they only add up to one more run
+	Scheduler::trigger(&job);
+	Scheduler::trigger(&job);
+	release = true;
+
+	ASSERT_TRUE(waitUntil([&runs](){ return runs == 2; }));
+	vTaskDelay(pdMS_TO_TICKS(30));
+	EXPECT_EQ(runs, 2u);
+
+	Scheduler::remove(&job);
+}
+
+TEST(Scheduler, JobCanRetriggerItself){
+	std::atomic<uint32_t> runs = 0;
+	Scheduler::Job* self = nullptr;
+	Scheduler::Job job("self", 0, [&](){
+		if(++runs < 5){
+			Scheduler::trigger(self, pdMS_TO_TICKS(2));
+		}
+	});
+	self = &job;
+
+	Scheduler::trigger(&job);
+	ASSERT_TRUE(waitUntil([&runs](){ return runs == 5; }));
+	vTaskDelay(pdMS_TO_TICKS(20));
+	EXPECT_EQ(runs, 5u);
+
+	Scheduler::remove(&job);
+}
+
+TEST(Scheduler, RemoveWaitsForTheRunningJob){
+	std::atomic_bool inside = false;
+	std::atomic_bool finished = false;
+
+	Scheduler::Job job("slow", 0, [&](){
+		inside = true;
+		vTaskDelay(pdMS_TO_TICKS(50));
+		finished = true;
+	});
+
+	Scheduler::trigger(&job);
+	ASSERT_TRUE(waitUntil([&inside](){ return inside.load(); }));
+
+	Scheduler::remove(&job);
+	EXPECT_TRUE(finished);
+	EXPECT_FALSE(job.active());
+}
+
+TEST(Scheduler, RemovedJobDoesntRunAgain){
+	std::atomic<uint32_t> runs = 0;
+	Scheduler::Job job("removed", 0, [&runs](){ runs++; });
+
+	Scheduler::trigger(&job, pdMS_TO_TICKS(20));
+	Scheduler::remove(&job);
+
+	vTaskDelay(pdMS_TO_TICKS(50));
+	EXPECT_EQ(runs, 0u);
+}
+
+TEST(Scheduler, TriggerRacingRemoveDoesntReviveTheJob){
+	// Same as an event post hook still firing while its owner is being torn down
+	uint32_t revived = 0;
+
+	for(int i = 0; i < 100; ++i){
+		std::atomic<uint32_t> runs = 0;
+		std::atomic<bool> stop = false;
+		Scheduler::Job job("raced", 0, [&runs](){ runs++; });
+
+		std::thread poster([&](){
+			while(!stop){
+				Scheduler::trigger(&job);
+			}
+		});
+		ASSERT_TRUE(waitUntil([&runs](){ return runs > 0; }));
+
+		// Bounded, so a trigger that keeps the removal from going through shows up here instead of hanging
+		Scheduler::remove(&job, pdMS_TO_TICKS(200));
+		const uint32_t removedAt = runs;
+		revived += job.active();
+
+		// Triggers keep coming after remove() returned
+		vTaskDelay(pdMS_TO_TICKS(2));
+		stop = true;
+		poster.join();
+
+		vTaskDelay(pdMS_TO_TICKS(2));
+		revived += job.active() || runs != removedAt;
+
+		Scheduler::remove(&job);
+	}
+
+	EXPECT_EQ(revived, 0u);
+}
+
+TEST(Scheduler, WorkersRunJobsSideBySide){
+	std::atomic<uint32_t> started = 0;
+	auto fn = [&started](){
+		started++;
+
+		// Only returns once the other job is running too
+		const TickType_t start = xTaskGetTickCount();
+		while(started < 2 && xTaskGetTickCount() - start < pdMS_TO_TICKS(500)){
+			vTaskDelay(1);
+		}
+	};
+
+	Scheduler::Job a("sideA", 0, fn);
+	Scheduler::Job b("sideB", 0, fn);
+
+	const int64_t start = esp_timer_get_time();
+	Scheduler::trigger(&a);
+	Scheduler::trigger(&b);
+
+	ASSERT_TRUE(waitUntil([&](){ return !a.active() && !b.active() && started == 2; }, 1000));
+	EXPECT_LT(esp_timer_get_time() - start, 400 * 1000);
+
+	Scheduler::remove(&a);
+	Scheduler::remove(&b);
+}
+
+TEST(Scheduler, StatsListTriggeredJobsUntilRemoved){
+	Scheduler::Job job("listed", 0, [](){});
+
+	auto find = [](){
+		const auto stats = Scheduler::getStats();
+		return std::find_if(stats.begin(), stats.end(), [](const Scheduler::JobStats& s){ return strcmp(s.name, "listed") == 0; }) != stats.end();
+	};
+
+	Scheduler::trigger(&job);
+	ASSERT_TRUE(waitUntil([&job](){ return !job.active(); }));
+	EXPECT_TRUE(find());
+
+	Scheduler::remove(&job);
+	EXPECT_FALSE(find());
+}
@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+#include <dirent.h>
+#include <vector>
+#include "TestUtil.h"
+#include "Services/TCPServer.h"
+#include <lwip/sockets.h>
+
+/**
+ * The server's listening sockets live as long as the process, so every test shares one server
+ * and connects its own clients to it.
+ */
+class TCPServerTest : public ::testing::Test {
+protected:
+	static TCPServer& server(){
+		static TCPServer server;
+		return server;
+	}
+
+	static void SetUpTestSuite(){
+		server();
+	}
+
+	void TearDown() override{
+		if(server().isConnected()){
+			server().disconnect();
+		}
+		for(int fd : clients){
+			close(fd);
+		}
+	}
+
+	/**
+	 * Connects a client with a tiny receive buffer, so a client that doesn't read quickly stops the server's sends.
+	 */
+	int connectTo(uint16_t port){
+		const int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+		const int rcvBuf = 1024;
+		setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if(connect(fd, (sockaddr*) &addr, sizeof(addr)) != 0){
+			close(fd);
+			return -1;
+		}
+
+		clients.push_back(fd);
+		return fd;
+	}
+
+	/**
+	 * Shrinks the send buffer of the server's end of a client connection, found through the process' open descriptors.
+	 */
+	static void shrinkServerSide(int clientFd){
+		sockaddr_in local{};
+		socklen_t size = sizeof(local);
+		getsockname(clientFd, (sockaddr*) &local, &size);
+
+		DIR* dir = opendir("/proc/self/fd");
+		ASSERT_NE(dir, nullptr);
+
+		bool found = false;
+		while(dirent* entry = readdir(dir)){
+			const int fd = atoi(entry->d_name);
+			if(fd <= 2 || fd == clientFd) continue;
+
+			sockaddr_in peer{};
+			size = sizeof(peer);
+			if(getpeername(fd, (sockaddr*) &peer, &size) != 0 || size != sizeof(peer)) continue;
+			if(peer.sin_port != local.sin_port || peer.sin_addr.s_addr != local.sin_addr.s_addr) continue;
+
+			const int sndBuf = 1024;
+			setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndBuf, sizeof(sndBuf));
+			found = true;
+		}
+		closedir(dir);
+
+		ASSERT_TRUE(found);
+	}
+
+	int connectController(){
+		const int fd = connectTo(TCPServer::ControlPort);
+		if(fd == -1) return -1;
+
+		if(!waitUntil([](){ return server().accept(); })) return -1;
+		fcntl(fd, F_SETFL, O_NONBLOCK);
+		return fd;
+	}
+
+	/**
+	 * Reads whatever has arrived, at most max bytes.
+	 */
+	static void receive(int fd, std::vector<uint8_t>& into, size_t max = SIZE_MAX){
+		uint8_t buf[256];
+		while(max > 0){
+			const ssize_t now = recv(fd, buf, std::min(sizeof(buf), max), 0);
+			if(now <= 0) break;
+
+			into.insert(into.end(), buf, buf + now);
+			max -= now;
+		}
+	}
+
+	static bool inSequence(const std::vector<uint8_t>& received){
+		for(size_t i = 0; i < received.size(); i++){
+			if(received[i] != (uint8_t) (i * 7 + 1)) return false;
+		}
+		return true;
+	}
+
+	static constexpr size_t Packet = 6; // doesn't divide the buffer sizes, so partial sends split packets
+
+	/**
+	 * Writes the next Packet bytes of a byte sequence received() can check.
+	 */
+	static bool writeNext(size_t& offset, bool droppable = false){
+		uint8_t data[Packet];
+		for(size_t i = 0; i < Packet; i++){
+			data[i] = (uint8_t) ((offset + i) * 7 + 1);
+		}
+
+		if(!server().write(data, Packet, droppable)) return false;
+		offset += Packet;
+		return true;
+	}
+
+	std::vector<int> clients;
+};
+
+TEST_F(TCPServerTest, ControlDataGrowsTheBufferAndArrivesInOrder){
+	const int client = connectController();
+	ASSERT_NE(client, -1);
+	shrinkServerSide(client);
+
+	// A client that isn't reading until the kernel buffers are full and the send buffer has grown past TxBufSize
+	size_t written = 0;
+	while(server().getPending() <= TCPServer::TxBufSize){
+		ASSERT_TRUE(writeNext(written));
+		ASSERT_TRUE(server().flush());
+		ASSERT_LT(written, TCPServer::MaxTxBufSize / 2);
+	}
+
+	// Then reading in small bites, so flushes keep sending part of the buffer and compacting the rest down to the start
+	std::vector<uint8_t> received;
+	for(int round = 0; round < 300; round++){
+		for(int i = 0; i < 4; i++){
+			ASSERT_TRUE(writeNext(written));
+		}
+
+		ASSERT_TRUE(server().flush());
+		receive(client, received, 23);
+	}
+	EXPECT_GT(server().getPendingPeak(), TCPServer::TxBufSize);
+	EXPECT_LE(server().getPendingPeak(), TCPServer::MaxTxBufSize);
+
+	ASSERT_TRUE(waitUntil([&](){
+		server().flush();
+		receive(client, received);
+		return received.size() == written;
+	}, 2000));
+	EXPECT_EQ(server().getPending(), 0u);
+	EXPECT_TRUE(inSequence(received));
+}
+
+TEST_F(TCPServerTest, DroppableDataOnlyFitsIntoTxBufSize){
+	const int client = connectController();
+	ASSERT_NE(client, -1);
+
+	size_t written = 0;
+	while(written + Packet <= TCPServer::TxBufSize){
+		ASSERT_TRUE(writeNext(written, true));
+	}
+
+	// Telemetry is refused, a state packet still goes in behind it
+	EXPECT_FALSE(writeNext(written, true));
+	EXPECT_TRUE(writeNext(written));
+
+	std::vector<uint8_t> received;
+	ASSERT_TRUE(waitUntil([&](){
+		server().flush();
+		receive(client, received);
+		return received.size() == written;
+	}));
+	EXPECT_TRUE(inSequence(received));
+
+	EXPECT_TRUE(writeNext(written, true));
+}
+
+TEST_F(TCPServerTest, ControllerThatStopsReadingIsDisconnected){
+	const int client = connectController();
+	ASSERT_NE(client, -1);
+
+	size_t written = 0;
+	while(writeNext(written)){
+		ASSERT_LE(written, TCPServer::MaxTxBufSize);
+	}
+	EXPECT_GT(written + Packet, TCPServer::MaxTxBufSize);
+
+	// Cut off by the link task's next flush, not by the writer
+	EXPECT_TRUE(server().isConnected());
+	EXPECT_FALSE(server().flush());
+	EXPECT_FALSE(server().isConnected());
+
+	fcntl(client, F_SETFL, 0);
+	uint8_t byte;
+	EXPECT_EQ(recv(client, &byte, 1, 0), 0);
+
+	// The next controller starts afresh
+	const int next = connectController();
+	ASSERT_NE(next, -1);
+	written = 0;
+	EXPECT_TRUE(writeNext(written, true));
+	EXPECT_EQ(server().getPendingPeak(), Packet);
+}
+
+TEST_F(TCPServerTest, ObserverThatFallsBehindIsDroppedWithoutStallingTheController){
+	const int client = connectController();
+	ASSERT_NE(client, -1);
+
+	const int observer = connectTo(TCPServer::ObserverPort);
+	ASSERT_NE(observer, -1);
+	ASSERT_TRUE(waitUntil([](){
+		server().wait(1);
+		return server().getObserverCount() == 1;
+	}));
+	shrinkServerSide(observer);
+
+	size_t written = 0;
+	std::vector<uint8_t> received;
+	for(int round = 0; round < 400 && server().getObserverCount() > 0; round++){
+		for(int i = 0; i < 4; i++){
+			ASSERT_TRUE(writeNext(written, true));
+		}
+
+		ASSERT_TRUE(server().flush());
+		ASSERT_TRUE(waitUntil([&](){
+			server().flush();
+			receive(client, received);
+			return received.size() == written;
+		}));
+	}
+
+	EXPECT_EQ(server().getObserverCount(), 0u);
+	EXPECT_LE(server().getPendingPeak(), TCPServer::TxBufSize);
+	EXPECT_TRUE(inSequence(received));
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "Util/TelemetryLane.h"
+
+static constexpr uint32_t Interval = 100;
+
+struct Reading {
+	uint16_t key;
+	int32_t value;
+};
+
+using Lane = TelemetryLane<Reading, 3>;
+
+static std::vector<Reading> takeAll(Lane& lane, uint64_t now){
+	std::vector<Reading> sent;
+	lane.take(now, [&sent](const Reading& reading){
+		sent.push_back(reading);
+		return true;
+	});
+	return sent;
+}
+
+static void put(Lane& lane, uint16_t key, int32_t value){
+	ASSERT_TRUE(lane.put(key, { key, value }));
+}
+
+TEST(TelemetryLane, OnlyTheLatestReadingPerKeyIsSent){
+	Lane lane(Interval);
+
+	put(lane, 1, 10);
+	put(lane, 1, 11);
+	put(lane, 2, 20);
+	put(lane, 1, 12);
+	EXPECT_EQ(lane.getPending(), 2u);
+	EXPECT_EQ(lane.getCoalesced(), 2u);
+
+	const auto sent = takeAll(lane, 1000);
+	ASSERT_EQ(sent.size(), 2u);
+	EXPECT_EQ(sent[0].key, 1);
+	EXPECT_EQ(sent[0].value, 12);
+	EXPECT_EQ(sent[1].key, 2);
+	EXPECT_EQ(sent[1].value, 20);
+	EXPECT_EQ(lane.getSent(), 2u);
+	EXPECT_EQ(lane.getPending(), 0u);
+
+	// Nothing waiting, nothing to wake up for
+	EXPECT_EQ(lane.untilDue(1000), UINT64_MAX);
+	EXPECT_TRUE(takeAll(lane, 5000).empty());
+}
+
+TEST(TelemetryLane, EachKeyIsSentAtMostOncePerInterval){
+	Lane lane(Interval);
+
+	put(lane, 1, 10);
+	EXPECT_EQ(lane.untilDue(1000), 0u);
+	EXPECT_EQ(takeAll(lane, 1000).size(), 1u);
+
+	// A sensor reporting every 10 ms: readings in between are replaced, the next send is due exactly one interval later
+	for(uint64_t now = 1010; now < 1100; now += 10){
+		put(lane, 1, (int32_t) now);
+		EXPECT_TRUE(takeAll(lane, now).empty()) << now;
+		EXPECT_EQ(lane.untilDue(now), 1100 - now);
+	}
+
+	// Another key has a rate limit of its own
+	put(lane, 2, 20);
+	EXPECT_EQ(lane.untilDue(1090), 0u);
+	auto sent = takeAll(lane, 1090);
+	ASSERT_EQ(sent.size(), 1u);
+	EXPECT_EQ(sent[0].key, 2);
+
+	// Due without anything new being put, as when the link task wakes up on the timeout alone
+	EXPECT_EQ(lane.untilDue(1095), 5u);
+	sent = takeAll(lane, 1100);
+	ASSERT_EQ(sent.size(), 1u);
+	EXPECT_EQ(sent[0].value, 1090);
+	EXPECT_EQ(lane.getCoalesced(), 8u);
+}
+
+TEST(TelemetryLane, RefusedReadingStaysPending){
+	Lane lane(Interval);
+	put(lane, 1, 10);
+	put(lane, 2, 20);
+
+	// The link took the first one and then filled up
+	int calls = 0;
+	lane.take(1000, [&calls](const Reading&){ return ++calls == 1; });
+	EXPECT_EQ(calls, 2);
+	EXPECT_EQ(lane.getSent(), 1u);
+	EXPECT_EQ(lane.getPending(), 1u);
+
+	// A newer reading replaces it, and goes out as soon as the link takes it
+	put(lane, 2, 21);
+	const auto sent = takeAll(lane, 1001);
+	ASSERT_EQ(sent.size(), 1u);
+	EXPECT_EQ(sent[0].value, 21);
+}
+
+TEST(TelemetryLane, FullLaneDropsNewKeysUntilCleared){
+	Lane lane(Interval);
+	put(lane, 1, 10);
+	put(lane, 2, 20);
+	put(lane, 3, 30);
+
+	EXPECT_FALSE(lane.put(4, { 4, 40 }));
+	EXPECT_EQ(lane.getUsed(), 3u);
+
+	// Keys keep their slot after being sent
+	takeAll(lane, 1000);
+	EXPECT_FALSE(lane.put(4, { 4, 40 }));
+	put(lane, 3, 31);
+
+	lane.clear();
+	EXPECT_EQ(lane.getUsed(), 0u);
+	EXPECT_EQ(lane.getPending(), 0u);
+	put(lane, 4, 40);
+}
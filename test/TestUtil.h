@@ -0,0 +1,26 @@
+#ifndef PERSE_ROVER_TESTUTIL_H
+#define PERSE_ROVER_TESTUTIL_H
+
+#include <cstdint>
+#include <cstring>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+
+/**
+ * Polls condition every tick until it holds.
+ * @return false if it still didn't hold after timeout [ms]
+ */
+template<typename F>
+bool waitUntil(F condition, uint32_t timeout = 500){
+	const TickType_t start = xTaskGetTickCount();
+
+	while(!condition()){
+		if(xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeout)) return false;
+		vTaskDelay(1);
+	}
+
+	return true;
+}
+
+#endif //PERSE_ROVER_TESTUTIL_H
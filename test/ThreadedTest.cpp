@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <optional>
+#include "Util/Threaded.h"
+#include "TestUtil.h"
+
+static std::optional<Threaded::Stats> findStats(const char* name){
+	for(const auto& stats : Threaded::getStats()){
+		if(strcmp(stats.name, name) == 0) return stats;
+	}
+
+	return std::nullopt;
+}
+
+TEST(Threaded, ClosureLoopsUntilStopped){
+	std::atomic<uint32_t> loops = 0;
+	ThreadedClosure thread([&loops](){
+		loops++;
+		vTaskDelay(1);
+	}, "closure", 4 * 1024);
+
+	thread.start();
+	ASSERT_TRUE(waitUntil([&loops](){ return loops >= 10; }));
+	EXPECT_TRUE(thread.running());
+
+	thread.stop();
+	EXPECT_FALSE(thread.running());
+
+	const uint32_t stopped = loops;
+	vTaskDelay(pdMS_TO_TICKS(20));
+	EXPECT_EQ(loops, stopped);
+
+	const auto stats = findStats("closure");
+	ASSERT_TRUE(stats.has_value());
+	EXPECT_EQ(stats->loop.loops, stopped);
+	EXPECT_EQ(stats->stackSize, 4u * 1024);
+	EXPECT_EQ(stats->task, nullptr);
+}
+
+TEST(Threaded, LoopsAreBucketedByDuration){
+	ThreadedClosure thread([](){ vTaskDelay(pdMS_TO_TICKS(2)); }, "buckets", 4 * 1024);
+
+	thread.start();
+	vTaskDelay(pdMS_TO_TICKS(50));
+	thread.stop();
+
+	const auto stats = findStats("buckets");
+	ASSERT_TRUE(stats.has_value());
+
+	// 2 ms loops land in the 1 - 5 ms bucket
+	uint32_t total = 0;
+	for(uint32_t count : stats->loop.histogram){
+		total += count;
+	}
+	EXPECT_EQ(total, stats->loop.loops);
+	EXPECT_GT(stats->loop.histogram[2], 0u);
+	EXPECT_GE(stats->loop.max, 2000u);
+}
+
+TEST(Threaded, DedicatedSleepyThreadedKeepsItsInterval){
+	std::atomic<uint32_t> loops = 0;
+	SleepyThreadedClosure thread(10, [&loops](){ loops++; }, "dedicated", 4 * 1024);
+
+	thread.start();
+	vTaskDelay(pdMS_TO_TICKS(205));
+	thread.stop();
+
+	EXPECT_GE(loops, 17u);
+	EXPECT_LE(loops, 22u);
+}
+
+class SharedSleepy : public SleepyThreaded {
+public:
+	SharedSleepy() : SleepyThreaded(10, "shared"){}
+
+	~SharedSleepy() override{
+		stop();
+	}
+
+	std::atomic<uint32_t> loops = 0;
+
+private:
+	void sleepyLoop() override{
+		loops++;
+	}
+};
+
+TEST(Threaded, SharedSleepyThreadedRunsOnTheScheduler){
+	SharedSleepy thread;
+
+	thread.start();
+	vTaskDelay(pdMS_TO_TICKS(205));
+	EXPECT_TRUE(thread.running());
+
+	thread.pause();
+	EXPECT_FALSE(thread.running());
+	const uint32_t paused = thread.loops;
+	EXPECT_GE(paused, 18u);
+	EXPECT_LE(paused, 22u);
+
+	vTaskDelay(pdMS_TO_TICKS(30));
+	EXPECT_EQ(thread.loops, paused);
+
+	thread.resume();
+	ASSERT_TRUE(waitUntil([&thread, paused](){ return thread.loops > paused; }));
+
+	thread.stop();
+
+	const auto stats = findStats("shared");
+	ASSERT_TRUE(stats.has_value());
+	EXPECT_EQ(stats->stackSize, 0u);
+	EXPECT_EQ(stats->task, nullptr);
+	EXPECT_EQ(stats->loop.loops, thread.loops);
+}
+
+class SharedCallbacks : public SleepyThreaded {
+public:
+	SharedCallbacks() : SleepyThreaded(5, "callbacks"){}
+
+	~SharedCallbacks() override{
+		stop();
+	}
+
+	std::atomic<uint32_t> loops = 0;
+	std::atomic<uint32_t> starts = 0;
+	std::atomic<uint32_t> stops = 0;
+	std::atomic<bool> stopFromLoop = false;
+
+protected:
+	bool onStart() override{
+		starts++;
+		return true;
+	}
+
+	void onStop() override{
+		stops++;
+	}
+
+private:
+	void sleepyLoop() override{
+		loops++;
+		if(stopFromLoop){
+			stop();
+		}
+	}
+};
+
+TEST(Threaded, SharedModeThroughTheBaseClass){
+	SharedCallbacks thread;
+	Threaded& base = thread;
+
+	base.start();
+	ASSERT_TRUE(waitUntil([&thread](){ return thread.loops >= 3; }));
+	EXPECT_TRUE(base.running());
+	EXPECT_EQ(thread.starts, 1u);
+
+	// Still on the scheduler, no task of its own
+	const auto stats = findStats("callbacks");
+	ASSERT_TRUE(stats.has_value());
+	EXPECT_EQ(stats->task, nullptr);
+
+	base.stop();
+	EXPECT_FALSE(base.running());
+	EXPECT_EQ(thread.stops, 1u);
+
+	// Stopped from its own loop, onStop comes once that run is over
+	base.start();
+	EXPECT_EQ(thread.starts, 2u);
+	thread.stopFromLoop = true;
+	ASSERT_TRUE(waitUntil([&base](){ return !base.running(); }));
+	EXPECT_EQ(thread.stops, 2u);
+
+	const uint32_t stopped = thread.loops;
+	vTaskDelay(pdMS_TO_TICKS(20));
+	EXPECT_EQ(thread.loops, stopped);
+
+	// Stopping again does nothing
+	base.stop();
+	EXPECT_EQ(thread.stops, 2u);
+}
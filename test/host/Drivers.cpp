@@ -0,0 +1,75 @@
+#include <driver/gpio.h>
+#include <driver/i2c.h>
+#include <array>
+#include <atomic>
+
+// GPIO
+
+static std::array<std::atomic<uint8_t>, GPIO_NUM_MAX> levels{};
+
+esp_err_t gpio_config(const gpio_config_t* cfg){
+	if(cfg->pin_bit_mask >> GPIO_NUM_MAX) return ESP_ERR_INVALID_ARG;
+	return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level){
+	if(pin < 0 || pin >= GPIO_NUM_MAX) return ESP_ERR_INVALID_ARG;
+
+	levels[pin] = level != 0;
+	return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t pin){
+	if(pin < 0 || pin >= GPIO_NUM_MAX) return 0;
+	return levels[pin];
+}
+
+
+// I2C
+
+esp_err_t i2c_driver_install(i2c_port_t, i2c_mode_t, size_t, size_t, int){
+	return ESP_OK;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t){
+	return ESP_OK;
+}
+
+esp_err_t i2c_param_config(i2c_port_t, const i2c_config_t*){
+	return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create(){
+	static uint8_t link;
+	return &link;
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t){}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t){
+	return ESP_OK;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t, uint8_t, bool){
+	return ESP_OK;
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t){
+	return ESP_OK;
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t, i2c_cmd_handle_t, TickType_t){
+	return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t i2c_master_write_to_device(i2c_port_t, uint8_t, const uint8_t*, size_t, TickType_t){
+	return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t i2c_master_read_from_device(i2c_port_t, uint8_t, uint8_t*, size_t, TickType_t){
+	return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t i2c_master_write_read_device(i2c_port_t, uint8_t, const uint8_t*, size_t, uint8_t*, size_t, TickType_t){
+	return ESP_ERR_TIMEOUT;
+}
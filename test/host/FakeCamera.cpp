@@ -0,0 +1,148 @@
+#include "FakeCamera.h"
+#include <esp_timer.h>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <cstring>
+
+struct Buffer {
+	camera_fb_t fb{};
+	std::vector<uint8_t> data;
+	bool out = false;
+};
+
+static std::mutex mut;
+static bool inited = false;
+static std::vector<std::unique_ptr<Buffer>> buffers;
+static std::vector<std::unique_ptr<Buffer>> freed;
+static uint32_t sequence = 0;
+static FakeCamera::Stats stats;
+
+static int setFramesize(sensor_t*, framesize_t){ return 0; }
+static int setInt(sensor_t*, int){ return 0; }
+
+static sensor_t sensor = {
+	.set_framesize = setFramesize,
+	.set_quality = setInt,
+	.set_hmirror = setInt,
+	.set_vflip = setInt,
+	.set_gain_ctrl = setInt
+};
+
+static Buffer* find(camera_fb_t* fb){
+	for(auto& buffer : buffers){
+		if(&buffer->fb == fb) return buffer.get();
+	}
+	return nullptr;
+}
+
+static void deinitLocked(){
+	for(auto& buffer : buffers){
+		if(buffer->out){
+			stats.framesOutAtDeinit++;
+		}
+
+		memset(buffer->data.data(), FakeCamera::Poison, buffer->data.size());
+		freed.push_back(std::move(buffer));
+	}
+
+	buffers.clear();
+	inited = false;
+}
+
+esp_err_t esp_camera_init(const camera_config_t* config){
+	std::lock_guard lock(mut);
+	if(inited) return ESP_ERR_INVALID_STATE;
+
+	for(size_t i = 0; i < config->fb_count; ++i){
+		auto buffer = std::make_unique<Buffer>();
+		buffer->data.resize(FakeCamera::FrameSize);
+		buffer->fb.buf = buffer->data.data();
+		buffer->fb.len = buffer->data.size();
+		buffer->fb.format = config->pixel_format;
+		buffers.push_back(std::move(buffer));
+	}
+
+	inited = true;
+	stats.inits++;
+	return ESP_OK;
+}
+
+esp_err_t esp_camera_deinit(){
+	std::lock_guard lock(mut);
+	if(!inited) return ESP_ERR_INVALID_STATE;
+
+	deinitLocked();
+	stats.deinits++;
+	return ESP_OK;
+}
+
+camera_fb_t* esp_camera_fb_get(){
+	std::lock_guard lock(mut);
+	if(!inited) return nullptr;
+
+	// The driver would wait for a buffer to come back and time out, there's no capture to wait for here
+	for(auto& buffer : buffers){
+		if(buffer->out) continue;
+
+		const int64_t now = esp_timer_get_time();
+		buffer->fb.timestamp.tv_sec = now / 1000000;
+		buffer->fb.timestamp.tv_usec = now % 1000000;
+		memset(buffer->data.data(), FakeCamera::sequenceByte(sequence++), buffer->data.size());
+
+		buffer->out = true;
+		stats.framesTaken++;
+		return &buffer->fb;
+	}
+
+	return nullptr;
+}
+
+void esp_camera_fb_return(camera_fb_t* fb){
+	std::lock_guard lock(mut);
+
+	Buffer* buffer = find(fb);
+	if(buffer == nullptr || !buffer->out){
+		stats.badReturns++;
+		return;
+	}
+
+	buffer->out = false;
+}
+
+sensor_t* esp_camera_sensor_get(){
+	std::lock_guard lock(mut);
+	return inited ? &sensor : nullptr;
+}
+
+FakeCamera::Stats FakeCamera::stats(){
+	std::lock_guard lock(mut);
+	return ::stats;
+}
+
+size_t FakeCamera::framesOut(){
+	std::lock_guard lock(mut);
+
+	size_t out = 0;
+	for(const auto& buffer : buffers){
+		out += buffer->out;
+	}
+	return out;
+}
+
+uint8_t FakeCamera::sequenceByte(uint32_t sequence){
+	// Skips Poison, so a frame can always be told apart from a freed buffer
+	const uint8_t byte = sequence & 0xFF;
+	return byte == Poison ? byte + 1 : byte;
+}
+
+void FakeCamera::reset(){
+	std::lock_guard lock(mut);
+
+	if(inited){
+		deinitLocked();
+	}
+	freed.clear();
+	sequence = 0;
+	::stats = {};
+}
@@ -0,0 +1,42 @@
+#ifndef PERSE_ROVER_HOST_FAKECAMERA_H
+#define PERSE_ROVER_HOST_FAKECAMERA_H
+
+#include <esp_camera.h>
+
+/**
+ * What the esp32-camera stand-in was asked to do, for the tests to check against.
+ */
+namespace FakeCamera {
+
+struct Stats {
+	uint32_t inits = 0;
+	uint32_t deinits = 0;
+	uint32_t framesTaken = 0;
+	uint32_t framesOutAtDeinit = 0; // buffers the driver freed while someone still had them
+	uint32_t badReturns = 0; // returned twice, after deinit or never handed out
+};
+
+Stats stats();
+
+/**
+ * @return Buffers currently handed out and not returned
+ */
+size_t framesOut();
+
+/**
+ * Buffers are filled with the low byte of their frame's sequence number, and with Poison once the driver freed them.
+ * Freed buffers stay allocated until reset(), so a late reader sees Poison instead of crashing.
+ */
+static constexpr uint8_t Poison = 0xDD;
+static constexpr size_t FrameSize = 256;
+
+uint8_t sequenceByte(uint32_t sequence);
+
+/**
+ * Deinitializes the driver if it's still running and clears the stats.
+ */
+void reset();
+
+}
+
+#endif //PERSE_ROVER_HOST_FAKECAMERA_H
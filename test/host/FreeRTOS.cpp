@@ -0,0 +1,282 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <esp_timer.h>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <array>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+using Clock = std::chrono::steady_clock;
+
+int64_t esp_timer_get_time(){
+	// Local static, other static initializers may already ask for the time
+	static const Clock::time_point boot = Clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - boot).count();
+}
+
+void esp_rom_delay_us(uint32_t us){
+	const auto end = Clock::now() + std::chrono::microseconds(us);
+	while(Clock::now() < end);
+}
+
+/**
+ * Waits on cv until ready() holds, forever for portMAX_DELAY.
+ * @return false if the timeout ran out first
+ */
+template<typename Ready>
+static bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, TickType_t timeout, Ready ready){
+	if(timeout == portMAX_DELAY){
+		cv.wait(lock, ready);
+		return true;
+	}
+
+	return cv.wait_for(lock, std::chrono::milliseconds(timeout * portTICK_PERIOD_MS), ready);
+}
+
+
+// Tasks
+
+struct tskTaskControlBlock {
+	char name[configMAX_TASK_NAME_LEN] = {};
+
+	std::mutex mut;
+	std::condition_variable cv;
+	std::array<uint32_t, configTASK_NOTIFICATION_ARRAY_ENTRIES> notifications{};
+};
+
+// Thrown by vTaskDelete(nullptr) to unwind the task's thread
+struct TaskExit {};
+
+// Handles are never freed, a late notification to a finished task only lands in a dead block
+static std::mutex tasksMut;
+static std::vector<std::unique_ptr<tskTaskControlBlock>> tasks;
+static std::atomic<UBaseType_t> liveTasks = 0;
+
+static thread_local TaskHandle_t currentTask = nullptr;
+
+static TaskHandle_t newTask(const char* name){
+	auto task = std::make_unique<tskTaskControlBlock>();
+	strncpy(task->name, name, sizeof(task->name) - 1);
+
+	std::lock_guard lock(tasksMut);
+	tasks.push_back(std::move(task));
+	return tasks.back().get();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t, void* arg, UBaseType_t, TaskHandle_t* handle, BaseType_t){
+	TaskHandle_t task = newTask(name);
+	if(handle){
+		*handle = task;
+	}
+
+	liveTasks++;
+
+	std::thread([fn, arg, task](){
+		currentTask = task;
+
+		try{
+			fn(arg);
+			fprintf(stderr, "Task %s returned without deleting itself\n", task->name);
+			abort();
+		}catch(const TaskExit&){}
+
+		liveTasks--;
+	}).detach();
+
+	return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task){
+	if(task != nullptr && task != currentTask){
+		fprintf(stderr, "vTaskDelete of another task isn't supported on the host\n");
+		abort();
+	}
+
+	throw TaskExit();
+}
+
+void vTaskDelay(TickType_t ticks){
+	std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+TickType_t xTaskGetTickCount(){
+	return (TickType_t) (esp_timer_get_time() / (1000 * portTICK_PERIOD_MS));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(){
+	if(currentTask == nullptr){
+		currentTask = newTask("host");
+	}
+
+	return currentTask;
+}
+
+const char* pcTaskGetName(TaskHandle_t task){
+	if(task == nullptr){
+		task = xTaskGetCurrentTaskHandle();
+	}
+
+	return task->name;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(){
+	return liveTasks;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t){
+	return 0;
+}
+
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t index, BaseType_t clear, TickType_t timeout){
+	TaskHandle_t task = xTaskGetCurrentTaskHandle();
+	uint32_t& value = task->notifications.at(index);
+
+	std::unique_lock lock(task->mut);
+	waitFor(task->cv, lock, timeout, [&value](){ return value != 0; });
+
+	const uint32_t taken = value;
+	if(value != 0){
+		value = clear ? 0 : value - 1;
+	}
+
+	return taken;
+}
+
+BaseType_t xTaskNotifyGiveIndexed(TaskHandle_t task, UBaseType_t index){
+	{
+		std::lock_guard lock(task->mut);
+		task->notifications.at(index)++;
+	}
+
+	task->cv.notify_all();
+	return pdPASS;
+}
+
+void vTaskNotifyGiveIndexedFromISR(TaskHandle_t task, UBaseType_t index, BaseType_t* woken){
+	if(woken){
+		*woken = pdFALSE;
+	}
+
+	xTaskNotifyGiveIndexed(task, index);
+}
+
+
+// Queues and semaphores
+
+struct QueueDefinition {
+	const UBaseType_t length;
+	const UBaseType_t itemSize;
+
+	std::vector<uint8_t> storage;
+	UBaseType_t head = 0;
+	UBaseType_t count = 0;
+
+	std::mutex mut;
+	std::condition_variable notEmpty;
+	std::condition_variable notFull;
+
+	QueueDefinition(UBaseType_t length, UBaseType_t itemSize) : length(length), itemSize(itemSize), storage(length * itemSize){}
+
+	uint8_t* slot(UBaseType_t i){
+		return storage.data() + ((head + i) % length) * itemSize;
+	}
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize){
+	if(length == 0) return nullptr;
+
+	return new QueueDefinition(length, itemSize);
+}
+
+QueueHandle_t xQueueCreateCounting(UBaseType_t max, UBaseType_t initial){
+	QueueHandle_t queue = xQueueCreate(max, 0);
+	queue->count = initial;
+	return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue){
+	delete queue;
+}
+
+static BaseType_t send(QueueHandle_t queue, const void* item, TickType_t timeout, bool front){
+	std::unique_lock lock(queue->mut);
+	if(!waitFor(queue->notFull, lock, timeout, [queue](){ return queue->count < queue->length; })) return pdFALSE;
+
+	if(queue->itemSize != 0){
+		if(front){
+			queue->head = (queue->head + queue->length - 1) % queue->length;
+			memcpy(queue->slot(0), item, queue->itemSize);
+		}else{
+			memcpy(queue->slot(queue->count), item, queue->itemSize);
+		}
+	}
+	queue->count++;
+
+	lock.unlock();
+	queue->notEmpty.notify_one();
+	return pdTRUE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t timeout){
+	return send(queue, item, timeout, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t timeout){
+	return send(queue, item, timeout, true);
+}
+
+static BaseType_t receive(QueueHandle_t queue, void* item, TickType_t timeout, bool remove){
+	std::unique_lock lock(queue->mut);
+	if(!waitFor(queue->notEmpty, lock, timeout, [queue](){ return queue->count > 0; })) return pdFALSE;
+
+	if(queue->itemSize != 0){
+		memcpy(item, queue->slot(0), queue->itemSize);
+	}
+
+	if(!remove) return pdTRUE;
+
+	queue->head = (queue->head + 1) % queue->length;
+	queue->count--;
+
+	lock.unlock();
+	queue->notFull.notify_one();
+	return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t timeout){
+	return receive(queue, item, timeout, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t timeout){
+	return receive(queue, item, timeout, false);
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue){
+	{
+		std::lock_guard lock(queue->mut);
+		queue->head = 0;
+		queue->count = 0;
+	}
+
+	queue->notFull.notify_all();
+	return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue){
+	std::lock_guard lock(queue->mut);
+	return queue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue){
+	std::lock_guard lock(queue->mut);
+	return queue->length - queue->count;
+}
@@ -0,0 +1,14 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char** argv){
+	testing::InitGoogleTest(&argc, argv);
+	const int result = RUN_ALL_TESTS();
+
+	// Scheduler workers and other tasks are detached threads that live as long as the process, same as on the rover.
+	// Skip static destructors so they don't run into torn down singletons on the way out.
+	fflush(stdout);
+	fflush(stderr);
+	std::quick_exit(result);
+}
@@ -0,0 +1,21 @@
+#ifndef PERSE_ROVER_HOST_DRIVER_GPIO_H
+#define PERSE_ROVER_HOST_DRIVER_GPIO_H
+
+#include <hal/gpio_types.h>
+#include <esp_err.h>
+
+typedef struct {
+	uint64_t pin_bit_mask;
+	gpio_mode_t mode;
+	gpio_pullup_t pull_up_en;
+	gpio_pulldown_t pull_down_en;
+	gpio_int_type_t intr_type;
+} gpio_config_t;
+
+// Outputs only keep their level, so tests can read back what the firmware set
+
+esp_err_t gpio_config(const gpio_config_t* cfg);
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level);
+int gpio_get_level(gpio_num_t pin);
+
+#endif //PERSE_ROVER_HOST_DRIVER_GPIO_H
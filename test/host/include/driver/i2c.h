@@ -0,0 +1,44 @@
+#ifndef PERSE_ROVER_HOST_DRIVER_I2C_H
+#define PERSE_ROVER_HOST_DRIVER_I2C_H
+
+#include <hal/i2c_types.h>
+#include <driver/gpio.h>
+#include <freertos/FreeRTOS.h>
+#include <cstddef>
+
+typedef struct {
+	i2c_mode_t mode;
+	int sda_io_num;
+	int scl_io_num;
+	bool sda_pullup_en;
+	bool scl_pullup_en;
+	union {
+		struct {
+			uint32_t clk_speed;
+		} master;
+	};
+	uint32_t clk_flags;
+} i2c_config_t;
+
+typedef void* i2c_cmd_handle_t;
+
+/**
+ * An empty bus: the driver calls succeed, every transfer times out as if nothing answered.
+ */
+
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode, size_t slv_rx_buf_len, size_t slv_tx_buf_len, int intr_alloc_flags);
+esp_err_t i2c_driver_delete(i2c_port_t port);
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t* cfg);
+
+i2c_cmd_handle_t i2c_cmd_link_create();
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en);
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks_to_wait);
+
+esp_err_t i2c_master_write_to_device(i2c_port_t port, uint8_t addr, const uint8_t* data, size_t size, TickType_t ticks_to_wait);
+esp_err_t i2c_master_read_from_device(i2c_port_t port, uint8_t addr, uint8_t* data, size_t size, TickType_t ticks_to_wait);
+esp_err_t i2c_master_write_read_device(i2c_port_t port, uint8_t addr, const uint8_t* wbuf, size_t wsize, uint8_t* rbuf, size_t rsize, TickType_t ticks_to_wait);
+
+#endif //PERSE_ROVER_HOST_DRIVER_I2C_H
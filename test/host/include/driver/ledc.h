@@ -0,0 +1,22 @@
+#ifndef PERSE_ROVER_HOST_DRIVER_LEDC_H
+#define PERSE_ROVER_HOST_DRIVER_LEDC_H
+
+// Only the types the camera config refers to
+
+typedef enum {
+	LEDC_CHANNEL_0 = 0,
+	LEDC_CHANNEL_1,
+	LEDC_CHANNEL_2,
+	LEDC_CHANNEL_3,
+	LEDC_CHANNEL_MAX = 8
+} ledc_channel_t;
+
+typedef enum {
+	LEDC_TIMER_0 = 0,
+	LEDC_TIMER_1,
+	LEDC_TIMER_2,
+	LEDC_TIMER_3,
+	LEDC_TIMER_MAX
+} ledc_timer_t;
+
+#endif //PERSE_ROVER_HOST_DRIVER_LEDC_H
@@ -0,0 +1,8 @@
+#ifndef PERSE_ROVER_HOST_ESP_ATTR_H
+#define PERSE_ROVER_HOST_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_BSS_ATTR
+
+#endif //PERSE_ROVER_HOST_ESP_ATTR_H
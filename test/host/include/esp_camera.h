@@ -0,0 +1,105 @@
+#ifndef PERSE_ROVER_HOST_ESP_CAMERA_H
+#define PERSE_ROVER_HOST_ESP_CAMERA_H
+
+#include <esp_err.h>
+#include <driver/ledc.h>
+#include <sys/time.h>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * esp32-camera stand-in. The driver owns fb_count buffers, hands them out from esp_camera_fb_get() until they are
+ * returned and frees them on esp_camera_deinit(), same as on the device. FakeCamera.h reports what it was asked to do.
+ */
+
+typedef enum {
+	PIXFORMAT_RGB565,
+	PIXFORMAT_YUV422,
+	PIXFORMAT_YUV420,
+	PIXFORMAT_GRAYSCALE,
+	PIXFORMAT_JPEG,
+	PIXFORMAT_RGB888,
+	PIXFORMAT_RAW,
+	PIXFORMAT_RGB444,
+	PIXFORMAT_RGB555
+} pixformat_t;
+
+typedef enum {
+	FRAMESIZE_96X96,
+	FRAMESIZE_QQVGA,
+	FRAMESIZE_QCIF,
+	FRAMESIZE_HQVGA,
+	FRAMESIZE_240X240,
+	FRAMESIZE_QVGA,
+	FRAMESIZE_CIF,
+	FRAMESIZE_HVGA,
+	FRAMESIZE_VGA,
+	FRAMESIZE_INVALID
+} framesize_t;
+
+typedef enum {
+	CAMERA_FB_IN_PSRAM,
+	CAMERA_FB_IN_DRAM
+} camera_fb_location_t;
+
+typedef enum {
+	CAMERA_GRAB_WHEN_EMPTY,
+	CAMERA_GRAB_LATEST
+} camera_grab_mode_t;
+
+typedef struct {
+	int pin_pwdn;
+	int pin_reset;
+	int pin_xclk;
+	int pin_sccb_sda;
+	int pin_sccb_scl;
+	int pin_d7, pin_d6, pin_d5, pin_d4, pin_d3, pin_d2, pin_d1, pin_d0;
+	int pin_vsync;
+	int pin_href;
+	int pin_pclk;
+
+	int xclk_freq_hz;
+
+	ledc_timer_t ledc_timer;
+	ledc_channel_t ledc_channel;
+
+	pixformat_t pixel_format;
+	framesize_t frame_size;
+
+	int jpeg_quality;
+	size_t fb_count;
+	camera_fb_location_t fb_location;
+	camera_grab_mode_t grab_mode;
+
+	int sccb_i2c_port;
+} camera_config_t;
+
+typedef struct {
+	uint8_t* buf;
+	size_t len;
+	size_t width;
+	size_t height;
+	pixformat_t format;
+	struct timeval timestamp;
+} camera_fb_t;
+
+typedef struct _sensor sensor_t;
+struct _sensor {
+	int (*set_framesize)(sensor_t* sensor, framesize_t framesize);
+	int (*set_quality)(sensor_t* sensor, int quality);
+	int (*set_hmirror)(sensor_t* sensor, int enable);
+	int (*set_vflip)(sensor_t* sensor, int enable);
+	int (*set_gain_ctrl)(sensor_t* sensor, int enable);
+};
+
+#define ESP_ERR_CAMERA_BASE 0x20000
+#define ESP_ERR_CAMERA_NOT_DETECTED (ESP_ERR_CAMERA_BASE + 1)
+#define ESP_ERR_CAMERA_FAILED_TO_SET_FRAME_SIZE (ESP_ERR_CAMERA_BASE + 2)
+
+esp_err_t esp_camera_init(const camera_config_t* config);
+esp_err_t esp_camera_deinit();
+camera_fb_t* esp_camera_fb_get();
+void esp_camera_fb_return(camera_fb_t* fb);
+sensor_t* esp_camera_sensor_get();
+
+#endif //PERSE_ROVER_HOST_ESP_CAMERA_H
@@ -0,0 +1,41 @@
+#ifndef PERSE_ROVER_HOST_ESP_HEAP_CAPS_H
+#define PERSE_ROVER_HOST_ESP_HEAP_CAPS_H
+
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+// One host heap for every capability, sizes aren't tracked
+
+inline void* heap_caps_malloc(size_t size, uint32_t){
+	return malloc(size);
+}
+
+inline void* heap_caps_calloc(size_t count, size_t size, uint32_t){
+	return calloc(count, size);
+}
+
+inline void* heap_caps_realloc(void* ptr, size_t size, uint32_t){
+	return realloc(ptr, size);
+}
+
+inline void heap_caps_free(void* ptr){
+	free(ptr);
+}
+
+inline size_t heap_caps_get_free_size(uint32_t){
+	return 0;
+}
+
+inline size_t heap_caps_get_largest_free_block(uint32_t){
+	return 0;
+}
+
+#endif //PERSE_ROVER_HOST_ESP_HEAP_CAPS_H
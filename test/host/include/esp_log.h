@@ -0,0 +1,25 @@
+#ifndef PERSE_ROVER_HOST_ESP_LOG_H
+#define PERSE_ROVER_HOST_ESP_LOG_H
+
+#include <cstdio>
+
+/**
+ * Errors and warnings go to stderr. Info and debug logs are dropped unless HOST_LOG_VERBOSE is defined,
+ * the scheduler and task stats would drown the test output otherwise.
+ */
+#define HOST_LOG(letter, tag, format, ...) fprintf(stderr, letter " (%s) " format "\n", tag __VA_OPT__(,) __VA_ARGS__)
+
+#define ESP_LOGE(tag, format, ...) HOST_LOG("E", tag, format __VA_OPT__(,) __VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) HOST_LOG("W", tag, format __VA_OPT__(,) __VA_ARGS__)
+
+#ifdef HOST_LOG_VERBOSE
+#define ESP_LOGI(tag, format, ...) HOST_LOG("I", tag, format __VA_OPT__(,) __VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) HOST_LOG("D", tag, format __VA_OPT__(,) __VA_ARGS__)
+#else
+#define ESP_LOGI(tag, format, ...) do{ if(false) HOST_LOG("I", tag, format __VA_OPT__(,) __VA_ARGS__); }while(0)
+#define ESP_LOGD(tag, format, ...) do{ if(false) HOST_LOG("D", tag, format __VA_OPT__(,) __VA_ARGS__); }while(0)
+#endif
+
+#define ESP_LOGV(tag, format, ...) do{ if(false) HOST_LOG("V", tag, format __VA_OPT__(,) __VA_ARGS__); }while(0)
+
+#endif //PERSE_ROVER_HOST_ESP_LOG_H
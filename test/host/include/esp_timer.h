@@ -0,0 +1,11 @@
+#ifndef PERSE_ROVER_HOST_ESP_TIMER_H
+#define PERSE_ROVER_HOST_ESP_TIMER_H
+
+#include <cstdint>
+
+/**
+ * @return Microseconds of the host's steady clock since the process started
+ */
+int64_t esp_timer_get_time();
+
+#endif //PERSE_ROVER_HOST_ESP_TIMER_H
@@ -0,0 +1,31 @@
+#ifndef PERSE_ROVER_HOST_FREERTOS_H
+#define PERSE_ROVER_HOST_FREERTOS_H
+
+/**
+ * Host stand-in for the FreeRTOS API used by the firmware, backed by std::thread (see host/FreeRTOS.cpp).
+ * Every task is a real thread, so std::mutex and friends behave the same as under ESP-IDF's pthread layer.
+ * Ticks are milliseconds of the host's steady clock.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include "sdkconfig.h"
+
+#define configTICK_RATE_HZ CONFIG_FREERTOS_HZ
+#define configMAX_TASK_NAME_LEN 16
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES
+#define configUSE_TRACE_FACILITY 0
+
+#include "portmacro.h"
+
+#define pdFALSE ((BaseType_t) 0)
+#define pdTRUE ((BaseType_t) 1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define pdMS_TO_TICKS(ms) ((TickType_t) (((TickType_t) (ms) * (TickType_t) configTICK_RATE_HZ) / (TickType_t) 1000U))
+#define pdTICKS_TO_MS(ticks) ((TickType_t) (((uint64_t) (ticks) * (uint64_t) 1000U) / (uint64_t) configTICK_RATE_HZ))
+
+void esp_rom_delay_us(uint32_t us);
+
+#endif //PERSE_ROVER_HOST_FREERTOS_H
@@ -0,0 +1,16 @@
+#ifndef PERSE_ROVER_HOST_PORTMACRO_H
+#define PERSE_ROVER_HOST_PORTMACRO_H
+
+#include <cstdint>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t StackType_t;
+
+#define portMAX_DELAY ((TickType_t) 0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS ((TickType_t) 1000 / configTICK_RATE_HZ)
+#define portNUM_PROCESSORS 2
+#define portYIELD_FROM_ISR(...)
+
+#endif //PERSE_ROVER_HOST_PORTMACRO_H
@@ -0,0 +1,38 @@
+#ifndef PERSE_ROVER_HOST_QUEUE_H
+#define PERSE_ROVER_HOST_QUEUE_H
+
+#include "FreeRTOS.h"
+
+typedef struct QueueDefinition* QueueHandle_t;
+
+/**
+ * Items are copied in and out, same as the kernel queue. An itemSize of 0 makes a counting queue, used for semaphores.
+ */
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t queue);
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t timeout);
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t timeout);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t timeout);
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t timeout);
+BaseType_t xQueueReset(QueueHandle_t queue);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+
+#define xQueueSendToBack xQueueSend
+
+inline BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* woken){
+	if(woken){
+		*woken = pdFALSE;
+	}
+	return xQueueSend(queue, item, 0);
+}
+
+inline BaseType_t xQueueReceiveFromISR(QueueHandle_t queue, void* item, BaseType_t* woken){
+	if(woken){
+		*woken = pdFALSE;
+	}
+	return xQueueReceive(queue, item, 0);
+}
+
+#endif //PERSE_ROVER_HOST_QUEUE_H
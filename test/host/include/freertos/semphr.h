@@ -0,0 +1,21 @@
+#ifndef PERSE_ROVER_HOST_SEMPHR_H
+#define PERSE_ROVER_HOST_SEMPHR_H
+
+#include "queue.h"
+
+// Same as the kernel, semaphores are queues without item storage. Mutexes don't inherit priorities.
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+QueueHandle_t xQueueCreateCounting(UBaseType_t max, UBaseType_t initial);
+
+#define xSemaphoreCreateBinary() xQueueCreate(1, 0)
+#define xSemaphoreCreateMutex() xQueueCreateCounting(1, 1)
+#define xSemaphoreCreateCounting(max, initial) xQueueCreateCounting((max), (initial))
+#define vSemaphoreDelete(sem) vQueueDelete(sem)
+#define xSemaphoreTake(sem, timeout) xQueueReceive((sem), nullptr, (timeout))
+#define xSemaphoreGive(sem) xQueueSend((sem), nullptr, 0)
+#define xSemaphoreGiveFromISR(sem, woken) xQueueSendFromISR((sem), nullptr, (woken))
+#define uxSemaphoreGetCount(sem) uxQueueMessagesWaiting(sem)
+
+#endif //PERSE_ROVER_HOST_SEMPHR_H
@@ -0,0 +1,47 @@
+#ifndef PERSE_ROVER_HOST_TASK_H
+#define PERSE_ROVER_HOST_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef void (* TaskFunction_t)(void*);
+
+#define tskNO_AFFINITY ((BaseType_t) 0x7FFFFFFF)
+
+/**
+ * Priority and core are recorded but not enforced, the host scheduler decides where threads run.
+ * *handle is set before the task starts running.
+ */
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+
+inline BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg, UBaseType_t priority, TaskHandle_t* handle){
+	return xTaskCreatePinnedToCore(fn, name, stackDepth, arg, priority, handle, tskNO_AFFINITY);
+}
+
+/**
+ * Only a task deleting itself (nullptr) is supported, it unwinds the task's thread.
+ */
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+
+/**
+ * Threads that weren't created with xTaskCreate (the test's main thread) get a handle on first use,
+ * so they can block on and receive notifications as well.
+ */
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+const char* pcTaskGetName(TaskHandle_t task);
+UBaseType_t uxTaskGetNumberOfTasks();
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t index, BaseType_t clear, TickType_t timeout);
+BaseType_t xTaskNotifyGiveIndexed(TaskHandle_t task, UBaseType_t index);
+void vTaskNotifyGiveIndexedFromISR(TaskHandle_t task, UBaseType_t index, BaseType_t* woken);
+
+#define ulTaskNotifyTake(clear, timeout) ulTaskNotifyTakeIndexed(0, (clear), (timeout))
+#define xTaskNotifyGive(task) xTaskNotifyGiveIndexed((task), 0)
+#define vTaskNotifyGiveFromISR(task, woken) vTaskNotifyGiveIndexedFromISR((task), 0, (woken))
+
+#endif //PERSE_ROVER_HOST_TASK_H
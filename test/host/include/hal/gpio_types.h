@@ -0,0 +1,26 @@
+#ifndef PERSE_ROVER_HOST_HAL_GPIO_TYPES_H
+#define PERSE_ROVER_HOST_HAL_GPIO_TYPES_H
+
+#include <cstdint>
+
+// Pin numbers are passed through as they are, the host has no pins to check them against
+typedef enum {
+	GPIO_NUM_NC = -1,
+	GPIO_NUM_0 = 0,
+	GPIO_NUM_MAX = 49
+} gpio_num_t;
+
+typedef enum {
+	GPIO_MODE_DISABLE = 0,
+	GPIO_MODE_INPUT = 1,
+	GPIO_MODE_OUTPUT = 2,
+	GPIO_MODE_OUTPUT_OD = 6,
+	GPIO_MODE_INPUT_OUTPUT_OD = 7,
+	GPIO_MODE_INPUT_OUTPUT = 3
+} gpio_mode_t;
+
+typedef enum { GPIO_PULLUP_DISABLE = 0, GPIO_PULLUP_ENABLE = 1 } gpio_pullup_t;
+typedef enum { GPIO_PULLDOWN_DISABLE = 0, GPIO_PULLDOWN_ENABLE = 1 } gpio_pulldown_t;
+typedef enum { GPIO_INTR_DISABLE = 0 } gpio_int_type_t;
+
+#endif //PERSE_ROVER_HOST_HAL_GPIO_TYPES_H
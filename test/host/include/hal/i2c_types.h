@@ -0,0 +1,19 @@
+#ifndef PERSE_ROVER_HOST_HAL_I2C_TYPES_H
+#define PERSE_ROVER_HOST_HAL_I2C_TYPES_H
+
+typedef int i2c_port_t;
+
+#define I2C_NUM_0 0
+#define I2C_NUM_1 1
+
+typedef enum {
+	I2C_MODE_SLAVE = 0,
+	I2C_MODE_MASTER
+} i2c_mode_t;
+
+typedef enum {
+	I2C_MASTER_WRITE = 0,
+	I2C_MASTER_READ
+} i2c_rw_t;
+
+#endif //PERSE_ROVER_HOST_HAL_I2C_TYPES_H
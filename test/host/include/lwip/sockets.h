@@ -0,0 +1,39 @@
+#ifndef PERSE_ROVER_HOST_LWIP_SOCKETS_H
+#define PERSE_ROVER_HOST_LWIP_SOCKETS_H
+
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+/**
+ * lwIP's BSD socket API is the host's own. Two differences are papered over:
+ * the rover's access point address doesn't exist on the host, so servers listen on loopback instead,
+ * and listening sockets reuse their address, so test processes run back to back can bind the same ports.
+ */
+
+inline int host_inet_pton(int af, const char* src, void* dst){
+	if(af == AF_INET && strcmp(src, "11.0.0.1") == 0){
+		src = "127.0.0.1";
+	}
+	return ::inet_pton(af, src, dst);
+}
+#define inet_pton host_inet_pton
+
+inline int host_bind(int fd, const sockaddr* addr, socklen_t len){
+	const int reuse = 1;
+	::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+	return ::bind(fd, addr, len);
+}
+#define bind host_bind
+
+inline char* inet_ntoa_r(in_addr addr, char* buf, int size){
+	return (char*) ::inet_ntop(AF_INET, &addr, buf, size);
+}
+
+#endif //PERSE_ROVER_HOST_LWIP_SOCKETS_H
@@ -0,0 +1,11 @@
+#ifndef PERSE_ROVER_HOST_SDKCONFIG_H
+#define PERSE_ROVER_HOST_SDKCONFIG_H
+
+// The subset of the firmware's sdkconfig that the host-built sources read
+
+#define CONFIG_FREERTOS_HZ 1000
+#define CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES 2
+#define CONFIG_ESP32S3_DATA_CACHE_LINE_SIZE 64
+#define CONFIG_TCP_MSS 1436
+
+#endif //PERSE_ROVER_HOST_SDKCONFIG_H
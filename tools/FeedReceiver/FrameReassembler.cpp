@@ -0,0 +1,123 @@
+#include "FrameReassembler.h"
+#include "Util/CRC32.h"
+#include <cstring>
+
+FrameReassembler::FrameReassembler(size_t maxFrameSize) : maxFrameSize(maxFrameSize){
+	buf.reserve(maxFrameSize);
+}
+
+bool FrameReassembler::push(const uint8_t* datagram, size_t size, uint64_t now){
+	if(size <= sizeof(FeedFragmentHeader)) return false;
+
+	FeedFragmentHeader header;
+	memcpy(&header, datagram, sizeof(header));
+
+	if(header.magic != FeedFragmentMagic) return false;
+	if(header.version != FeedProtocolVersion){
+		incompatible++;
+		return false;
+	}
+
+	if(header.count == 0 || header.index >= header.count) return false;
+	if(header.frameSize == 0 || header.frameSize > maxFrameSize || header.metaSize > header.frameSize) return false;
+
+	const uint8_t* payload = datagram + sizeof(header);
+	const size_t payloadSize = size - sizeof(header);
+
+	if(!active || header.frameID != frameID){
+		if(active && (int16_t) (header.frameID - frameID) < 0){
+			// Late fragment of a frame that was already completed or dropped, unless the rover started counting over
+			const bool jumpedBack = (uint16_t) (frameID - header.frameID) > ReorderWindow;
+			if(!jumpedBack && now - lastAccepted < RestartTimeout) return false;
+
+			restarts++;
+		}
+
+		if(active && receivedCount != count){
+			drop();
+		}
+
+		begin(header, payloadSize);
+	}
+
+	if(corrupted || received[header.index]) return false;
+
+	// Every fragment except the last one carries the full payload, which gives its offset in the frame
+	const size_t offset = (size_t) header.index * fragmentPayload;
+	const bool last = header.index == count - 1;
+	const size_t expected = last ? frameSize - offset : fragmentPayload;
+
+	if(header.count != count || header.frameSize != frameSize || header.metaSize != frameMetaSize || payloadSize != expected || offset + payloadSize > frameSize
+	   || crc32(payload, payloadSize) != header.crc){
+		corrupted = true;
+		corruptedCount++;
+		return false;
+	}
+
+	memcpy(buf.data() + offset, payload, payloadSize);
+	received[header.index] = true;
+	receivedCount++;
+	lastAccepted = now;
+
+	if(receivedCount != count) return false;
+
+	completed++;
+	return true;
+}
+
+const uint8_t* FrameReassembler::data() const{
+	return buf.data();
+}
+
+size_t FrameReassembler::size() const{
+	return receivedCount == count ? frameSize : 0;
+}
+
+size_t FrameReassembler::metaSize() const{
+	return frameMetaSize;
+}
+
+uint32_t FrameReassembler::getCompleted() const{
+	return completed;
+}
+
+uint32_t FrameReassembler::getDropped() const{
+	return dropped;
+}
+
+uint32_t FrameReassembler::getCorrupted() const{
+	return corruptedCount;
+}
+
+uint32_t FrameReassembler::getIncompatible() const{
+	return incompatible;
+}
+
+uint32_t FrameReassembler::getRestarts() const{
+	return restarts;
+}
+
+void FrameReassembler::begin(const FeedFragmentHeader& header, size_t payload){
+	active = true;
+	corrupted = false;
+	frameID = header.frameID;
+	count = header.count;
+	frameSize = header.frameSize;
+	frameMetaSize = header.metaSize;
+	receivedCount = 0;
+
+	// A single-fragment frame doesn't tell the payload size of a full fragment, but doesn't need it either
+	if(header.index == count - 1 && count > 1){
+		fragmentPayload = (frameSize - payload) / (count - 1);
+	}else{
+		fragmentPayload = payload;
+	}
+
+	buf.resize(frameSize);
+	received.assign(count, false);
+}
+
+void FrameReassembler::drop(){
+	dropped++;
+	active = false;
+}
@@ -0,0 +1,76 @@
+#ifndef PERSE_ROVER_FRAMEREASSEMBLER_H
+#define PERSE_ROVER_FRAMEREASSEMBLER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "Services/FeedProtocol.h"
+
+/**
+ * Receiving side of the camera feed fragment protocol (see main/src/Services/FeedProtocol.h), for the controller
+ * and host tools. Build it with main/src on the include path.
+ * Fragments may arrive out of order within a frame. A frame with a missing or corrupted fragment is dropped
+ * as soon as a fragment of a newer frame arrives, so a loss only ever costs that one frame.
+ * Fragments of older frames are ignored, unless the frame ID jumped back by more than ReorderWindow or nothing
+ * was accepted for RestartTimeout, which is the rover restarting its frame count.
+ */
+class FrameReassembler {
+public:
+	explicit FrameReassembler(size_t maxFrameSize);
+
+	/**
+	 * @param now Receive time in milliseconds, any monotonic clock
+	 * @return true if this datagram completed a frame, available through data() and size() until the next push()
+	 */
+	bool push(const uint8_t* datagram, size_t size, uint64_t now);
+
+	const uint8_t* data() const;
+	size_t size() const;
+
+	/**
+	 * Size of the serialized DriveInfo at the start of the frame, the JPEG follows it
+	 */
+	size_t metaSize() const;
+
+	uint32_t getCompleted() const;
+	uint32_t getDropped() const;
+	uint32_t getCorrupted() const;
+
+	/**
+	 * Fragments with the right magic but another protocol version
+	 */
+	uint32_t getIncompatible() const;
+
+	uint32_t getRestarts() const;
+
+	static constexpr uint16_t ReorderWindow = 32;
+	static constexpr uint64_t RestartTimeout = 500; // [ms]
+
+private:
+	const size_t maxFrameSize;
+
+	std::vector<uint8_t> buf;
+	std::vector<bool> received;
+
+	bool active = false;
+	bool corrupted = false;
+	uint16_t frameID = 0;
+	uint16_t count = 0;
+	uint16_t receivedCount = 0;
+	uint32_t frameSize = 0;
+	uint16_t frameMetaSize = 0;
+	size_t fragmentPayload = 0;
+	uint64_t lastAccepted = 0;
+
+	uint32_t completed = 0;
+	uint32_t dropped = 0;
+	uint32_t corruptedCount = 0;
+	uint32_t incompatible = 0;
+	uint32_t restarts = 0;
+
+	void begin(const FeedFragmentHeader& header, size_t payload);
+	void drop();
+};
+
+
+#endif //PERSE_ROVER_FRAMEREASSEMBLER_H